@@ -0,0 +1,939 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_manager_instance.cpp
+//
+// Identification: src/buffer/buffer_pool_manager_instance.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/buffer_pool_manager_instance.h"
+
+#include <sys/mman.h>
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <list>
+#include <unordered_map>
+#include <vector>
+#include "buffer/clock_replacer.h"
+#include "buffer/lru_k_replacer.h"
+#include "common/exception.h"
+#include "common/logger.h"
+
+namespace bustub {
+
+namespace {
+
+constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+/** How often a shrink looks again at a pinned frame it waits to drain. */
+constexpr auto DRAIN_POLL_INTERVAL = std::chrono::milliseconds(1);
+
+/**
+ * Map page aligned memory for the frames, from huge pages if the system has some reserved.
+ * @param size bytes needed
+ * @param resizable true if the pool may grow into the memory later: then it is only reserved, and not taken from
+ * huge pages, a fault on an unreserved huge page would kill the process when none are left
+ * @param[out] mapped_size bytes actually mapped, to be passed to munmap
+ */
+void *MapFrameMemory(size_t size, bool resizable, size_t *mapped_size) {
+  if (size >= HUGE_PAGE_SIZE && !resizable) {
+    *mapped_size = (size + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+    void *memory = mmap(nullptr, *mapped_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (memory != MAP_FAILED) {
+      return memory;
+    }
+  }
+  *mapped_size = size;
+  void *memory = mmap(nullptr, *mapped_size, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | (resizable ? MAP_NORESERVE : 0), -1, 0);
+  if (memory == MAP_FAILED) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "can't map buffer pool frames");
+  }
+  return memory;
+}
+
+}  // namespace
+
+BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager,
+                                                     LogManager *log_manager, ReplacerType replacer_type,
+                                                     size_t max_pool_size)
+    : BufferPoolManagerInstance(pool_size, 1, 0, disk_manager, log_manager, replacer_type, max_pool_size) {}
+
+BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, uint32_t num_instances, uint32_t instance_index,
+                                                     DiskManager *disk_manager, LogManager *log_manager,
+                                                     ReplacerType replacer_type, size_t max_pool_size)
+    : pool_size_(pool_size),
+      target_pool_size_(pool_size),
+      max_pool_size_(std::max(pool_size, max_pool_size)),
+      num_instances_(num_instances),
+      instance_index_(instance_index),
+      disk_manager_(disk_manager),
+      log_manager_(log_manager),
+      page_table_(max_pool_size_) {
+  BUSTUB_ASSERT(num_instances > 0, "If BPI is not part of a pool, then the pool size should just be 1");
+  BUSTUB_ASSERT(
+      instance_index < num_instances,
+      "BPI index cannot be greater than the number of BPIs in the pool. In non-parallel case, index should just be 0.");
+  // We allocate a consecutive memory space for the buffer pool.
+  // The pages are mapped page aligned, so with the aligned Page::data_ every frame can be read in with O_DIRECT.
+  // A resizable pool maps the address space for max_pool_size_ frames up front, growing only touches more of it.
+  pages_ = static_cast<Page *>(MapFrameMemory(std::max<size_t>(max_pool_size_, 1) * sizeof(Page),
+                                              max_pool_size_ > pool_size_, &frame_memory_size_));
+  // The per-frame state is mapped the same way and constructed only for the frames the pool grows into.
+  frame_state_ = static_cast<FrameState *>(MapFrameMemory(std::max<size_t>(max_pool_size_, 1) * sizeof(FrameState),
+                                                          max_pool_size_ > pool_size_, &frame_state_memory_size_));
+  for (size_t i = 0; i < pool_size_; ++i) {
+    new (&pages_[i]) Page();
+    new (&frame_state_[i]) FrameState();
+  }
+  num_frame_states_ = pool_size;
+  switch (replacer_type) {
+    case ReplacerType::LRU_K:
+      // allocates its history for more frames when the pool grows
+      replacer_ = new LRUKReplacer(pool_size_);
+      break;
+    case ReplacerType::CLOCK:
+      replacer_ = new ClockReplacer(max_pool_size_);
+      break;
+    case ReplacerType::LRU:
+    default:
+      replacer_ = new LRUReplacer(max_pool_size_);
+      break;
+  }
+  replacer_->SetFrameLimit(pool_size_);
+
+  // Initially, every page is in the free list.
+  for (size_t i = 0; i < pool_size_; ++i) {
+    // lab add
+    pages_[i].page_id_ = INVALID_PAGE_ID;
+    pages_[i].is_dirty_ = false;
+    pages_[i].pin_count_ = FRAME_CLAIMED;
+
+    free_list_.emplace_back(static_cast<int>(i));
+  }
+}
+
+BufferPoolManagerInstance::~BufferPoolManagerInstance() {
+  StopBackgroundWriter();
+  StopPrefetcher();
+  for (size_t i = 0; i < pool_size_; ++i) {
+    pages_[i].~Page();
+  }
+  for (size_t i = 0; i < num_frame_states_; ++i) {
+    frame_state_[i].~FrameState();
+  }
+  munmap(pages_, frame_memory_size_);
+  munmap(frame_state_, frame_state_memory_size_);
+  delete replacer_;
+}
+
+Page *BufferPoolManagerInstance::FetchPageImpl(page_id_t page_id, BufferAccessStrategy *strategy) {
+  // 1.     Search the page table for the requested page (P).
+  // 1.1    If P exists, pin it and return it immediately.
+  // 1.2    If P does not exist, find a replacement page (R) from either the free list or the replacer.
+  //        Note that pages are always found from the free list first.
+  // 2.     If R is dirty, write it back to the disk.
+  // 3.     Delete R from the page table and insert P.
+  // 4.     Update P's metadata, read in the page content from disk, and then return a pointer to P.
+  // The frame is reserved under latch_ and marked as I/O in progress, steps 2 and 4 then run without latch_.
+
+  // 1.1 a hit needs no latch
+  Page *page = TryPinResident(page_id);
+  if (page != nullptr) {
+    RecordAccess(static_cast<frame_id_t>(page - pages_), strategy);
+    return page;
+  }
+
+  std::unique_lock<std::mutex> lock(latch_);
+  WaitForPage(&lock, page_id);
+  frame_id_t frame_id;
+  if (page_table_.Find(page_id, &frame_id)) {
+    // A mapped frame is only claimed with latch_ held, so it cannot be claimed now.
+    page = &pages_[frame_id];
+    page->pin_count_++;
+    replacer_->Pin(frame_id);
+    RecordAccess(frame_id, strategy);
+    return page;
+  }
+  page = LoadPage(&lock, page_id, true, strategy);
+  if (page != nullptr) {
+    RecordAccess(static_cast<frame_id_t>(page - pages_), strategy);
+  }
+  return page;
+}
+
+Page *BufferPoolManagerInstance::TryPinResident(page_id_t page_id) {
+  frame_id_t frame_id;
+  if (!page_table_.Find(page_id, &frame_id)) {
+    return nullptr;
+  }
+  return TryPinFrame(frame_id, page_id);
+}
+
+Page *BufferPoolManagerInstance::TryPinFrame(frame_id_t frame_id, page_id_t page_id) {
+  // Announce the pin before touching the frame, a shrink may be about to release its memory.
+  std::atomic<uint32_t> &guard = frame_state_[frame_id].guard_;
+  if ((guard.fetch_add(1, std::memory_order_acquire) & FRAME_RETIRED) != 0) {
+    guard.fetch_sub(1, std::memory_order_release);
+    return nullptr;
+  }
+  Page *page = &pages_[frame_id];
+  bool pinned = true;
+  int pin_count = page->pin_count_.load(std::memory_order_relaxed);
+  do {
+    if (pin_count == FRAME_CLAIMED) {
+      pinned = false;
+      break;
+    }
+  } while (!page->pin_count_.compare_exchange_weak(pin_count, pin_count + 1, std::memory_order_acquire));
+
+  // The frame cannot be claimed any more, but it may have been refilled since page_id was found in it.
+  if (pinned &&
+      (frame_state_[frame_id].io_in_progress_.load(std::memory_order_acquire) || page->GetPageId() != page_id)) {
+    // If this drops the pin count to 0 the frame may be missing from the replacer, FindVictimPage sweeps for those.
+    page->pin_count_.fetch_sub(1, std::memory_order_release);
+    pinned = false;
+  }
+  guard.fetch_sub(1, std::memory_order_release);
+  if (!pinned) {
+    return nullptr;
+  }
+  replacer_->Pin(frame_id);
+  return page;
+}
+
+Page *BufferPoolManagerInstance::LoadPage(std::unique_lock<std::mutex> *lock, page_id_t page_id, bool pin,
+                                          BufferAccessStrategy *strategy) {
+  // 1.2
+  frame_id_t frame_id = -1;
+  size_t ring_slot = 0;
+  // 找不到牺牲页
+  if (!FindVictimPage(strategy, &frame_id, &ring_slot)) {
+    return nullptr;
+  }
+  AddToRing(strategy, ring_slot, page_id, frame_id);
+
+  // 3
+  // LOG_INFO("FetchPgImp page_id %d 被移除\n", replace_page->page_id_);
+  Page *replace_page = &pages_[frame_id];
+  page_id_t old_page_id = replace_page->GetPageId();
+  bool old_dirty = replace_page->IsDirty();
+  bool old_write_back = old_dirty || frame_state_[frame_id].bg_writing_;
+  BeginIo(frame_id, old_page_id, old_write_back);
+  page_table_.Insert(page_id, frame_id);
+  // LOG_INFO("FetchPgImp page_id %d 被添加\n", page_id);
+  replace_page->ResetSwips();
+  replace_page->page_id_ = page_id;
+  replace_page->is_dirty_ = false;
+  // A page brought in without a ring belongs to the working set, a ring never recycles its frame.
+  frame_state_[frame_id].usage_count_ = strategy == nullptr ? MAX_USAGE_COUNT : 0;
+  // 无论是从free list还是lru list中获取的frame都已被FindVictimPage认领(pin_count==FRAME_CLAIMED)
+  // A prefetched frame stays unpinned, io_in_progress_ keeps it from being victimized until the read is done.
+  replace_page->pin_count_ = pin ? 1 : 0;
+  replacer_->Pin(frame_id);
+  WaitForBackgroundWrite(lock, frame_id);
+  lock->unlock();
+
+  // 2
+  if (old_dirty) {
+    disk_manager_->WritePage(old_page_id, replace_page->GetData());
+  }
+  // 4
+  disk_manager_->ReadPage(page_id, replace_page->GetData());
+
+  lock->lock();
+  EndIo(frame_id, old_page_id, old_write_back);
+  if (replace_page->pin_count_ == 0) {
+    replacer_->Unpin(frame_id);
+  }
+  return replace_page;
+}
+
+Page *BufferPoolManagerInstance::FetchResidentPage(page_id_t page_id) {
+  Page *page = TryPinResident(page_id);
+  if (page != nullptr) {
+    RecordAccess(static_cast<frame_id_t>(page - pages_), nullptr);
+    return page;
+  }
+  // The latch-free lookup can miss a page whose entry is being moved, look again under the latch.
+  std::scoped_lock lock(latch_);
+  frame_id_t frame_id;
+  if (!page_table_.Find(page_id, &frame_id) || frame_state_[frame_id].io_in_progress_) {
+    return nullptr;
+  }
+  page = &pages_[frame_id];
+  page->pin_count_++;
+  replacer_->Pin(frame_id);
+  RecordAccess(frame_id, nullptr);
+  return page;
+}
+
+Page *BufferPoolManagerInstance::FetchSwizzledPage(Page *frame, page_id_t page_id) {
+  // frames above num_frame_states_ were never part of the pool
+  if (frame < pages_ || frame >= pages_ + num_frame_states_) {
+    return nullptr;
+  }
+  auto frame_id = static_cast<frame_id_t>(frame - pages_);
+  Page *page = TryPinFrame(frame_id, page_id);
+  if (page != nullptr) {
+    RecordAccess(frame_id, nullptr);
+  }
+  return page;
+}
+
+void BufferPoolManagerInstance::PrefetchPages(const std::vector<page_id_t> &page_ids) {
+  std::scoped_lock lock(latch_);
+  for (auto page_id : page_ids) {
+    frame_id_t frame_id;
+    if (page_id != INVALID_PAGE_ID && !page_table_.Find(page_id, &frame_id)) {
+      prefetch_queue_.push_back(page_id);
+    }
+  }
+  if (prefetch_queue_.empty()) {
+    return;
+  }
+  if (prefetch_thread_ == nullptr) {
+    prefetch_running_ = true;
+    prefetch_thread_ = new std::thread(&BufferPoolManagerInstance::PrefetchLoop, this);
+  }
+  prefetch_cv_.notify_one();
+}
+
+void BufferPoolManagerInstance::StopPrefetcher() {
+  {
+    std::scoped_lock lock(latch_);
+    if (prefetch_thread_ == nullptr) {
+      return;
+    }
+    prefetch_running_ = false;
+    prefetch_queue_.clear();
+  }
+  prefetch_cv_.notify_one();
+  prefetch_thread_->join();
+  delete prefetch_thread_;
+  prefetch_thread_ = nullptr;
+}
+
+void BufferPoolManagerInstance::PrefetchLoop() {
+  std::unique_lock<std::mutex> lock(latch_);
+  while (true) {
+    prefetch_cv_.wait(lock, [&] { return !prefetch_running_ || !prefetch_queue_.empty(); });
+    if (!prefetch_running_) {
+      break;
+    }
+    page_id_t page_id = prefetch_queue_.front();
+    prefetch_queue_.pop_front();
+    // Already resident, being read by a fetch, or an evicted page still being written: nothing to gain.
+    frame_id_t frame_id;
+    if (page_table_.Find(page_id, &frame_id) || write_back_table_.find(page_id) != write_back_table_.end()) {
+      continue;
+    }
+    // A guessed page that was never allocated would come in as zeros under an id a later NewPage hands out.
+    if (!disk_manager_->IsAllocated(page_id)) {
+      continue;
+    }
+    // If every frame is pinned the hint is simply dropped.
+    LoadPage(&lock, page_id, false);
+  }
+}
+
+bool BufferPoolManagerInstance::UnpinPageImpl(page_id_t page_id, bool is_dirty) {
+  // The caller holds a pin, so the mapping cannot change under us and no latch is needed.
+  frame_id_t frame_id;
+  if (!page_table_.Find(page_id, &frame_id)) {
+    // The latch-free lookup can miss an entry that is being moved, look again under the latch.
+    std::scoped_lock lock(latch_);
+    if (!page_table_.Find(page_id, &frame_id)) {
+      return true;
+    }
+  }
+  Page *pg = &pages_[frame_id];
+  // 当is_dirty为false而pg->is_dirty为true防止覆盖
+  if (is_dirty) {
+    pg->is_dirty_ = true;
+  }
+
+  int pin_count = pg->pin_count_.load(std::memory_order_relaxed);
+  do {
+    if (pin_count <= 0) {
+      // LOG_INFO("UnpinPgImp: (pg->pin_count_ <= 0) return false");
+      return false;
+    }
+  } while (!pg->pin_count_.compare_exchange_weak(pin_count, pin_count - 1, std::memory_order_release));
+
+  if (pin_count == 1) {
+    replacer_->Unpin(frame_id);
+  }
+  return true;
+}
+
+bool BufferPoolManagerInstance::FlushPageImpl(page_id_t page_id) {
+  // Make sure you call DiskManager::WritePage!
+  std::unique_lock<std::mutex> lock(latch_);
+  WaitForPage(&lock, page_id);
+  frame_id_t frame_id;
+  if (page_id == INVALID_PAGE_ID || !page_table_.Find(page_id, &frame_id)) {
+    return false;
+  }
+  auto page = &pages_[frame_id];
+  disk_manager_->WritePage(page_id, page->data_);
+  page->is_dirty_ = false;
+  return true;
+}
+
+Page *BufferPoolManagerInstance::NewPageImpl(page_id_t *page_id, BufferAccessStrategy *strategy, page_id_t hint) {
+  // 0.   Make sure you call DiskManager::AllocatePage!
+  // 1.   If all the pages in the buffer pool are pinned, return nullptr.
+  // 2.   Pick a victim page P from either the free list or the replacer. Always pick from the free list first.
+  // 3.   Update P's metadata, zero out memory and add P to the page table.
+  // 4.   Set the page ID output parameter. Return a pointer to P.
+  std::unique_lock<std::mutex> lock(latch_);
+  // 从buffer pool中找一个buffer位置
+  // 2
+  frame_id_t frame_id = -1;
+  size_t ring_slot = 0;
+  // 1
+  // 找不到牺牲页
+  if (!FindVictimPage(strategy, &frame_id, &ring_slot)) {
+    return nullptr;
+  }
+  Page *replace_page = &pages_[frame_id];
+  page_id_t old_page_id = replace_page->GetPageId();
+  bool old_dirty = replace_page->IsDirty();
+  bool old_write_back = old_dirty || frame_state_[frame_id].bg_writing_;
+
+  // 3
+  // Update P's metadata
+  auto new_page_id = AllocatePage(hint);
+  AddToRing(strategy, ring_slot, new_page_id, frame_id);
+  BeginIo(frame_id, old_page_id, old_write_back);
+  page_table_.Insert(new_page_id, frame_id);
+  replace_page->ResetSwips();
+  replace_page->page_id_ = new_page_id;
+  replace_page->is_dirty_ = false;
+  replace_page->pin_count_ = 1;
+  frame_state_[frame_id].usage_count_ = strategy == nullptr ? MAX_USAGE_COUNT : 1;
+  replacer_->Pin(frame_id);
+  WaitForBackgroundWrite(&lock, frame_id);
+  lock.unlock();
+
+  if (old_dirty) {
+    disk_manager_->WritePage(old_page_id, replace_page->GetData());
+  }
+  // zero out memory
+  replace_page->ResetMemory();
+  disk_manager_->WritePage(new_page_id, replace_page->GetData());
+
+  lock.lock();
+  EndIo(frame_id, old_page_id, old_write_back);
+
+  // 4
+  // Set the page ID output parameter
+  *page_id = new_page_id;
+  return replace_page;
+}
+
+bool BufferPoolManagerInstance::DeletePageImpl(page_id_t page_id) {
+  // 0.   Make sure you call DiskManager::DeallocatePage!
+  // 1.   Search the page table for the requested page (P).
+  // 1.   If P does not exist, return true.
+  // 2.   If P exists, but has a non-zero pin-count, return false. Someone is using the page.
+  // 3.   Otherwise, P can be deleted. Remove P from the page table, reset its metadata and return it to the free list.
+  std::unique_lock<std::mutex> lock(latch_);
+  // 1
+  frame_id_t frame_id;
+  if (page_id == INVALID_PAGE_ID) {
+    return true;
+  }
+  while (true) {
+    // A prefetched page is unpinned while it is read in, the frame must not be freed under the read.
+    WaitForPage(&lock, page_id);
+    if (!page_table_.Find(page_id, &frame_id)) {
+      // not resident, only its disk page has to go
+      disk_manager_->DeallocatePage(page_id);
+      return true;
+    }
+    if (!frame_state_[frame_id].bg_writing_) {
+      break;
+    }
+    // The background writer may still be writing the page, its id must not be freed for reuse under the write.
+    // Wait before claiming, the wait releases latch_ and a fetch meanwhile must not find a claimed frame mapped.
+    WaitForBackgroundWrite(&lock, frame_id);
+  }
+  ValidatePageId(page_id);
+  // 2
+  Page *pg = &pages_[frame_id];
+  if (!TryClaimFrame(frame_id)) {
+    return false;
+  }
+  // 清理
+  if (pg->IsDirty()) {
+    disk_manager_->WritePage(pg->GetPageId(), pg->GetData());
+  }
+  disk_manager_->DeallocatePage(page_id);
+  // 3
+  // LOG_INFO("DeletePgImp page_id %d 被移除\n", page_id);
+  page_table_.Remove(page_id);
+  // 因为要放入free list，因此从lru中移除
+  replacer_->Pin(frame_id);
+  // reset metadata, the frame stays claimed while it is on the free list
+  pg->ResetSwips();
+  pg->page_id_ = INVALID_PAGE_ID;
+  pg->is_dirty_ = false;
+  // 放回free list, unless a shrink is draining the frame
+  if (static_cast<size_t>(frame_id) < target_pool_size_) {
+    free_list_.push_back(frame_id);
+  }
+
+  return true;
+}
+
+segment_id_t BufferPoolManagerInstance::CreateSegment() { return disk_manager_->CreateSegment(); }
+
+void BufferPoolManagerInstance::DropSegment(segment_id_t segment_id) {
+  DiscardSegment(segment_id);
+  disk_manager_->DropSegment(segment_id);
+}
+
+void BufferPoolManagerInstance::DiscardSegment(segment_id_t segment_id) {
+  std::unique_lock<std::mutex> lock(latch_);
+  // queued prefetches would read the pages back in after the file is gone
+  auto queued = [&](page_id_t page_id) { return DiskManager::SegmentOf(page_id) == segment_id; };
+  prefetch_queue_.erase(std::remove_if(prefetch_queue_.begin(), prefetch_queue_.end(), queued), prefetch_queue_.end());
+  for (size_t frame = 0; frame < pool_size_; frame++) {
+    Page *page = &pages_[frame];
+    auto frame_id = static_cast<frame_id_t>(frame);
+    while (true) {
+      page_id_t page_id = page->GetPageId();
+      if (page_id == INVALID_PAGE_ID || DiskManager::SegmentOf(page_id) != segment_id) {
+        break;
+      }
+      // a read into the frame must finish before the frame is freed
+      WaitForPage(&lock, page_id);
+      if (frame >= pool_size_) {
+        break;
+      }
+      if (page->GetPageId() != page_id) {
+        continue;
+      }
+      // Wait for the background writer before claiming, the wait releases latch_ while the page is still mapped.
+      if (frame_state_[frame].bg_writing_) {
+        WaitForBackgroundWrite(&lock, frame_id);
+        if (frame >= pool_size_) {
+          break;
+        }
+        continue;
+      }
+      if (TryClaimFrame(frame_id)) {
+        page_table_.Remove(page_id);
+        replacer_->Pin(frame_id);
+        page->ResetSwips();
+        page->page_id_ = INVALID_PAGE_ID;
+        page->is_dirty_ = false;
+        if (frame < target_pool_size_) {
+          free_list_.push_back(frame_id);
+        }
+        break;
+      }
+      // Pinned: skipping it would leave a dirty page to be written to the file after it is gone. Wait for the unpin.
+      lock.unlock();
+      std::this_thread::sleep_for(DRAIN_POLL_INTERVAL);
+      lock.lock();
+      if (frame >= pool_size_) {
+        break;
+      }
+    }
+  }
+  // write-backs of evicted pages of the segment would hit the file after it is gone
+  auto in_segment = [&](const auto &entry) { return DiskManager::SegmentOf(entry.first) == segment_id; };
+  auto it = std::find_if(write_back_table_.begin(), write_back_table_.end(), in_segment);
+  while (it != write_back_table_.end()) {
+    frame_state_[it->second].io_done_.wait(lock);
+    it = std::find_if(write_back_table_.begin(), write_back_table_.end(), in_segment);
+  }
+}
+
+bool BufferPoolManagerInstance::Resize(size_t pool_size) {
+  if (pool_size == 0 || pool_size > max_pool_size_) {
+    return false;
+  }
+  std::scoped_lock resize_lock(resize_latch_);
+  std::unique_lock<std::mutex> lock(latch_);
+  size_t old_pool_size = pool_size_;
+  if (pool_size > old_pool_size) {
+    GrowPool(pool_size);
+  } else if (pool_size < old_pool_size) {
+    bool drained = ShrinkPool(&lock, pool_size);
+    size_t new_pool_size = pool_size_;
+    lock.unlock();
+    ReleaseFrameMemory(new_pool_size, old_pool_size);
+    return drained;
+  }
+  return true;
+}
+
+void BufferPoolManagerInstance::GrowPool(size_t pool_size) {
+  // the replacer has to know the new frames before they are handed out
+  replacer_->SetFrameLimit(pool_size);
+  for (size_t i = num_frame_states_; i < pool_size; ++i) {
+    new (&frame_state_[i]) FrameState();
+    frame_state_[i].guard_ = FRAME_RETIRED;
+  }
+  num_frame_states_ = std::max<size_t>(num_frame_states_, pool_size);
+  for (size_t i = pool_size_; i < pool_size; ++i) {
+    new (&pages_[i]) Page();
+    pages_[i].pin_count_ = FRAME_CLAIMED;
+    frame_state_[i].io_in_progress_ = false;
+    frame_state_[i].bg_writing_ = false;
+    free_list_.emplace_back(static_cast<frame_id_t>(i));
+    // latch-free pins may touch the frame from now on
+    frame_state_[i].guard_.fetch_and(~FRAME_RETIRED, std::memory_order_release);
+  }
+  pool_size_ = pool_size;
+  target_pool_size_ = pool_size;
+}
+
+bool BufferPoolManagerInstance::ShrinkPool(std::unique_lock<std::mutex> *lock, size_t pool_size) {
+  target_pool_size_ = pool_size;
+  replacer_->SetFrameLimit(pool_size);
+  // Free frames are claimed already, they only have to leave the free list.
+  free_list_.remove_if([&](frame_id_t frame_id) { return static_cast<size_t>(frame_id) >= pool_size; });
+  // when the frame at the tail has to be unpinned by
+  auto deadline = std::chrono::steady_clock::now() + resize_drain_timeout;
+  while (pool_size_ > pool_size) {
+    auto frame_id = static_cast<frame_id_t>(pool_size_ - 1);
+    Page *page = &pages_[frame_id];
+    if (frame_state_[frame_id].io_in_progress_ || frame_state_[frame_id].bg_writing_) {
+      frame_state_[frame_id].io_done_.wait(*lock);
+      continue;
+    }
+    // Claimed without a page: it was on the free list, or deleted after the shrink started.
+    bool free = page->pin_count_ == FRAME_CLAIMED && page->GetPageId() == INVALID_PAGE_ID;
+    if (!free) {
+      if (!TryClaimFrame(frame_id)) {
+        if (std::chrono::steady_clock::now() >= deadline) {
+          // 放弃：池子停在这个frame之后
+          StopShrink(pool_size);
+          return false;
+        }
+        // Pinned, look again once its user had time to unpin it. FetchPage traffic goes on meanwhile.
+        lock->unlock();
+        std::this_thread::sleep_for(DRAIN_POLL_INTERVAL);
+        lock->lock();
+        continue;
+      }
+      replacer_->Pin(frame_id);
+      page_id_t page_id = page->GetPageId();
+      bool dirty = page->IsDirty();
+      // evict it like a victim, a fetch of the page meanwhile waits for the write-back
+      BeginIo(frame_id, page_id, dirty);
+      lock->unlock();
+      if (dirty) {
+        disk_manager_->WritePage(page_id, page->GetData());
+      }
+      lock->lock();
+      EndIo(frame_id, page_id, dirty);
+    }
+    // Wait for latch-free pins that found the frame before it was claimed, they fail but still touch it.
+    std::atomic<uint32_t> &guard = frame_state_[frame_id].guard_;
+    guard.fetch_or(FRAME_RETIRED);
+    while (guard.load() != FRAME_RETIRED) {
+      std::this_thread::yield();
+    }
+    page->~Page();
+    pool_size_--;
+    deadline = std::chrono::steady_clock::now() + resize_drain_timeout;
+  }
+  return true;
+}
+
+void BufferPoolManagerInstance::StopShrink(size_t pool_size) {
+  // The frames [pool_size, pool_size_) stay. Those that were free, or freed while the shrink ran, were kept off the
+  // free list.
+  for (size_t i = pool_size; i < pool_size_; i++) {
+    Page *page = &pages_[i];
+    if (page->pin_count_ == FRAME_CLAIMED && page->GetPageId() == INVALID_PAGE_ID && !frame_state_[i].io_in_progress_) {
+      free_list_.push_back(static_cast<frame_id_t>(i));
+    }
+  }
+  target_pool_size_ = pool_size_;
+  replacer_->SetFrameLimit(pool_size_);
+}
+
+void BufferPoolManagerInstance::ReleaseFrameMemory(size_t begin, size_t end) {
+  // Only whole system pages inside the retired frames, the page the last frame in use ends in stays.
+  auto system_page_size = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+  auto first = (reinterpret_cast<uintptr_t>(&pages_[begin]) + system_page_size - 1) / system_page_size * system_page_size;
+  auto last = reinterpret_cast<uintptr_t>(&pages_[end]) / system_page_size * system_page_size;
+  if (first < last) {
+    // Failing leaves the memory in use, which is only a missed saving.
+    madvise(reinterpret_cast<void *>(first), last - first, MADV_DONTNEED);
+  }
+}
+
+void BufferPoolManagerInstance::FlushAllPagesImpl() {
+  // You can do it!
+  std::unique_lock<std::mutex> lock(latch_);
+  for (size_t i = 0; i < pool_size_; i++) {
+    auto page = &pages_[i];
+    frame_state_[i].io_done_.wait(lock, [&] { return !frame_state_[i].io_in_progress_; });
+    if (i >= pool_size_) {
+      break;
+    }
+    if (page->page_id_ == INVALID_PAGE_ID) {
+      continue;
+    }
+    disk_manager_->WritePage(page->page_id_, page->data_);
+    page->is_dirty_ = false;
+  }
+  lock.unlock();
+  // Page writes are not synced one by one, this is the sync point that makes them durable.
+  disk_manager_->SyncPages();
+}
+
+bool BufferPoolManagerInstance::FindVictimPage(frame_id_t *frame_id) {
+  // Pages are always found from the free list first. Free frames are claimed already.
+  if (!free_list_.empty()) {
+    *frame_id = free_list_.front();
+    free_list_.pop_front();
+    if (pages_[*frame_id].pin_count_ != FRAME_CLAIMED) {
+      LOG_ERROR("FindVictimPage: !free_list_.empty() replace_page->pin_count_ != FRAME_CLAIMED\n");
+    }
+    return true;
+  }
+  bool found = false;
+  while (!found && replacer_->Victim(frame_id)) {
+    // A latch-free hit may have pinned the frame after it was unpinned, skip it, its unpin puts it back.
+    // Frames a shrink drains are skipped too, the shrink claims them itself.
+    found = static_cast<size_t>(*frame_id) < target_pool_size_ && !frame_state_[*frame_id].io_in_progress_ &&
+            TryClaimFrame(*frame_id);
+  }
+  if (!found) {
+    // A latch-free pin racing with an unpin of the same frame can leave an unpinned frame outside the replacer.
+    for (size_t i = 0; i < target_pool_size_ && !found; i++) {
+      *frame_id = static_cast<frame_id_t>(i);
+      found = pages_[i].page_id_ != INVALID_PAGE_ID && !frame_state_[i].io_in_progress_ && TryClaimFrame(*frame_id);
+    }
+    if (!found) {
+      return false;
+    }
+    replacer_->Pin(*frame_id);
+  }
+  if (pages_[*frame_id].is_dirty_) {
+    // The foreground has to write this one itself, the background writer is falling behind.
+    bg_writer_cv_.notify_one();
+  }
+  return true;
+}
+
+bool BufferPoolManagerInstance::TryClaimFrame(frame_id_t frame_id) {
+  int unpinned = 0;
+  return pages_[frame_id].pin_count_.compare_exchange_strong(unpinned, FRAME_CLAIMED, std::memory_order_acquire);
+}
+
+void BufferPoolManagerInstance::RecordAccess(frame_id_t frame_id, BufferAccessStrategy *strategy) {
+  replacer_->RecordAccess(frame_id);
+  // Counted without latch_, a racing update may get lost. At worst a ring then recycles a page used once more.
+  std::atomic<uint32_t> &usage_count = frame_state_[frame_id].usage_count_;
+  uint32_t usage = usage_count.load(std::memory_order_relaxed);
+  if (strategy == nullptr ? usage < MAX_USAGE_COUNT : usage == 0) {
+    usage_count.store(usage + 1, std::memory_order_relaxed);
+  }
+}
+
+bool BufferPoolManagerInstance::FindVictimPage(BufferAccessStrategy *strategy, frame_id_t *frame_id,
+                                               size_t *ring_slot) {
+  if (strategy == nullptr) {
+    return FindVictimPage(frame_id);
+  }
+  size_t ring_size = strategy->ring_.size();
+  *ring_slot = strategy->next_slot_;
+  for (size_t i = 0; i < ring_size; i++) {
+    size_t slot = (strategy->next_slot_ + i) % ring_size;
+    page_id_t page_id = strategy->ring_[slot].page_id_;
+    frame_id_t frame = strategy->ring_[slot].frame_id_;
+    // In a parallel pool the ring also holds pages of the other instances, those are recycled over there.
+    if (page_id != INVALID_PAGE_ID && page_id % num_instances_ != instance_index_) {
+      continue;
+    }
+    // An unused slot, a page that left its frame, its id may have been handed out again since, or a page a caller
+    // without the ring used meanwhile: fill the slot from the shared pool and leave the frame to the working set.
+    if (page_id == INVALID_PAGE_ID || static_cast<size_t>(frame) >= pool_size_ ||
+        pages_[frame].GetPageId() != page_id || frame_state_[frame].usage_count_ > 1) {
+      *ring_slot = slot;
+      break;
+    }
+    if (static_cast<size_t>(frame) >= target_pool_size_ || frame_state_[frame].io_in_progress_ ||
+        frame_state_[frame].bg_writing_ || !TryClaimFrame(frame)) {
+      continue;
+    }
+    // Recycle the frame of the ring page, taking it out of the replacer.
+    replacer_->Pin(frame);
+    *frame_id = frame;
+    *ring_slot = slot;
+    return true;
+  }
+  return FindVictimPage(frame_id);
+}
+
+void BufferPoolManagerInstance::AddToRing(BufferAccessStrategy *strategy, size_t ring_slot, page_id_t page_id,
+                                          frame_id_t frame_id) {
+  if (strategy == nullptr) {
+    return;
+  }
+  strategy->ring_[ring_slot].page_id_ = page_id;
+  strategy->ring_[ring_slot].frame_id_ = frame_id;
+  strategy->next_slot_ = (ring_slot + 1) % strategy->ring_.size();
+}
+
+void BufferPoolManagerInstance::WaitForPage(std::unique_lock<std::mutex> *lock, page_id_t page_id) {
+  while (true) {
+    frame_id_t frame_id;
+    if (page_table_.Find(page_id, &frame_id) && frame_state_[frame_id].io_in_progress_) {
+      // Someone else is reading P in, wait for the read instead of issuing a duplicate one.
+      frame_state_[frame_id].io_done_.wait(*lock);
+      continue;
+    }
+    auto wb_iter = write_back_table_.find(page_id);
+    if (wb_iter == write_back_table_.end()) {
+      return;
+    }
+    // P was just evicted and is still being written back, reading it now would see stale data.
+    frame_state_[wb_iter->second].io_done_.wait(*lock);
+  }
+}
+
+void BufferPoolManagerInstance::BeginIo(frame_id_t frame_id, page_id_t old_page_id, bool old_write_back) {
+  if (old_page_id != INVALID_PAGE_ID) {
+    page_table_.Remove(old_page_id);
+  }
+  if (old_write_back && old_page_id != INVALID_PAGE_ID) {
+    write_back_table_[old_page_id] = frame_id;
+  }
+  frame_state_[frame_id].io_in_progress_ = true;
+}
+
+void BufferPoolManagerInstance::EndIo(frame_id_t frame_id, page_id_t old_page_id, bool old_write_back) {
+  if (old_write_back && old_page_id != INVALID_PAGE_ID) {
+    write_back_table_.erase(old_page_id);
+  }
+  frame_state_[frame_id].io_in_progress_ = false;
+  frame_state_[frame_id].io_done_.notify_all();
+}
+
+void BufferPoolManagerInstance::WaitForBackgroundWrite(std::unique_lock<std::mutex> *lock, frame_id_t frame_id) {
+  frame_state_[frame_id].io_done_.wait(*lock, [&] { return !frame_state_[frame_id].bg_writing_; });
+}
+
+void BufferPoolManagerInstance::RunBackgroundWriter(double target_clean_ratio, size_t max_pages_per_round) {
+  std::scoped_lock lock(latch_);
+  bg_writer_clean_ratio_ = target_clean_ratio;
+  bg_writer_max_pages_ = max_pages_per_round;
+  if (bg_writer_thread_ != nullptr) {
+    return;
+  }
+  bg_writer_running_ = true;
+  bg_writer_thread_ = new std::thread(&BufferPoolManagerInstance::BackgroundWriterLoop, this);
+}
+
+void BufferPoolManagerInstance::StopBackgroundWriter() {
+  {
+    std::scoped_lock lock(latch_);
+    if (bg_writer_thread_ == nullptr) {
+      return;
+    }
+    bg_writer_running_ = false;
+  }
+  bg_writer_cv_.notify_one();
+  bg_writer_thread_->join();
+  delete bg_writer_thread_;
+  bg_writer_thread_ = nullptr;
+}
+
+void BufferPoolManagerInstance::BackgroundWriterLoop() {
+  std::unique_lock<std::mutex> lock(latch_);
+  while (bg_writer_running_) {
+    bg_writer_cv_.wait_for(lock, bg_writer_interval);
+    if (!bg_writer_running_) {
+      break;
+    }
+    BackgroundWriteRound(&lock);
+  }
+}
+
+size_t BufferPoolManagerInstance::BackgroundWriteRound(std::unique_lock<std::mutex> *lock) {
+  // Free frames and unpinned clean frames can be handed out without any write.
+  size_t clean = free_list_.size();
+  for (size_t i = 0; i < pool_size_; i++) {
+    Page *page = &pages_[i];
+    if (page->page_id_ != INVALID_PAGE_ID && page->pin_count_ == 0 && !page->is_dirty_ &&
+        !frame_state_[i].io_in_progress_) {
+      clean++;
+    }
+  }
+  auto target = static_cast<size_t>(bg_writer_clean_ratio_ * pool_size_ + 0.5);
+  size_t written = 0;
+  while (clean + written < target && written < bg_writer_max_pages_ && bg_writer_running_) {
+    frame_id_t frame_id;
+    if (!NextBackgroundWriteFrame(&frame_id)) {
+      break;
+    }
+    // The frame stays in the page table and the replacer, so hits are not blocked and its LRU position is kept.
+    // An eviction of the frame waits in WaitForBackgroundWrite before reusing the memory.
+    Page *page = &pages_[frame_id];
+    page_id_t page_id = page->page_id_;
+    frame_state_[frame_id].bg_writing_ = true;
+    // Cleared before the write, a modification racing with it marks the page dirty again on unpin.
+    page->is_dirty_ = false;
+    lock->unlock();
+
+    // The read latch keeps a thread that pinned the page meanwhile from modifying it halfway through the write.
+    page->RLatch();
+    disk_manager_->WritePage(page_id, page->GetData());
+    page->RUnlatch();
+
+    lock->lock();
+    frame_state_[frame_id].bg_writing_ = false;
+    frame_state_[frame_id].io_done_.notify_all();
+    written++;
+  }
+  return written;
+}
+
+bool BufferPoolManagerInstance::NextBackgroundWriteFrame(frame_id_t *frame_id) {
+  for (size_t i = 0; i < pool_size_; i++) {
+    // the pool may have shrunk below the cursor
+    size_t frame = bg_writer_cursor_ % pool_size_;
+    bg_writer_cursor_ = (frame + 1) % pool_size_;
+    Page *page = &pages_[frame];
+    if (page->page_id_ == INVALID_PAGE_ID || page->pin_count_ != 0 || !page->is_dirty_ ||
+        frame_state_[frame].io_in_progress_) {
+      continue;
+    }
+    if (enable_logging && log_manager_ != nullptr && page->GetLSN() > log_manager_->GetPersistentLSN()) {
+      continue;
+    }
+    *frame_id = static_cast<frame_id_t>(frame);
+    return true;
+  }
+  return false;
+}
+
+page_id_t BufferPoolManagerInstance::AllocatePage(page_id_t hint) {
+  const page_id_t page_id = disk_manager_->AllocatePage(num_instances_, instance_index_, hint);
+  ValidatePageId(page_id);
+  return page_id;
+}
+
+void BufferPoolManagerInstance::ValidatePageId(const page_id_t page_id) const {
+  assert(page_id % num_instances_ == instance_index_);  // allocated pages mod back to this BPI
+}
+
+}  // namespace bustub
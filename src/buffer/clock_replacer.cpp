@@ -12,18 +12,63 @@
 
 #include "buffer/clock_replacer.h"
 
+#include <algorithm>
+
 namespace bustub {
 
-ClockReplacer::ClockReplacer(size_t num_pages) {}
+ClockReplacer::ClockReplacer(size_t num_pages) : num_pages_(num_pages), frames_(num_pages), frame_limit_(num_pages) {}
 
 ClockReplacer::~ClockReplacer() = default;
 
-bool ClockReplacer::Victim(frame_id_t *frame_id) { return false; }
+bool ClockReplacer::Victim(frame_id_t *frame_id) {
+  // Every frame is visited at most twice: once to clear its reference bit, once to victimize it.
+  // Racing Pin/Unpin calls can defeat a sweep, so give up after a bounded number of steps.
+  size_t frame_limit = frame_limit_.load(std::memory_order_relaxed);
+  if (frame_limit == 0) {
+    return false;
+  }
+  for (size_t step = 0; step < 3 * frame_limit; step++) {
+    if (size_.load(std::memory_order_relaxed) == 0) {
+      return false;
+    }
+    size_t pos = clock_hand_.fetch_add(1, std::memory_order_relaxed) % frame_limit;
+    std::atomic<uint8_t> &frame = frames_[pos];
+    uint8_t state = frame.load(std::memory_order_acquire);
+    if ((state & IN_REPLACER) == 0) {
+      continue;
+    }
+    if ((state & REFERENCED) != 0) {
+      // second chance
+      frame.compare_exchange_strong(state, static_cast<uint8_t>(state & ~REFERENCED), std::memory_order_acq_rel);
+      continue;
+    }
+    if (frame.compare_exchange_strong(state, 0, std::memory_order_acq_rel)) {
+      size_.fetch_sub(1, std::memory_order_relaxed);
+      *frame_id = static_cast<frame_id_t>(pos);
+      return true;
+    }
+  }
+  return false;
+}
+
+void ClockReplacer::Pin(frame_id_t frame_id) {
+  uint8_t old_state = frames_[frame_id].fetch_and(static_cast<uint8_t>(~IN_REPLACER), std::memory_order_acq_rel);
+  if ((old_state & IN_REPLACER) != 0) {
+    size_.fetch_sub(1, std::memory_order_relaxed);
+  }
+}
 
-void ClockReplacer::Pin(frame_id_t frame_id) {}
+void ClockReplacer::Unpin(frame_id_t frame_id) {
+  uint8_t old_state = frames_[frame_id].fetch_or(IN_REPLACER | REFERENCED, std::memory_order_acq_rel);
+  if ((old_state & IN_REPLACER) == 0) {
+    size_.fetch_add(1, std::memory_order_relaxed);
+  }
+}
 
-void ClockReplacer::Unpin(frame_id_t frame_id) {}
+size_t ClockReplacer::Size() { return size_.load(std::memory_order_relaxed); }
 
-size_t ClockReplacer::Size() { return 0; }
+void ClockReplacer::SetFrameLimit(size_t num_frames) {
+  frame_limit_.store(std::min(num_frames, num_pages_), std::memory_order_relaxed);
+}
 
 }  // namespace bustub
@@ -0,0 +1,137 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lru_k_replacer.cpp
+//
+// Identification: src/buffer/lru_k_replacer.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/lru_k_replacer.h"
+
+#include <algorithm>
+
+namespace bustub {
+
+LRUKReplacer::LRUKReplacer(size_t num_pages, size_t k)
+    : frames_(num_pages), history_(num_pages * k), k_(k), frame_limit_(num_pages) {
+  BUSTUB_ASSERT(k > 0, "LRU-K needs at least one access per frame");
+}
+
+LRUKReplacer::~LRUKReplacer() = default;
+
+bool LRUKReplacer::Victim(frame_id_t *frame_id) {
+  std::scoped_lock lock(latch_);
+  if (curr_size_ == 0) {
+    return false;
+  }
+
+  // 优先淘汰访问次数不足k次的frame(K-distance为+inf)，其中最早一次访问最老的先淘汰；
+  // 否则淘汰第k次最近访问最老(K-distance最大)的frame
+  frame_id_t victim_frame = -1;
+  bool victim_infinite = false;
+  uint64_t victim_timestamp = 0;
+  for (size_t i = 0; i < frame_limit_; i++) {
+    const FrameHistory &frame = frames_[i];
+    if (!frame.evictable_) {
+      continue;
+    }
+    bool infinite = frame.count_ < k_;
+    uint64_t timestamp = OrderingTimestamp(i);
+    if (victim_frame == -1 || (infinite && !victim_infinite) ||
+        (infinite == victim_infinite && timestamp < victim_timestamp)) {
+      victim_frame = static_cast<frame_id_t>(i);
+      victim_infinite = infinite;
+      victim_timestamp = timestamp;
+    }
+  }
+
+  if (victim_frame == -1) {
+    // the evictable frames are all above the limit
+    return false;
+  }
+  // the frame will hold a different page from now on, forget its history
+  frames_[victim_frame] = FrameHistory();
+  curr_size_--;
+  *frame_id = victim_frame;
+  return true;
+}
+
+void LRUKReplacer::Pin(frame_id_t frame_id) {
+  std::scoped_lock lock(latch_);
+  BUSTUB_ASSERT(static_cast<size_t>(frame_id) < frames_.size(), "frame id out of range");
+  Track(frame_id);
+  if (frames_[frame_id].evictable_) {
+    frames_[frame_id].evictable_ = false;
+    curr_size_--;
+  }
+}
+
+void LRUKReplacer::Unpin(frame_id_t frame_id) {
+  std::scoped_lock lock(latch_);
+  BUSTUB_ASSERT(static_cast<size_t>(frame_id) < frames_.size(), "frame id out of range");
+  FrameHistory &frame = frames_[frame_id];
+  if (frame.evictable_) {
+    return;
+  }
+  // a frame that was never pinned still needs a timestamp to be ordered by
+  Track(frame_id);
+  frame.unpinned_since_access_ = true;
+  frame.evictable_ = true;
+  curr_size_++;
+}
+
+size_t LRUKReplacer::Size() {
+  std::scoped_lock lock(latch_);
+  return curr_size_;
+}
+
+void LRUKReplacer::RecordAccess(frame_id_t frame_id) {
+  std::scoped_lock lock(latch_);
+  BUSTUB_ASSERT(static_cast<size_t>(frame_id) < frames_.size(), "frame id out of range");
+  Track(frame_id);
+  FrameHistory &frame = frames_[frame_id];
+  uint64_t *history = &history_[frame_id * k_];
+  // 相关访问(correlated reference)只算一次：一直pin着，或者上一次访问的就是这个frame
+  if (frame.count_ > 0 && (!frame.unpinned_since_access_ || history[frame.last_] + 1 == current_timestamp_)) {
+    return;
+  }
+  frame.last_ = frame.count_ == 0 ? 0 : (frame.last_ + 1) % k_;
+  history[frame.last_] = current_timestamp_++;
+  frame.count_ = std::min(frame.count_ + 1, k_);
+  frame.unpinned_since_access_ = false;
+}
+
+void LRUKReplacer::SetFrameLimit(size_t num_frames) {
+  std::scoped_lock lock(latch_);
+  // frames above a lower limit keep their history, the pool may still unpin them or grow back
+  if (num_frames > frames_.size()) {
+    frames_.resize(num_frames);
+    history_.resize(num_frames * k_);
+  }
+  frame_limit_ = num_frames;
+}
+
+void LRUKReplacer::Track(frame_id_t frame_id) {
+  FrameHistory &frame = frames_[frame_id];
+  if (!frame.tracked_) {
+    frame.tracked_ = true;
+    // not an access: ticking the clock here would split the correlated accesses of a scan whenever a prefetched
+    // frame shows up between them
+    frame.first_seen_ = current_timestamp_;
+  }
+}
+
+uint64_t LRUKReplacer::OrderingTimestamp(size_t frame_id) const {
+  const FrameHistory &frame = frames_[frame_id];
+  if (frame.count_ < k_) {
+    return frame.first_seen_;
+  }
+  // the K-th most recent access is in the slot after the most recent one
+  return history_[frame_id * k_ + (frame.last_ + 1) % k_];
+}
+
+}  // namespace bustub
@@ -0,0 +1,97 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table.cpp
+//
+// Identification: src/buffer/page_table.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/page_table.h"
+
+#include "common/macros.h"
+
+namespace bustub {
+
+PageTable::PageTable(size_t max_entries) {
+  // At most half full, so probe sequences stay short.
+  size_t capacity = 2;
+  while (capacity < 2 * max_entries) {
+    capacity <<= 1;
+  }
+  mask_ = capacity - 1;
+  slots_ = std::vector<std::atomic<uint64_t>>(capacity);
+  for (auto &slot : slots_) {
+    slot.store(EMPTY_SLOT, std::memory_order_relaxed);
+  }
+}
+
+size_t PageTable::HomeSlot(page_id_t page_id) const {
+  // Fibonacci hashing, consecutive page ids land far apart.
+  return (static_cast<uint64_t>(static_cast<uint32_t>(page_id)) * 0x9E3779B97F4A7C15ULL >> 20) & mask_;
+}
+
+bool PageTable::Find(page_id_t page_id, frame_id_t *frame_id) const {
+  for (size_t pos = HomeSlot(page_id);; pos = (pos + 1) & mask_) {
+    uint64_t slot = slots_[pos].load(std::memory_order_acquire);
+    if (slot == EMPTY_SLOT) {
+      return false;
+    }
+    if (SlotPageId(slot) == page_id) {
+      *frame_id = SlotFrameId(slot);
+      return true;
+    }
+  }
+}
+
+void PageTable::Insert(page_id_t page_id, frame_id_t frame_id) {
+  BUSTUB_ASSERT(page_id != INVALID_PAGE_ID, "INVALID_PAGE_ID cannot be mapped");
+  for (size_t pos = HomeSlot(page_id);; pos = (pos + 1) & mask_) {
+    uint64_t slot = slots_[pos].load(std::memory_order_relaxed);
+    if (slot == EMPTY_SLOT) {
+      BUSTUB_ASSERT(size_.load(std::memory_order_relaxed) <= mask_ / 2, "page table is full");
+      slots_[pos].store(Pack(page_id, frame_id), std::memory_order_release);
+      size_.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    if (SlotPageId(slot) == page_id) {
+      slots_[pos].store(Pack(page_id, frame_id), std::memory_order_release);
+      return;
+    }
+  }
+}
+
+void PageTable::Remove(page_id_t page_id) {
+  size_t hole = HomeSlot(page_id);
+  for (;; hole = (hole + 1) & mask_) {
+    uint64_t slot = slots_[hole].load(std::memory_order_relaxed);
+    if (slot == EMPTY_SLOT) {
+      return;
+    }
+    if (SlotPageId(slot) == page_id) {
+      break;
+    }
+  }
+  // Backward shift: move every later entry of the cluster whose home slot does not lie in (hole, pos] into the hole.
+  for (size_t pos = (hole + 1) & mask_;; pos = (pos + 1) & mask_) {
+    uint64_t slot = slots_[pos].load(std::memory_order_relaxed);
+    if (slot == EMPTY_SLOT) {
+      break;
+    }
+    size_t home = HomeSlot(SlotPageId(slot));
+    bool home_in_range = hole <= pos ? (hole < home && home <= pos) : (hole < home || home <= pos);
+    if (home_in_range) {
+      continue;
+    }
+    // Copy first, so the entry is always reachable by a reader that starts probing after the copy.
+    slots_[hole].store(slot, std::memory_order_release);
+    hole = pos;
+  }
+  slots_[hole].store(EMPTY_SLOT, std::memory_order_release);
+  size_.fetch_sub(1, std::memory_order_relaxed);
+}
+
+}  // namespace bustub
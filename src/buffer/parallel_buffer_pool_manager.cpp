@@ -0,0 +1,165 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_buffer_pool_manager.cpp
+//
+// Identification: src/buffer/parallel_buffer_pool_manager.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/parallel_buffer_pool_manager.h"
+
+namespace bustub {
+
+ParallelBufferPoolManager::ParallelBufferPoolManager(size_t num_instances, size_t pool_size, DiskManager *disk_manager,
+                                                     LogManager *log_manager, ReplacerType replacer_type,
+                                                     size_t max_pool_size)
+    : num_instances_(num_instances) {
+  BUSTUB_ASSERT(num_instances > 0, "ParallelBufferPoolManager needs at least one instance");
+  // Allocate and create individual BufferPoolManagerInstances
+  instances_.reserve(num_instances_);
+  for (size_t i = 0; i < num_instances_; i++) {
+    instances_.push_back(
+        new BufferPoolManagerInstance(pool_size, num_instances_, i, disk_manager, log_manager, replacer_type,
+                                      max_pool_size));
+  }
+}
+
+ParallelBufferPoolManager::~ParallelBufferPoolManager() {
+  for (auto instance : instances_) {
+    delete instance;
+  }
+}
+
+size_t ParallelBufferPoolManager::GetPoolSize() {
+  size_t pool_size = 0;
+  for (auto instance : instances_) {
+    pool_size += instance->GetPoolSize();
+  }
+  return pool_size;
+}
+
+bool ParallelBufferPoolManager::Resize(size_t pool_size) {
+  if (pool_size < num_instances_) {
+    return false;
+  }
+  // the first pool_size % num_instances_ instances get one frame more
+  auto share = [&](size_t i) { return pool_size / num_instances_ + (i < pool_size % num_instances_ ? 1 : 0); };
+  for (size_t i = 0; i < num_instances_; i++) {
+    if (share(i) > instances_[i]->GetMaxPoolSize()) {
+      return false;
+    }
+  }
+  bool resized = true;
+  for (size_t i = 0; i < num_instances_; i++) {
+    resized = instances_[i]->Resize(share(i)) && resized;
+  }
+  return resized;
+}
+
+void ParallelBufferPoolManager::RunBackgroundWriter(double target_clean_ratio, size_t max_pages_per_round) {
+  for (auto instance : instances_) {
+    instance->RunBackgroundWriter(target_clean_ratio, max_pages_per_round);
+  }
+}
+
+void ParallelBufferPoolManager::StopBackgroundWriter() {
+  for (auto instance : instances_) {
+    instance->StopBackgroundWriter();
+  }
+}
+
+BufferPoolManagerInstance *ParallelBufferPoolManager::GetBufferPoolManager(page_id_t page_id) {
+  // Get BufferPoolManager responsible for handling given page id. You can use this method in your other methods.
+  return instances_[page_id % num_instances_];
+}
+
+Page *ParallelBufferPoolManager::FetchResidentPage(page_id_t page_id) {
+  return GetBufferPoolManager(page_id)->FetchResidentPage(page_id);
+}
+
+Page *ParallelBufferPoolManager::FetchSwizzledPage(Page *frame, page_id_t page_id) {
+  return GetBufferPoolManager(page_id)->FetchSwizzledPage(frame, page_id);
+}
+
+void ParallelBufferPoolManager::PrefetchPages(const std::vector<page_id_t> &page_ids) {
+  std::vector<std::vector<page_id_t>> per_instance(num_instances_);
+  for (auto page_id : page_ids) {
+    if (page_id != INVALID_PAGE_ID) {
+      per_instance[page_id % num_instances_].push_back(page_id);
+    }
+  }
+  for (size_t i = 0; i < num_instances_; i++) {
+    if (!per_instance[i].empty()) {
+      instances_[i]->PrefetchPages(per_instance[i]);
+    }
+  }
+}
+
+Page *ParallelBufferPoolManager::FetchPageImpl(page_id_t page_id, BufferAccessStrategy *strategy) {
+  // Fetch page for page_id from responsible BufferPoolManagerInstance
+  if (strategy != nullptr) {
+    return GetBufferPoolManager(page_id)->FetchPage(page_id, *strategy);
+  }
+  return GetBufferPoolManager(page_id)->FetchPage(page_id);
+}
+
+bool ParallelBufferPoolManager::UnpinPageImpl(page_id_t page_id, bool is_dirty) {
+  // Unpin page_id from responsible BufferPoolManagerInstance
+  return GetBufferPoolManager(page_id)->UnpinPage(page_id, is_dirty);
+}
+
+bool ParallelBufferPoolManager::FlushPageImpl(page_id_t page_id) {
+  // Flush page_id from responsible BufferPoolManagerInstance
+  return GetBufferPoolManager(page_id)->FlushPage(page_id);
+}
+
+Page *ParallelBufferPoolManager::NewPageImpl(page_id_t *page_id, BufferAccessStrategy *strategy, page_id_t hint) {
+  // create new page. We will request page allocation in a round robin manner from the underlying
+  // BufferPoolManagerInstances
+  // 1.   From a starting index of the BPMIs, call NewPageImpl until either 1) success and return 2) looped around to
+  // starting index and return nullptr
+  // 2.   Bump the starting index (mod number of instances) to start search at a different BPMI each time this function
+  // is called
+  size_t start;
+  {
+    std::scoped_lock lock(latch_);
+    start = start_index_;
+    start_index_ = (start_index_ + 1) % num_instances_;
+  }
+  for (size_t i = 0; i < num_instances_; i++) {
+    BufferPoolManagerInstance *instance = instances_[(start + i) % num_instances_];
+    Page *page = strategy != nullptr ? instance->NewPage(page_id, *strategy, hint) : instance->NewPage(page_id, hint);
+    if (page != nullptr) {
+      return page;
+    }
+  }
+  return nullptr;
+}
+
+segment_id_t ParallelBufferPoolManager::CreateSegment() { return instances_[0]->CreateSegment(); }
+
+void ParallelBufferPoolManager::DropSegment(segment_id_t segment_id) {
+  for (size_t i = 1; i < num_instances_; i++) {
+    instances_[i]->DiscardSegment(segment_id);
+  }
+  // the instances share the disk manager
+  instances_[0]->DropSegment(segment_id);
+}
+
+bool ParallelBufferPoolManager::DeletePageImpl(page_id_t page_id) {
+  // Delete page_id from responsible BufferPoolManagerInstance
+  return GetBufferPoolManager(page_id)->DeletePage(page_id);
+}
+
+void ParallelBufferPoolManager::FlushAllPagesImpl() {
+  // flush all pages from all BufferPoolManagerInstances
+  for (auto instance : instances_) {
+    instance->FlushAllPages();
+  }
+}
+
+}  // namespace bustub
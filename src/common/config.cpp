@@ -18,6 +18,10 @@ std::atomic<bool> enable_logging(false);
 
 std::chrono::duration<int64_t> log_timeout = std::chrono::seconds(1);
 
+std::chrono::milliseconds bg_writer_interval = std::chrono::milliseconds(10);
+
+std::chrono::milliseconds resize_drain_timeout = std::chrono::milliseconds(1000);
+
 std::chrono::milliseconds cycle_detection_interval = std::chrono::milliseconds(50);
 
 }  // namespace bustub
@@ -0,0 +1,59 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_access_strategy.h
+//
+// Identification: src/include/buffer/buffer_access_strategy.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <vector>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * BufferAccessStrategy confines a bulk operation, a large sequential scan or a bulk load, to a small ring of frames.
+ * Pages the operation reads in or creates join the ring. Once the ring is full, the frame of the oldest ring page is
+ * recycled instead of evicting a page of the shared working set. Pages that are already resident are used in place
+ * and never join the ring. A ring page that a caller without the ring used meanwhile has joined the working set, its
+ * slot is filled from the shared pool instead.
+ *
+ * A strategy belongs to a single operation and is not thread safe. The ring should be larger than the number of
+ * pages the operation keeps pinned at a time, pinned ring pages are skipped and the shared pool is used instead.
+ * TableHeap::MakeBulkAccessStrategy decides whether a table is large enough for a ring and sizes it to the pool.
+ */
+class BufferAccessStrategy {
+ public:
+  /**
+   * Create a new BufferAccessStrategy.
+   * @param ring_size the number of frames the operation may occupy
+   */
+  explicit BufferAccessStrategy(size_t ring_size = BULK_RING_SIZE) : ring_(ring_size) {}
+
+  /** @return the number of frames the operation may occupy */
+  size_t GetRingSize() const { return ring_.size(); }
+
+ private:
+  friend class BufferPoolManagerInstance;
+
+  /** A page brought in through this strategy and the frame it was brought into. */
+  struct RingSlot {
+    /** INVALID_PAGE_ID marks an unused slot. */
+    page_id_t page_id_{INVALID_PAGE_ID};
+    frame_id_t frame_id_{-1};
+  };
+
+  /** Pages brought in through this strategy. A slot is only recycled while its frame still holds its page. */
+  std::vector<RingSlot> ring_;
+  /** The slot recycled next, the ring is reused in FIFO order. */
+  size_t next_slot_{0};
+};
+
+}  // namespace bustub
@@ -12,62 +12,37 @@
 
 #pragma once
 
-#include <list>
-#include <mutex>  // NOLINT
-#include <unordered_map>
+#include <vector>
 
-#include "buffer/lru_replacer.h"
+#include "buffer/buffer_access_strategy.h"
+#include "common/config.h"
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
 #include "storage/page/page.h"
 
-/* PROJECT #1 - BUFFER POOL | TASK #2 - BUFFER POOL MANAGER
-您需要在系统中实现BufferPoolManager。
-BufferPoolManager负责从DiskManager读取数据库页并将它们存储在内存中。
-BufferPoolManager也可以在明确指示这样做或当它需要驱逐页面为新页面腾出空间时，将脏页面写入磁盘。
-为了确保您的实现与系统的其余部分一起正常工作，我们将为您提供一些已经填充的功能。
-您也不需要实现实际将数据读取和写入磁盘的代码（这在我们的实现中称为DiskManager）。我们将为您提供该功能。
-系统中的所有内存页面都由Page对象表示。在BufferPoolManager并不需要了解这些页面的内容。
-但作为系统开发人员，了解Page对象只是缓冲池中内存的容器，因此并不特定于唯一页面，这一点很重要。
-也就是说，每个Page对象都包含一块内存，DiskManager将使用该内存块来复制它从磁盘读取的物理页的内容。
-当它来回移动到磁盘时，BufferPoolManager将重用相同的Page对象来存储数据。
-这意味着在系统的整个生命周期中，同一个Page对象可能包含不同的物理页面。
-该Page对象的标识符(page_id)会跟踪它包含的物理页面；如果Page对象不包含物理页，则其page_id必须设置为INVALID_PAGE_ID。
-每个Page对象还为“固定”该页面的线程数维护一个计数器。您的BufferPoolManager不允许释放被固定的页面，并且跟踪每个Page对象是否脏。
-您的工作是在取消固定页面之前记录页面是否被修改。您的BufferPoolManager必须先将脏页的内容写回磁盘，然后才能重用该对象。
-您的BufferPoolManager实现将使用您在本作业的前面步骤中创建的LRUReplacer类。
-使用LRUReplacer来跟踪何时访问Page对象，以便可以决定在必须释放frame以腾出空间来从磁盘复制新物理页时驱逐哪个对象。
-*/
-
 namespace bustub {
 
 /**
- * 主要数据结构是一个page数组(pages_)，frame_id作为其下标。
- * 还有一个哈希表(page_table_)，表示从page_id到frame_id的映射。
- * BufferPoolManager reads disk pages to and from its internal buffer pool.
+ * BufferPoolManager is the interface shared by every buffer pool implementation.
+ * BPlusTree, TableHeap, the hash table and the executors only ever talk to this interface, so a single
+ * BufferPoolManagerInstance and a ParallelBufferPoolManager can be used interchangeably.
  */
 class BufferPoolManager {
  public:
   enum class CallbackType { BEFORE, AFTER };
   using bufferpool_callback_fn = void (*)(enum CallbackType, const page_id_t page_id);
 
-  /**
-   * Creates a new BufferPoolManager.
-   * @param pool_size the size of the buffer pool
-   * @param disk_manager the disk manager
-   * @param log_manager the log manager (for testing only: nullptr = disable logging)
-   */
-  BufferPoolManager(size_t pool_size, DiskManager *disk_manager, LogManager *log_manager = nullptr);
+  BufferPoolManager() = default;
 
   /**
    * Destroys an existing BufferPoolManager.
    */
-  ~BufferPoolManager();
+  virtual ~BufferPoolManager() = default;
 
   /** Grading function. Do not modify! */
   Page *FetchPage(page_id_t page_id, bufferpool_callback_fn callback = nullptr) {
     GradingCallback(callback, CallbackType::BEFORE, page_id);
-    auto *result = FetchPageImpl(page_id);
+    auto *result = FetchPageImpl(page_id, nullptr);
     GradingCallback(callback, CallbackType::AFTER, page_id);
     return result;
   }
@@ -91,7 +66,7 @@ class BufferPoolManager {
   /** Grading function. Do not modify! */
   Page *NewPage(page_id_t *page_id, bufferpool_callback_fn callback = nullptr) {
     GradingCallback(callback, CallbackType::BEFORE, INVALID_PAGE_ID);
-    auto *result = NewPageImpl(page_id);
+    auto *result = NewPageImpl(page_id, nullptr, INVALID_PAGE_ID);
     GradingCallback(callback, CallbackType::AFTER, *page_id);
     return result;
   }
@@ -111,11 +86,96 @@ class BufferPoolManager {
     GradingCallback(callback, CallbackType::AFTER, INVALID_PAGE_ID);
   }
 
-  /** @return pointer to all the pages in the buffer pool */
-  Page *GetPages() { return pages_; }
+  /**
+   * Fetch a page for a bulk operation. A miss recycles a frame of the strategy's ring, see BufferAccessStrategy.
+   * @param page_id id of page to be fetched
+   * @param strategy the ring of the bulk operation
+   * @return the requested page, nullptr if it could not be brought in
+   */
+  Page *FetchPage(page_id_t page_id, BufferAccessStrategy &strategy) { return FetchPageImpl(page_id, &strategy); }
+
+  /**
+   * Create a new page for a bulk operation, in a frame of the strategy's ring, see BufferAccessStrategy.
+   * @param[out] page_id id of created page
+   * @param strategy the ring of the bulk operation
+   * @param hint a page of the object the new page belongs to, see DiskManager::AllocatePage
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  Page *NewPage(page_id_t *page_id, BufferAccessStrategy &strategy, page_id_t hint = INVALID_PAGE_ID) {
+    return NewPageImpl(page_id, &strategy, hint);
+  }
+
+  /**
+   * Create a new page of the object hint belongs to, on disk it goes to an extent of that object.
+   * @param[out] page_id id of created page
+   * @param hint a page of the object the new page belongs to, see DiskManager::AllocatePage
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  Page *NewPage(page_id_t *page_id, page_id_t hint) { return NewPageImpl(page_id, nullptr, hint); }
 
   /** @return size of the buffer pool */
-  size_t GetPoolSize() { return pool_size_; }
+  virtual size_t GetPoolSize() = 0;
+
+  /**
+   * Grow or shrink the buffer pool while it is in use. New frames go to the free list. A shrink drains the frames at
+   * the tail of the pool: their pages are written back if dirty and evicted, pinned ones are waited for, and their
+   * memory is given back to the system. A page that stays pinned for resize_drain_timeout stops the shrink, the pool
+   * keeps the frames up to its frame and GetPoolSize tells how far it got.
+   * @param pool_size the new number of frames
+   * @return false if pool_size is 0 or more than the pool was created to hold, nothing is changed then, or if the
+   * shrink stopped at a pinned page
+   */
+  virtual bool Resize(size_t pool_size) = 0;
+
+  /**
+   * Start the background writer. Every bg_writer_interval it writes unpinned dirty pages back to disk until
+   * at least target_clean_ratio of the frames are free or clean, so that evictions rarely have to write.
+   * @param target_clean_ratio fraction of frames that should be free or clean, in [0, 1]
+   * @param max_pages_per_round the most pages written per wake-up, this bounds the write rate
+   */
+  virtual void RunBackgroundWriter(double target_clean_ratio = BG_WRITER_CLEAN_RATIO,
+                                   size_t max_pages_per_round = BG_WRITER_MAX_PAGES) = 0;
+
+  /** Stop the background writer, waiting for the page it is writing. No-op if it is not running. */
+  virtual void StopBackgroundWriter() = 0;
+
+  /**
+   * Pin a page only if it is already in the buffer pool and readable. Never does any I/O.
+   * @param page_id id of page to be fetched
+   * @return the pinned page, nullptr if it is not resident or still being read in
+   */
+  virtual Page *FetchResidentPage(page_id_t page_id) = 0;
+
+  /**
+   * Pin a page through the frame it was last found in, without a page table lookup. This is how a swizzled
+   * reference is followed, see Page::GetSwips. Never does any I/O.
+   * @param frame the frame page_id was in when the reference was swizzled
+   * @param page_id id of the page
+   * @return the pinned page, nullptr if the frame holds another page by now or is being read into; the caller
+   * then falls back to FetchPage and swizzles the reference again
+   */
+  virtual Page *FetchSwizzledPage(Page *frame, page_id_t page_id) = 0;
+
+  /**
+   * Ask the buffer pool to read pages in the background. The pages are not pinned for the caller, they only
+   * become resident so that a later FetchPage hits. This is a hint: pages are dropped when every frame is pinned
+   * or when they were never allocated.
+   * @param page_ids ids of the pages that are about to be fetched, in the order they will be needed
+   */
+  virtual void PrefetchPages(const std::vector<page_id_t> &page_ids) = 0;
+
+  /**
+   * Create a segment file for a new table or index, see DiskManager::CreateSegment.
+   * @return the id of the new segment
+   */
+  virtual segment_id_t CreateSegment() = 0;
+
+  /**
+   * Drop a table or index at once: its pages leave the buffer pool without being written back and its segment file
+   * is unlinked. Pages still pinned are waited for, none may be fetched once the drop started.
+   * @param segment_id id of the segment to drop
+   */
+  virtual void DropSegment(segment_id_t segment_id) = 0;
 
  protected:
   /**
@@ -134,9 +194,10 @@ class BufferPoolManager {
   /**
    * Fetch the requested page from the buffer pool.
    * @param page_id id of page to be fetched
+   * @param strategy the ring to bring the page into on a miss, nullptr to use the whole pool
    * @return the requested page
    */
-  Page *FetchPageImpl(page_id_t page_id);
+  virtual Page *FetchPageImpl(page_id_t page_id, BufferAccessStrategy *strategy) = 0;
 
   /**
    * Unpin the target page from the buffer pool.
@@ -144,57 +205,35 @@ class BufferPoolManager {
    * @param is_dirty true if the page should be marked as dirty, false otherwise
    * @return false if the page pin count is <= 0 before this call, true otherwise
    */
-  bool UnpinPageImpl(page_id_t page_id, bool is_dirty);
+  virtual bool UnpinPageImpl(page_id_t page_id, bool is_dirty) = 0;
 
   /**
    * Flushes the target page to disk.
    * @param page_id id of page to be flushed, cannot be INVALID_PAGE_ID
    * @return false if the page could not be found in the page table, true otherwise
    */
-  bool FlushPageImpl(page_id_t page_id);
+  virtual bool FlushPageImpl(page_id_t page_id) = 0;
 
   /**
    * Creates a new page in the buffer pool.
    * @param[out] page_id id of created page
+   * @param strategy the ring to create the page in, nullptr to use the whole pool
+   * @param hint a page of the object the new page belongs to, INVALID_PAGE_ID if none
    * @return nullptr if no new pages could be created, otherwise pointer to new page
    */
-  Page *NewPageImpl(page_id_t *page_id);
+  virtual Page *NewPageImpl(page_id_t *page_id, BufferAccessStrategy *strategy, page_id_t hint) = 0;
 
   /**
    * Deletes a page from the buffer pool.
    * @param page_id id of page to be deleted
    * @return false if the page exists but could not be deleted, true if the page didn't exist or deletion succeeded
    */
-  bool DeletePageImpl(page_id_t page_id);
+  virtual bool DeletePageImpl(page_id_t page_id) = 0;
 
   /**
    * Flushes all the pages in the buffer pool to disk.
    */
-  void FlushAllPagesImpl();
-
-  bool FindVictimPage(frame_id_t *frame_id);
-  void UpdatePage(Page *page, page_id_t page_id, frame_id_t frame_id);
-
-  // 这里需要理解：pages就是缓冲区当前存的pool_size个page，可以用frame_id作为下标取出缓冲区的单个page
-  // page_id表示由diskmanager分配得到的page编号，目前是id自增策略，它的大小完全有可能超过pool_size
-  // frame_id表示缓冲区中的每页占的位置，它的范围只能是[0,pool_size)
-  // page_table表示现在放入缓冲区的page_id与对应占的位置frame_id
-
-  /** Number of pages in the buffer pool. */
-  size_t pool_size_;
-  /** Array of buffer pool pages. 大小为pool_size_，下标为[0,pool_size_) */
-  Page *pages_;
-  /** Pointer to the disk manager. */
-  DiskManager *disk_manager_ __attribute__((__unused__));
-  /** Pointer to the log manager. */
-  LogManager *log_manager_ __attribute__((__unused__));
-  /** Page table for keeping track of buffer pool pages. */
-  std::unordered_map<page_id_t, frame_id_t> page_table_;
-  /** Replacer to find unpinned pages for replacement. 大小为pool_size_*/
-  Replacer *replacer_;
-  /** List of free pages. 最开始，所有页都在free_list中*/
-  std::list<frame_id_t> free_list_;
-  /** This latch protects shared data structures. We recommend updating this comment to describe what it protects. */
-  std::mutex latch_;
+  virtual void FlushAllPagesImpl() = 0;
 };
+
 }  // namespace bustub
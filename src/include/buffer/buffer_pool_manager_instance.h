@@ -0,0 +1,374 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_manager_instance.h
+//
+// Identification: src/include/buffer/buffer_pool_manager_instance.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <list>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "buffer/lru_replacer.h"
+#include "buffer/page_table.h"
+#include "buffer/replacer.h"
+#include "recovery/log_manager.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/page/page.h"
+
+/* PROJECT #1 - BUFFER POOL | TASK #2 - BUFFER POOL MANAGER
+您需要在系统中实现BufferPoolManager。
+BufferPoolManager负责从DiskManager读取数据库页并将它们存储在内存中。
+BufferPoolManager也可以在明确指示这样做或当它需要驱逐页面为新页面腾出空间时，将脏页面写入磁盘。
+为了确保您的实现与系统的其余部分一起正常工作，我们将为您提供一些已经填充的功能。
+您也不需要实现实际将数据读取和写入磁盘的代码（这在我们的实现中称为DiskManager）。我们将为您提供该功能。
+系统中的所有内存页面都由Page对象表示。在BufferPoolManager并不需要了解这些页面的内容。
+但作为系统开发人员，了解Page对象只是缓冲池中内存的容器，因此并不特定于唯一页面，这一点很重要。
+也就是说，每个Page对象都包含一块内存，DiskManager将使用该内存块来复制它从磁盘读取的物理页的内容。
+当它来回移动到磁盘时，BufferPoolManager将重用相同的Page对象来存储数据。
+这意味着在系统的整个生命周期中，同一个Page对象可能包含不同的物理页面。
+该Page对象的标识符(page_id)会跟踪它包含的物理页面；如果Page对象不包含物理页，则其page_id必须设置为INVALID_PAGE_ID。
+每个Page对象还为“固定”该页面的线程数维护一个计数器。您的BufferPoolManager不允许释放被固定的页面，并且跟踪每个Page对象是否脏。
+您的工作是在取消固定页面之前记录页面是否被修改。您的BufferPoolManager必须先将脏页的内容写回磁盘，然后才能重用该对象。
+您的BufferPoolManager实现将使用您在本作业的前面步骤中创建的LRUReplacer类。
+使用LRUReplacer来跟踪何时访问Page对象，以便可以决定在必须释放frame以腾出空间来从磁盘复制新物理页时驱逐哪个对象。
+*/
+
+namespace bustub {
+
+/**
+ * 主要数据结构是一个page数组(pages_)，frame_id作为其下标。
+ * 还有一个哈希表(page_table_)，表示从page_id到frame_id的映射。
+ * BufferPoolManagerInstance reads disk pages to and from its internal buffer pool.
+ *
+ * A fetch of a resident page and an unpin take no latch: the page table can be read latch-free and the pin count
+ * is atomic. The buffer pool claims a frame by swinging its pin count from 0 to -1 before it reuses it, so a
+ * latch-free pin and an eviction of the same frame can never both succeed. Everything else runs under latch_.
+ */
+class BufferPoolManagerInstance : public BufferPoolManager {
+ public:
+  /**
+   * Creates a new BufferPoolManagerInstance.
+   * @param pool_size the size of the buffer pool
+   * @param disk_manager the disk manager
+   * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param replacer_type the replacement policy used to pick victim frames
+   * @param max_pool_size the most frames Resize may grow the pool to, 0 for pool_size
+   */
+  BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager, LogManager *log_manager = nullptr,
+                            ReplacerType replacer_type = ReplacerType::LRU, size_t max_pool_size = 0);
+
+  /**
+   * Creates a new BufferPoolManagerInstance that is one shard of a ParallelBufferPoolManager.
+   * The instance only owns the page ids p with p % num_instances == instance_index.
+   * @param pool_size the size of the buffer pool
+   * @param num_instances total number of BPIs in the parallel BPM
+   * @param instance_index index of this BPI in the parallel BPM
+   * @param disk_manager the disk manager
+   * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param replacer_type the replacement policy used to pick victim frames
+   * @param max_pool_size the most frames Resize may grow the pool to, 0 for pool_size
+   */
+  BufferPoolManagerInstance(size_t pool_size, uint32_t num_instances, uint32_t instance_index,
+                            DiskManager *disk_manager, LogManager *log_manager = nullptr,
+                            ReplacerType replacer_type = ReplacerType::LRU, size_t max_pool_size = 0);
+
+  /**
+   * Destroys an existing BufferPoolManagerInstance.
+   */
+  ~BufferPoolManagerInstance() override;
+
+  /** @return pointer to all the pages in the buffer pool */
+  Page *GetPages() { return pages_; }
+
+  /** @return size of the buffer pool */
+  size_t GetPoolSize() override { return pool_size_; }
+
+  /** @return the most frames the pool can be resized to */
+  size_t GetMaxPoolSize() const { return max_pool_size_; }
+
+  bool Resize(size_t pool_size) override;
+
+  void RunBackgroundWriter(double target_clean_ratio = BG_WRITER_CLEAN_RATIO,
+                           size_t max_pages_per_round = BG_WRITER_MAX_PAGES) override;
+
+  void StopBackgroundWriter() override;
+
+  Page *FetchResidentPage(page_id_t page_id) override;
+
+  Page *FetchSwizzledPage(Page *frame, page_id_t page_id) override;
+
+  void PrefetchPages(const std::vector<page_id_t> &page_ids) override;
+
+  segment_id_t CreateSegment() override;
+
+  void DropSegment(segment_id_t segment_id) override;
+
+  /**
+   * Throw the pages of a segment out of this instance without writing them back, waiting for their I/O in flight
+   * and for pages still pinned to be unpinned. Prefetches of its pages that did not start are dropped.
+   * @param segment_id id of the segment about to be dropped
+   */
+  void DiscardSegment(segment_id_t segment_id);
+
+ protected:
+  Page *FetchPageImpl(page_id_t page_id, BufferAccessStrategy *strategy) override;
+  bool UnpinPageImpl(page_id_t page_id, bool is_dirty) override;
+  bool FlushPageImpl(page_id_t page_id) override;
+  Page *NewPageImpl(page_id_t *page_id, BufferAccessStrategy *strategy, page_id_t hint) override;
+  bool DeletePageImpl(page_id_t page_id) override;
+  void FlushAllPagesImpl() override;
+
+  /**
+   * Find a victim frame, from the free list first, then from the replacer. Must be called with latch_ held.
+   * @param[out] frame_id the victim frame, claimed for the caller
+   * @return false if there is no victim frame
+   */
+  bool FindVictimPage(frame_id_t *frame_id);
+
+  /**
+   * Claim an unpinned frame for reuse, latch-free pins of it fail from now on. Must be called with latch_ held.
+   * @return false if the frame is pinned
+   */
+  bool TryClaimFrame(frame_id_t frame_id);
+
+  /**
+   * Pin the page in a frame found without latch_, if the frame still holds page_id and is readable.
+   * The frame's guard keeps a shrink from releasing its memory meanwhile, see FrameState::guard_.
+   * @return the pinned page, nullptr if the frame is retired, claimed, being read into or holds another page
+   */
+  Page *TryPinFrame(frame_id_t frame_id, page_id_t page_id);
+
+  /**
+   * Pin page_id if it is resident and readable, without taking latch_.
+   * @return the pinned page, nullptr if the page is not resident, still being read in, or the lookup raced with
+   * a change of the page table; the caller then retries under latch_
+   */
+  Page *TryPinResident(page_id_t page_id);
+
+  /**
+   * Record an access of the page in frame_id, with the replacer and in the frame's usage count.
+   * @param strategy the ring of the accessing bulk operation, nullptr for any other caller
+   */
+  void RecordAccess(frame_id_t frame_id, BufferAccessStrategy *strategy);
+
+  /**
+   * Find a victim frame for a bulk operation. Ring pages of this instance that are unpinned are recycled in FIFO
+   * order, while the ring is not full or all its pages are in use the shared pool is used via FindVictimPage.
+   * A slot whose frame no longer holds its page, or whose page was used by a caller without the ring, is filled from
+   * the shared pool instead.
+   * @param strategy the ring of the bulk operation
+   * @param[out] frame_id the victim frame
+   * @param[out] ring_slot the ring slot the page brought into the victim frame takes, see AddToRing
+   * @return false if there is no victim frame
+   */
+  bool FindVictimPage(BufferAccessStrategy *strategy, frame_id_t *frame_id, size_t *ring_slot);
+
+  /** Put page_id, brought into frame_id, into ring_slot of the strategy's ring, the slot after it is recycled next. */
+  void AddToRing(BufferAccessStrategy *strategy, size_t ring_slot, page_id_t page_id, frame_id_t frame_id);
+
+  /**
+   * Read page_id into a victim frame. Must be called with latch_ held and page_id not resident.
+   * latch_ is released during the write-back of the victim and the read.
+   * @param lock the held lock on latch_
+   * @param page_id id of the page to read
+   * @param pin true to return the page pinned once, false to leave it unpinned in the replacer (prefetch)
+   * @param strategy the ring to load the page into, nullptr to use the whole pool
+   * @return the page, nullptr if every frame is pinned
+   */
+  Page *LoadPage(std::unique_lock<std::mutex> *lock, page_id_t page_id, bool pin,
+                 BufferAccessStrategy *strategy = nullptr);
+
+  /** Body of the prefetch thread, it reads the queued pages one after another. */
+  void PrefetchLoop();
+
+  /** Stop the prefetch thread and drop the queued hints. No-op if it was never started. */
+  void StopPrefetcher();
+
+  /**
+   * Block until no I/O is in flight for page_id, neither a read into its frame nor the write-back of its old frame.
+   * @param lock the held lock on latch_, released while waiting
+   * @param page_id id of the page about to be looked up
+   */
+  void WaitForPage(std::unique_lock<std::mutex> *lock, page_id_t page_id);
+
+  /**
+   * Reserve a victim frame for I/O done outside latch_. Must be called with latch_ held.
+   * @param frame_id the reserved frame
+   * @param old_page_id the page the frame held before, removed from the page table
+   * @param old_write_back true if a write of old_page_id from this frame is still in flight or about to start
+   */
+  void BeginIo(frame_id_t frame_id, page_id_t old_page_id, bool old_write_back);
+
+  /** Finish the I/O started by BeginIo and wake up the waiters of the frame. Must be called with latch_ held. */
+  void EndIo(frame_id_t frame_id, page_id_t old_page_id, bool old_write_back);
+
+  /**
+   * Block until the background writer is done with a frame reserved by BeginIo, its memory may be reused after.
+   * @param lock the held lock on latch_, released while waiting
+   * @param frame_id the reserved frame
+   */
+  void WaitForBackgroundWrite(std::unique_lock<std::mutex> *lock, frame_id_t frame_id);
+
+  /**
+   * Add the frames [pool_size_, pool_size) to the free list, constructing the state of frames the pool never had.
+   * Must be called with latch_ held.
+   */
+  void GrowPool(size_t pool_size);
+
+  /**
+   * Drain the frames [pool_size, pool_size_) from the tail: their pages are written back if dirty and evicted, then
+   * the frames are retired. Waits up to resize_drain_timeout for each pinned page to be unpinned.
+   * Must be called with latch_ held.
+   * @param lock the held lock on latch_, released while waiting and writing
+   * @return false if a page stayed pinned for longer, the pool then keeps the frames up to and including its frame
+   */
+  bool ShrinkPool(std::unique_lock<std::mutex> *lock, size_t pool_size);
+
+  /** Give up a shrink to pool_size, the frames left in [pool_size, pool_size_) rejoin the pool. */
+  void StopShrink(size_t pool_size);
+
+  /** Give the memory of the retired frames [begin, end) back to the system. */
+  void ReleaseFrameMemory(size_t begin, size_t end);
+
+  /** Body of the background writer thread. */
+  void BackgroundWriterLoop();
+
+  /**
+   * One round of the background writer. Must be called with latch_ held, which is released around every write.
+   * @param lock the held lock on latch_
+   * @return the number of pages written
+   */
+  size_t BackgroundWriteRound(std::unique_lock<std::mutex> *lock);
+
+  /**
+   * Find the next unpinned dirty frame the background writer may write, starting at bg_writer_cursor_.
+   * Pages whose LSN is not yet persistent are skipped, writing them would break the WAL rule.
+   * @param[out] frame_id the found frame
+   * @return false if no frame qualifies
+   */
+  bool NextBackgroundWriteFrame(frame_id_t *frame_id);
+  void UpdatePage(Page *page, page_id_t page_id, frame_id_t frame_id);
+
+  /**
+   * Allocate a page id owned by this instance.
+   * The disk manager hands out ids striped by num_instances_ so they mod back to instance_index_, reusing deleted pages.
+   * @param hint a page of the object the page belongs to, INVALID_PAGE_ID if none
+   * @return the id of the allocated page
+   */
+  page_id_t AllocatePage(page_id_t hint);
+
+  /**
+   * Validate that the page_id being used is accessible to this BPI.
+   * @param page_id the page id to validate
+   */
+  void ValidatePageId(page_id_t page_id) const;
+
+  // 这里需要理解：pages就是缓冲区当前存的pool_size个page，可以用frame_id作为下标取出缓冲区的单个page
+  // page_id表示由diskmanager分配得到的page编号，目前是id自增策略，它的大小完全有可能超过pool_size
+  // frame_id表示缓冲区中的每页占的位置，它的范围只能是[0,pool_size)
+  // page_table表示现在放入缓冲区的page_id与对应占的位置frame_id
+
+  /** Pin count of a frame the buffer pool claimed for itself: free, or evicted and being refilled. */
+  static constexpr int FRAME_CLAIMED = -1;
+  /** Set in the guard of a frame that is not part of the pool, its memory may be released. */
+  static constexpr uint32_t FRAME_RETIRED = 1U << 31;
+  /** FrameState::usage_count_ stops counting here, only whether it is above 1 matters. */
+  static constexpr uint32_t MAX_USAGE_COUNT = 2;
+
+  /** Everything the pool keeps per frame besides the Page itself. */
+  struct FrameState {
+    /**
+     * True while the frame is being written back or read in without latch_ held.
+     * Only changed with latch_ held, atomic because latch-free hits check it.
+     */
+    std::atomic<bool> io_in_progress_{false};
+    /** Signalled when the I/O of the frame finishes. */
+    std::condition_variable io_done_;
+    /**
+     * Latch-free pins of the frame in progress, plus FRAME_RETIRED while the frame is not part of the pool.
+     * A latch-free pin announces itself here before it touches the frame, a shrink sets FRAME_RETIRED and waits for
+     * the announced pins to leave before it releases the frame's memory.
+     */
+    std::atomic<uint32_t> guard_{0};
+    /** True while the background writer writes the frame out. The frame stays mapped and may be pinned meanwhile. */
+    bool bg_writing_{false};
+    /**
+     * Accesses of the page since it was brought into the frame, up to MAX_USAGE_COUNT. Accesses through a ring
+     * count only while there is none yet, so a ring may recycle the frame as long as this is at most 1. A page
+     * brought in without a ring starts at MAX_USAGE_COUNT.
+     */
+    std::atomic<uint32_t> usage_count_{0};
+  };
+
+  /** Number of pages in the buffer pool, the frames [0, pool_size_). Only changed with latch_ held. */
+  std::atomic<size_t> pool_size_;
+  /** Frames at or above this are being drained by a shrink and are not handed out any more. */
+  size_t target_pool_size_;
+  /** The most frames the pool can grow to, the address space of pages_ and frame_state_ is reserved for it. */
+  const size_t max_pool_size_;
+  /** How many instances are in the parallel BPM (if present, otherwise just 1 BPI) */
+  const uint32_t num_instances_ = 1;
+  /** Index of this BPI in the parallel BPM (if present, otherwise just 0) */
+  const uint32_t instance_index_ = 0;
+  /** Array of buffer pool pages, 下标为[0,pool_size_). Mapped for max_pool_size_ frames, so frames never move. */
+  Page *pages_;
+  /** Bytes mapped for pages_. */
+  size_t frame_memory_size_;
+  /** Pointer to the disk manager. */
+  DiskManager *disk_manager_ __attribute__((__unused__));
+  /** Pointer to the log manager. */
+  LogManager *log_manager_ __attribute__((__unused__));
+  /** Page table for keeping track of buffer pool pages. Read latch-free, only changed with latch_ held. */
+  PageTable page_table_;
+  /** Replacer to find unpinned pages for replacement. 只在[0,target_pool_size_)中找victim */
+  Replacer *replacer_;
+  /** List of free pages. 最开始，所有页都在free_list中*/
+  std::list<frame_id_t> free_list_;
+  /** Per-frame state, mapped like pages_ and constructed for the frames [0, num_frame_states_). */
+  FrameState *frame_state_;
+  /** Bytes mapped for frame_state_. */
+  size_t frame_state_memory_size_;
+  /** The most frames the pool ever had. The state of a retired frame stays, with FRAME_RETIRED in its guard. */
+  std::atomic<size_t> num_frame_states_;
+  /** Evicted dirty pages whose write-back is still in flight, page_id -> frame_id the data is written from. */
+  std::unordered_map<page_id_t, frame_id_t> write_back_table_;
+  /** The background writer thread, nullptr if it is not running. */
+  std::thread *bg_writer_thread_{nullptr};
+  /** Cleared to ask the background writer to exit. */
+  bool bg_writer_running_{false};
+  /** Wakes the background writer up early, on shutdown or when an eviction had to write a dirty page. */
+  std::condition_variable bg_writer_cv_;
+  /** Frame the background writer continues scanning from, so all frames get their turn. */
+  size_t bg_writer_cursor_{0};
+  /** Fraction of frames the background writer keeps free or clean. */
+  double bg_writer_clean_ratio_{BG_WRITER_CLEAN_RATIO};
+  /** Most pages the background writer writes per wake-up. */
+  size_t bg_writer_max_pages_{BG_WRITER_MAX_PAGES};
+  /** Pages PrefetchPages was asked for and that are not read yet. */
+  std::deque<page_id_t> prefetch_queue_;
+  /** The prefetch thread, started by the first PrefetchPages call. */
+  std::thread *prefetch_thread_{nullptr};
+  /** Cleared to ask the prefetch thread to exit. */
+  bool prefetch_running_{false};
+  /** Signalled when prefetch_queue_ gets new pages or on shutdown. */
+  std::condition_variable prefetch_cv_;
+  /** Serializes Resize calls. */
+  std::mutex resize_latch_;
+  /** This latch serializes changes to page_table_, free_list_, the I/O state and the frame metadata. */
+  std::mutex latch_;
+};
+}  // namespace bustub
@@ -12,8 +12,7 @@
 
 #pragma once
 
-#include <list>
-#include <mutex>  // NOLINT
+#include <atomic>
 #include <vector>
 
 #include "buffer/replacer.h"
@@ -23,6 +22,9 @@ namespace bustub {
 
 /**
  * ClockReplacer implements the clock replacement policy, which approximates the Least Recently Used policy.
+ *
+ * The state of every frame is one atomic byte holding an "in replacer" bit and a reference bit. Pin, Unpin and
+ * Victim only ever touch these bytes and the atomic clock hand, so they neither allocate nor take a mutex.
  */
 class ClockReplacer : public Replacer {
  public:
@@ -45,8 +47,23 @@ class ClockReplacer : public Replacer {
 
   size_t Size() override;
 
+  void SetFrameLimit(size_t num_frames) override;
+
  private:
-  // TODO(student): implement me!
+  /** Set while the frame is unpinned and may be victimized. */
+  static constexpr uint8_t IN_REPLACER = 0x1;
+  /** Set on Unpin, cleared once by the clock hand before the frame can be victimized. */
+  static constexpr uint8_t REFERENCED = 0x2;
+
+  size_t num_pages_;
+  /** One state byte per frame, allocated once at construction. */
+  std::vector<std::atomic<uint8_t>> frames_;
+  /** Frames the clock hand sweeps, the first frame_limit_ of them. */
+  std::atomic<size_t> frame_limit_;
+  /** Monotonic clock hand, the current position is clock_hand_ % frame_limit_. */
+  std::atomic<size_t> clock_hand_{0};
+  /** Number of frames with IN_REPLACER set. */
+  std::atomic<size_t> size_{0};
 };
 
 }  // namespace bustub
@@ -0,0 +1,97 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lru_k_replacer.h
+//
+// Identification: src/include/buffer/lru_k_replacer.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <mutex>  // NOLINT
+#include <vector>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * LRUKReplacer implements the LRU-K replacement policy.
+ *
+ * The replacer remembers the last K access timestamps of every frame. The backward K-distance of a frame is the
+ * difference between the current timestamp and the timestamp of its K-th most recent access. The frame with the
+ * largest backward K-distance is evicted. A frame with fewer than K recorded accesses has an infinite backward
+ * K-distance; ties among those are broken by evicting the one that got its page first.
+ *
+ * Only RecordAccess counts as an access, the pins the buffer pool takes for prefetching, new pages or its own
+ * bookkeeping do not. Correlated references are collapsed into one: an access to a frame that stayed pinned since
+ * its last access, or that was the last frame accessed, only repeats that access. A scan that fetches its page again
+ * for every tuple therefore records one access per page, which never gets a finite K-distance, and such pages are
+ * evicted before pages that were hit repeatedly by point lookups.
+ */
+class LRUKReplacer : public Replacer {
+ public:
+  /**
+   * Create a new LRUKReplacer.
+   * @param num_pages the number of frames to allocate the history of, SetFrameLimit allocates more
+   * @param k the number of historical accesses used to compute the backward K-distance
+   */
+  explicit LRUKReplacer(size_t num_pages, size_t k = LRUK_REPLACER_K);
+
+  /**
+   * Destroys the LRUKReplacer.
+   */
+  ~LRUKReplacer() override;
+
+  bool Victim(frame_id_t *frame_id) override;
+
+  void Pin(frame_id_t frame_id) override;
+
+  void Unpin(frame_id_t frame_id) override;
+
+  size_t Size() override;
+
+  void RecordAccess(frame_id_t frame_id) override;
+
+  void SetFrameLimit(size_t num_frames) override;
+
+ private:
+  struct FrameHistory {
+    /** Number of access timestamps in history_, at most k_. */
+    size_t count_{0};
+    /** Slot of the most recent access in the frame's k_ slots of history_. */
+    size_t last_{0};
+    /** When the frame was first pinned or unpinned with its page, orders the frames with fewer than k_ accesses. */
+    uint64_t first_seen_{0};
+    /** True once first_seen_ is set, until the frame is victimized. */
+    bool tracked_{false};
+    /** True if the frame was unpinned since its last access. */
+    bool unpinned_since_access_{false};
+    /** True if the frame is unpinned and may be victimized. */
+    bool evictable_{false};
+  };
+
+  /** Starts the history of a frame that got a new page. */
+  void Track(frame_id_t frame_id);
+
+  /** @return the timestamp the frame is ordered by, its K-th most recent access or when it was first seen */
+  uint64_t OrderingTimestamp(size_t frame_id) const;
+
+  std::mutex latch_;
+  std::vector<FrameHistory> frames_;
+  /** The last k_ access timestamps of every frame, k_ slots per frame used as a ring. */
+  std::vector<uint64_t> history_;
+  size_t k_;
+  /** Victim only scans the frames [0, frame_limit_). */
+  size_t frame_limit_;
+  size_t curr_size_{0};
+  uint64_t current_timestamp_{0};
+};
+
+}  // namespace bustub
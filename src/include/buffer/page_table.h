@@ -0,0 +1,78 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table.h
+//
+// Identification: src/include/buffer/page_table.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <vector>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * PageTable maps page ids to frame ids for one buffer pool instance.
+ *
+ * It is a fixed-capacity open-addressing hash table with linear probing. Every slot is one atomic 64-bit word
+ * holding the page id and the frame id, so a reader always sees a whole entry and Find takes no latch.
+ * Insert and Remove must be serialized by the caller, the buffer pool only calls them with its latch held.
+ *
+ * Remove shifts the following entries of the probe sequence back instead of leaving tombstones. An entry is copied
+ * to its new slot before its old slot is cleared, so a concurrent Find may miss an entry that is being moved but
+ * never returns a mapping that was not in the table at some point during the call. Callers of the latch-free Find
+ * therefore validate a hit and fall back to a lookup under the latch on a miss.
+ */
+class PageTable {
+ public:
+  /**
+   * Create a new PageTable.
+   * @param max_entries the most mappings the table will hold at once, the buffer pool size
+   */
+  explicit PageTable(size_t max_entries);
+
+  /**
+   * Look up the frame of a page, without taking any latch.
+   * @param page_id the page to look up
+   * @param[out] frame_id the frame of the page
+   * @return true if a mapping for page_id was found
+   */
+  bool Find(page_id_t page_id, frame_id_t *frame_id) const;
+
+  /** Map page_id to frame_id, replacing an existing mapping of page_id. Writers must be serialized. */
+  void Insert(page_id_t page_id, frame_id_t frame_id);
+
+  /** Remove the mapping of page_id if there is one. Writers must be serialized. */
+  void Remove(page_id_t page_id);
+
+  /** @return the number of mappings, only exact while no writer runs */
+  size_t Size() const { return size_.load(std::memory_order_relaxed); }
+
+ private:
+  /** Value of a slot without a mapping. page_id INVALID_PAGE_ID is never inserted. */
+  static constexpr uint64_t EMPTY_SLOT = ~static_cast<uint64_t>(0);
+
+  static uint64_t Pack(page_id_t page_id, frame_id_t frame_id) {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(page_id)) << 32) | static_cast<uint32_t>(frame_id);
+  }
+  static page_id_t SlotPageId(uint64_t slot) { return static_cast<page_id_t>(slot >> 32); }
+  static frame_id_t SlotFrameId(uint64_t slot) { return static_cast<frame_id_t>(slot & 0xffffffff); }
+
+  /** @return the slot the probe sequence of page_id starts at */
+  size_t HomeSlot(page_id_t page_id) const;
+
+  /** Capacity minus one, the capacity is a power of two at least twice max_entries. */
+  size_t mask_;
+  std::vector<std::atomic<uint64_t>> slots_;
+  std::atomic<size_t> size_{0};
+};
+
+}  // namespace bustub
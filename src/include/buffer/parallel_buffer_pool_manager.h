@@ -0,0 +1,109 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_buffer_pool_manager.h
+//
+// Identification: src/include/buffer/parallel_buffer_pool_manager.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <mutex>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
+#include "recovery/log_manager.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/page/page.h"
+
+namespace bustub {
+
+/**
+ * ParallelBufferPoolManager hashes page ids across several independent BufferPoolManagerInstances.
+ * Every instance has its own latch, free list, replacer and page table, so threads working on different
+ * pages mostly contend on different latches instead of one global latch.
+ */
+class ParallelBufferPoolManager : public BufferPoolManager {
+ public:
+  /**
+   * Creates a new ParallelBufferPoolManager.
+   * @param num_instances the number of individual BufferPoolManagerInstances to store
+   * @param pool_size the pool size of each BufferPoolManagerInstance
+   * @param disk_manager the disk manager
+   * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param replacer_type the replacement policy of every instance
+   * @param max_pool_size the most frames Resize may grow each instance to, 0 for pool_size
+   */
+  ParallelBufferPoolManager(size_t num_instances, size_t pool_size, DiskManager *disk_manager,
+                            LogManager *log_manager = nullptr, ReplacerType replacer_type = ReplacerType::LRU,
+                            size_t max_pool_size = 0);
+
+  /**
+   * Destroys an existing ParallelBufferPoolManager.
+   */
+  ~ParallelBufferPoolManager() override;
+
+  /** @return size of the buffer pool, summed over all instances */
+  size_t GetPoolSize() override;
+
+  /** Resize the instances to an even share of pool_size each, at least one frame per instance. */
+  bool Resize(size_t pool_size) override;
+
+  /** Start the background writer of every instance. */
+  void RunBackgroundWriter(double target_clean_ratio = BG_WRITER_CLEAN_RATIO,
+                           size_t max_pages_per_round = BG_WRITER_MAX_PAGES) override;
+
+  /** Stop the background writer of every instance. */
+  void StopBackgroundWriter() override;
+
+  Page *FetchResidentPage(page_id_t page_id) override;
+
+  Page *FetchSwizzledPage(Page *frame, page_id_t page_id) override;
+
+  /** Hand every page to the prefetcher of its instance, the instances read in parallel. */
+  void PrefetchPages(const std::vector<page_id_t> &page_ids) override;
+
+  segment_id_t CreateSegment() override;
+
+  /** Every instance discards the pages of the segment before its file is unlinked. */
+  void DropSegment(segment_id_t segment_id) override;
+
+ protected:
+  /**
+   * @param page_id id of page
+   * @return pointer to the BufferPoolManagerInstance responsible for handling given page id
+   */
+  BufferPoolManagerInstance *GetBufferPoolManager(page_id_t page_id);
+
+  Page *FetchPageImpl(page_id_t page_id, BufferAccessStrategy *strategy) override;
+  bool UnpinPageImpl(page_id_t page_id, bool is_dirty) override;
+  bool FlushPageImpl(page_id_t page_id) override;
+
+  /**
+   * Creates a new page in one of the instances. Instances are tried round robin, starting one further each call,
+   * so that new pages are spread evenly across the instances.
+   * @param[out] page_id id of created page
+   * @return nullptr if no instance could create a new page, otherwise pointer to new page
+   */
+  Page *NewPageImpl(page_id_t *page_id, BufferAccessStrategy *strategy, page_id_t hint) override;
+
+  bool DeletePageImpl(page_id_t page_id) override;
+  void FlushAllPagesImpl() override;
+
+ private:
+  /** Number of instances, page_id % num_instances_ selects the owning instance. */
+  size_t num_instances_;
+  /** The instances themselves. */
+  std::vector<BufferPoolManagerInstance *> instances_;
+  /** Instance NewPageImpl starts probing from. */
+  size_t start_index_{0};
+  /** This latch protects start_index_. */
+  std::mutex latch_;
+};
+
+}  // namespace bustub
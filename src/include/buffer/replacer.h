@@ -16,6 +16,9 @@
 
 namespace bustub {
 
+/** The replacement policies a buffer pool can be constructed with. */
+enum class ReplacerType { LRU, LRU_K, CLOCK };
+
 /**
  * Replacer is an abstract class that tracks page usage.
  */
@@ -43,6 +46,20 @@ class Replacer {
    */
   virtual void Unpin(frame_id_t frame_id) = 0;
 
+  /**
+   * Records that a caller fetched the page held by a frame. Pins the buffer pool takes for itself are no accesses.
+   * Only policies that count accesses need it, the others order frames by Pin and Unpin.
+   * @param frame_id the id of the frame that was accessed
+   */
+  virtual void RecordAccess(frame_id_t frame_id) {}
+
+  /**
+   * Restricts victims to the frames [0, num_frames), as the buffer pool grows or shrinks. Frames at or above it may
+   * still be pinned and unpinned, they are just not handed out. Replacers that scan their frames only scan those.
+   * @param num_frames the number of frames victims are taken from
+   */
+  virtual void SetFrameLimit(size_t num_frames) {}
+
   /** @return the number of elements in the replacer that can be victimized */
   virtual size_t Size() = 0;
 };
@@ -16,6 +16,11 @@
 #include <chrono>  // NOLINT
 #include <cstdint>
 
+/** Page size in bytes, the build sets it with cmake -DBUSTUB_PAGE_SIZE=<bytes>. */
+#ifndef BUSTUB_PAGE_SIZE
+#define BUSTUB_PAGE_SIZE 4096
+#endif
+
 namespace bustub {
 
 /** Cycle detection is performed every CYCLE_DETECTION_INTERVAL milliseconds. */
@@ -27,20 +32,44 @@ extern std::atomic<bool> enable_logging;
 /** If ENABLE_LOGGING is true, the log should be flushed to disk every LOG_TIMEOUT. */
 extern std::chrono::duration<int64_t> log_timeout;
 
+/** The buffer pool background writer wakes up every BG_WRITER_INTERVAL milliseconds. */
+extern std::chrono::milliseconds bg_writer_interval;
+
+/** A buffer pool shrink gives up on a frame that stays pinned for RESIZE_DRAIN_TIMEOUT milliseconds. */
+extern std::chrono::milliseconds resize_drain_timeout;
+
 static constexpr int INVALID_PAGE_ID = -1;                                    // invalid page id
+static constexpr int INVALID_SEGMENT_ID = -1;                                 // invalid segment id
 static constexpr int INVALID_TXN_ID = -1;                                     // invalid transaction id
 static constexpr int INVALID_LSN = -1;                                        // invalid log sequence number
 static constexpr int HEADER_PAGE_ID = 0;                                      // the header page id
-static constexpr int PAGE_SIZE = 4096;                                        // size of a data page in byte
+static constexpr int PAGE_SIZE = BUSTUB_PAGE_SIZE;                            // size of a data page in byte
 static constexpr int BUFFER_POOL_SIZE = 10;                                   // size of buffer pool
+static constexpr int BUFFER_POOL_MAX_SIZE = 1 << 16;  // most frames BustubInstance's buffer pool can be resized to
 static constexpr int LOG_BUFFER_SIZE = ((BUFFER_POOL_SIZE + 1) * PAGE_SIZE);  // size of a log buffer in byte
 static constexpr int BUCKET_SIZE = 50;                                        // size of extendible hash bucket
+static constexpr int LRUK_REPLACER_K = 2;  // lookback window for lru-k replacer
+static constexpr double BG_WRITER_CLEAN_RATIO = 0.25;  // fraction of frames the background writer keeps clean
+static constexpr int BG_WRITER_MAX_PAGES = 32;         // max pages the background writer writes per wake-up
+static constexpr int TABLE_READ_AHEAD_PAGES = 8;       // pages a table scan keeps in flight ahead of itself
+static constexpr int BULK_RING_SIZE = 16;              // frames a bulk scan or load may occupy
+static constexpr int BULK_POOL_FRACTION = 4;           // a table over 1/4 of the pool is scanned in a ring of <= 1/4 of it
+static constexpr int IO_URING_QUEUE_DEPTH = 64;        // submission queue entries of an io_uring disk manager
+static constexpr int DIRECT_IO_ALIGNMENT = 512;        // frame alignment for O_DIRECT, others are bounced
+static constexpr size_t EXTENT_SIZE = 1 << 20;         // bytes the db file grows by, handed out per table or index
+static constexpr int SEGMENT_PAGE_BITS = 20;           // low bits of a page id: page number within its segment file
+static constexpr int MAX_SEGMENTS = 1 << (31 - SEGMENT_PAGE_BITS);  // segment files of a database, the db file included
 
 using frame_id_t = int32_t;    // frame id type
 using page_id_t = int32_t;     // page id type
+using segment_id_t = int32_t;  // segment id type
 using txn_id_t = int32_t;      // transaction id type
 using lsn_t = int32_t;         // log sequence number type
 using slot_offset_t = size_t;  // slot offset type
 using oid_t = uint16_t;
 
+// O_DIRECT needs pages of whole logical blocks, 4-64 KiB is the range the tests are run with.
+static_assert(PAGE_SIZE >= 4096 && PAGE_SIZE <= 65536 && (PAGE_SIZE & (PAGE_SIZE - 1)) == 0,
+              "PAGE_SIZE must be a power of two from 4096 to 65536");
+
 }  // namespace bustub
@@ -17,6 +17,15 @@
 
 namespace bustub {
 
+// Defined in ThreadSanitizer builds. TSAN does not model standalone fences, and GCC rejects them there under -Werror.
+#if defined(__SANITIZE_THREAD__)
+#define BUSTUB_THREAD_SANITIZER
+#elif defined(__has_feature)
+#if __has_feature(thread_sanitizer)
+#define BUSTUB_THREAD_SANITIZER
+#endif
+#endif
+
 #define BUSTUB_ASSERT(expr, message) assert((expr) && (message))
 
 #define UNREACHABLE(message) throw std::logic_error(message)
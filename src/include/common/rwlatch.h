@@ -12,25 +12,34 @@
 
 #pragma once
 
-#include <climits>
+#include <atomic>
 #include <condition_variable>  // NOLINT
-#include <mutex>               // NOLINT
+#include <cstdint>
+#include <mutex>  // NOLINT
 
 #include "common/macros.h"
 
 namespace bustub {
 
 /**
- * Reader-Writer latch backed by std::mutex.
+ * Reader-Writer latch built on a single atomic word.
+ *
+ * The word holds a writer bit and the reader count, so an uncontended RLock/RUnlock or WLock/WUnlock is one
+ * compare-and-swap each and never touches a mutex. A thread that cannot get the latch spins for a short while,
+ * critical sections on pages are usually only a few hundred instructions long, and then parks on a condition
+ * variable until the holder wakes it.
+ *
+ * The latch is writer-preferring: once a writer waits, new readers are held back until it got the latch.
  */
 class ReaderWriterLatch {
-  using mutex_t = std::mutex;
-  using cond_t = std::condition_variable;
-  static const uint32_t MAX_READERS = UINT_MAX;
+  static constexpr uint32_t WRITER = 1U << 31;
+  static constexpr uint32_t MAX_READERS = WRITER - 1;
+  /** Number of failed attempts before a thread parks. */
+  static constexpr int SPIN_COUNT = 64;
 
  public:
   ReaderWriterLatch() = default;
-  ~ReaderWriterLatch() { std::lock_guard<mutex_t> guard(mutex_); }
+  ~ReaderWriterLatch() = default;
 
   DISALLOW_COPY(ReaderWriterLatch);
 
@@ -38,59 +47,89 @@ class ReaderWriterLatch {
    * Acquire a write latch.
    */
   void WLock() {
-    std::unique_lock<mutex_t> latch(mutex_);
-    while (writer_entered_) {
-      reader_.wait(latch);
-    }
-    writer_entered_ = true;
-    while (reader_count_ > 0) {
-      writer_.wait(latch);
+    if (TryWLock()) {
+      return;
     }
+    writers_waiting_.fetch_add(1);
+    Acquire([this] { return TryWLock(); });
+    writers_waiting_.fetch_sub(1);
   }
 
   /**
    * Release a write latch.
    */
   void WUnlock() {
-    std::lock_guard<mutex_t> guard(mutex_);
-    writer_entered_ = false;
-    reader_.notify_all();
+    state_.fetch_and(~WRITER);
+    WakeParked();
   }
 
   /**
    * Acquire a read latch.
    */
-  void RLock() {
-    std::unique_lock<mutex_t> latch(mutex_);
-    while (writer_entered_ || reader_count_ == MAX_READERS) {
-      reader_.wait(latch);
-    }
-    reader_count_++;
-  }
+  void RLock() { Acquire([this] { return TryRLock(); }); }
 
   /**
    * Release a read latch.
    */
   void RUnlock() {
-    std::lock_guard<mutex_t> guard(mutex_);
-    reader_count_--;
-    if (writer_entered_) {
-      if (reader_count_ == 0) {
-        writer_.notify_one();
-      }
-    } else {
-      if (reader_count_ == MAX_READERS - 1) {
-        reader_.notify_one();
-      }
+    // the last reader leaving hands the latch to a waiting writer, a full latch lets a reader in again
+    uint32_t readers = state_.fetch_sub(1);
+    if (readers == 1 || readers == MAX_READERS) {
+      WakeParked();
     }
   }
 
  private:
-  mutex_t mutex_;
-  cond_t writer_;
-  cond_t reader_;
-  uint32_t reader_count_{0};
-  bool writer_entered_{false};
+  bool TryWLock() {
+    uint32_t expected = 0;
+    return state_.compare_exchange_strong(expected, WRITER);
+  }
+
+  bool TryRLock() {
+    uint32_t state = state_.load();
+    if ((state & WRITER) != 0 || state == MAX_READERS || writers_waiting_.load() > 0) {
+      return false;
+    }
+    return state_.compare_exchange_strong(state, state + 1);
+  }
+
+  /** Spin on try_acquire for a while, then park until it succeeds. */
+  template <typename TryAcquire>
+  void Acquire(TryAcquire try_acquire) {
+    for (int i = 0; i < SPIN_COUNT; i++) {
+      if (try_acquire()) {
+        return;
+      }
+      CpuRelax();
+    }
+    std::unique_lock<std::mutex> lock(park_mutex_);
+    // parked_ is raised before the last attempt, so a release either is seen by that attempt or sees parked_ > 0
+    parked_.fetch_add(1);
+    park_cv_.wait(lock, try_acquire);
+    parked_.fetch_sub(1);
+  }
+
+  void WakeParked() {
+    if (parked_.load() > 0) {
+      std::lock_guard<std::mutex> guard(park_mutex_);
+      park_cv_.notify_all();
+    }
+  }
+
+  static void CpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+  }
+
+  /** Writer bit and reader count. */
+  std::atomic<uint32_t> state_{0};
+  /** Writers spinning or parked in WLock, new readers back off while it is non-zero. */
+  std::atomic<uint32_t> writers_waiting_{0};
+  /** Threads parked on park_cv_, releases only take park_mutex_ if it is non-zero. */
+  std::atomic<uint32_t> parked_{0};
+  std::mutex park_mutex_;
+  std::condition_variable park_cv_;
 };
 
 }  // namespace bustub
@@ -13,47 +13,80 @@
 #pragma once
 
 #include <atomic>
+#include <cstdint>
 #include <fstream>
 #include <future>  // NOLINT
+#include <mutex>   // NOLINT
 #include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "common/config.h"
+#include "common/macros.h"
 
 namespace bustub {
 
 /**
  * DiskManager takes care of the allocation and deallocation of pages within a database. It performs the reading and
  * writing of pages to and from disk, providing a logical file layer within the context of a database management system.
+ *
+ * The database is a set of segment files. Segment 0 is the db file itself, every other segment holds the pages of one
+ * table or index (foo.db -> foo.1.db, foo.2.db, ...), so that the object can be dropped by unlinking its file. A page
+ * id is the segment id in its high bits and the page number within the segment file in its low SEGMENT_PAGE_BITS,
+ * the pages of segment 0 therefore keep the ids of a single-file database.
+ *
+ * Allocated pages are tracked in a free-space map per segment: one bit per page, kept in memory and stored as bitmap
+ * pages in a companion file (foo.db -> foo.fsm, foo.1.db -> foo.1.fsm). Deallocated pages are handed out again, so a
+ * file only grows when every page below its end is in use. The maps are written back at SyncPages, after the data
+ * pages, and when a segment is closed. An allocation also writes its bitmap page right away, so the map left behind by
+ * a process crash may still count deallocated pages as in use but never hands out a page that was written. Pages of
+ * the file the saved map does not cover, all of them if the map is gone, are taken as in use when the segment is
+ * opened.
+ *
+ * Files grow by whole extents preallocated with fallocate. An allocation with a hint claims an extent of its own
+ * for the object the hint belongs to, so the pages of a table heap chain or a B+ tree stay contiguous on disk; pages
+ * allocated without a hint share the extents no object owns. Extent ownership is not persisted, after a restart the
+ * free pages of every extent are shared until an object claims a wholly free one.
  */
 class DiskManager {
  public:
   /**
    * Creates a new disk manager that writes to the specified database file.
    * @param db_file the file name of the database file to write to
+   * @param direct_io open the database file with O_DIRECT, bypassing the OS page cache. Page buffers that are not
+   * aligned as the files need (GetDirectIoAlignment) are bounced through an aligned copy
+   * @param extent_size bytes the file grows by, rounded up to a multiple of 64 pages
    */
-  explicit DiskManager(const std::string &db_file);
+  explicit DiskManager(const std::string &db_file, bool direct_io = false, size_t extent_size = EXTENT_SIZE);
 
-  ~DiskManager() = default;
+  virtual ~DiskManager();
 
   /**
-   * Shut down the disk manager and close all the file resources.
+   * Shut down the disk manager, sync the database file and close all the file resources.
    */
   void ShutDown();
 
   /**
-   * Write a page to the database file.
+   * Write a page to the database file. Thread-safe, writes of different pages run in parallel.
+   * The page reaches the OS when this returns, it is only durable after the next SyncPages.
    * @param page_id id of the page
    * @param page_data raw page data
    */
   void WritePage(page_id_t page_id, const char *page_data);
 
   /**
-   * Read a page from the database file.
+   * Read a page from the database file. Thread-safe, reads run in parallel with each other and with writes.
    * @param page_id id of the page
    * @param[out] page_data output buffer
    */
   void ReadPage(page_id_t page_id, char *page_data);
 
+  /**
+   * Force every page written so far to stable storage.
+   */
+  void SyncPages();
+
   /**
    * Flush the entire log buffer into disk.
    * @param log_data raw log data
@@ -71,17 +104,63 @@ class DiskManager {
   bool ReadLog(char *log_data, int size, int offset);
 
   /**
-   * Allocate a page on disk.
+   * Allocate a page on disk, reusing a deallocated page if there is one.
+   * @param hint a page of the object the new page belongs to. The page is taken from the segment of the hint, from
+   * the extent of the hint if the object owns it and it has room, otherwise from a new extent the object then owns.
+   * INVALID_PAGE_ID takes the lowest free page of segment 0 outside the owned extents
+   * @return the id of the allocated page
+   */
+  page_id_t AllocatePage(page_id_t hint = INVALID_PAGE_ID);
+
+  /**
+   * Allocate a page whose id is residue modulo stride, for a buffer pool instance that owns only those ids.
+   * @param stride number of residue classes the page ids are striped across
+   * @param residue the residue class to allocate from, in [0, stride)
+   * @param hint as for AllocatePage
    * @return the id of the allocated page
    */
-  page_id_t AllocatePage();
+  page_id_t AllocatePage(uint32_t stride, uint32_t residue, page_id_t hint = INVALID_PAGE_ID);
 
   /**
-   * Deallocate a page on disk.
+   * Deallocate a page on disk, a later AllocatePage may return it again.
    * @param page_id id of the page to deallocate
    */
   void DeallocatePage(page_id_t page_id);
 
+  /** @return true if page_id is allocated */
+  bool IsAllocated(page_id_t page_id);
+
+  /**
+   * Create a segment file for a new table or index. Allocate its first page with MakePageId(segment_id, 0) as hint.
+   * @return the id of the new segment
+   */
+  segment_id_t CreateSegment();
+
+  /**
+   * Drop a segment with all its pages by unlinking its file. Reads and writes of its pages that already started are
+   * waited for, later ones find no segment: reads return zeros and writes are lost.
+   * @param segment_id id of the segment to drop, not 0
+   */
+  void DropSegment(segment_id_t segment_id);
+
+  /**
+   * Remove the files of a database that is not open: the db file, its log and free-space map, and the files of all
+   * its segments.
+   * @param db_file the db file name the database was opened with
+   */
+  static void RemoveFiles(const std::string &db_file);
+
+  /** @return the segment page_id lies in */
+  static segment_id_t SegmentOf(page_id_t page_id) { return page_id >> SEGMENT_PAGE_BITS; }
+
+  /** @return the page number of page_id within its segment file */
+  static page_id_t PageNumberOf(page_id_t page_id) { return page_id & ((1 << SEGMENT_PAGE_BITS) - 1); }
+
+  /** @return the id of page page_number of segment segment_id */
+  static page_id_t MakePageId(segment_id_t segment_id, page_id_t page_number) {
+    return (segment_id << SEGMENT_PAGE_BITS) | page_number;
+  }
+
   /** @return the number of disk flushes */
   int GetNumFlushes() const;
 
@@ -91,6 +170,21 @@ class DiskManager {
   /** @return the number of disk writes */
   int GetNumWrites() const;
 
+  /** @return the number of page reads */
+  int GetNumReads() const;
+
+  /**
+   * @return true if the file of segment_id bypasses the OS page cache. A segment on a file system without O_DIRECT
+   * support falls back to buffered I/O on its own.
+   */
+  bool IsDirectIo(segment_id_t segment_id = 0);
+
+  /**
+   * @return the buffer alignment direct I/O on the file of segment_id needs, as the kernel reports it, 1 for buffered
+   * I/O. Buffer pool frames are DIRECT_IO_ALIGNMENT aligned, which covers devices with 512-byte logical blocks.
+   */
+  size_t GetDirectIoAlignment(segment_id_t segment_id = 0);
+
   /**
    * Sets the future which is used to check for non-blocking flushes.
    * @param f the non-blocking flush check
@@ -100,17 +194,116 @@ class DiskManager {
   /** Checks if the non-blocking flush future was set. */
   inline bool HasFlushLogFuture() { return flush_log_f_ != nullptr; }
 
+ protected:
+  /** One file of the database. */
+  struct Segment {
+    segment_id_t id_{0};
+    std::string name_;
+    // pread/pwrite carry their own offset so no latch is needed around page I/O
+    int fd_{-1};
+    // true if fd_ was opened with O_DIRECT, page buffers are then aligned to direct_io_alignment_ or bounced
+    bool direct_io_{false};
+    size_t direct_io_alignment_{1};
+    // logical size of the file in bytes, kept in memory so that reads do not have to stat the file
+    std::atomic<int64_t> file_size_{0};
+    // free-space map file, one bit per page of the segment, set if the page is allocated
+    std::string fsm_name_;
+    int fsm_fd_{-1};
+    std::vector<uint64_t> free_space_map_;
+    // bitmap pages of free_space_map_ changed since they were last written
+    std::vector<bool> fsm_dirty_pages_;
+    // per (stride, residue) class allocated from without a hint: every page of the class below the cursor is
+    // allocated or lies in an owned extent
+    std::unordered_map<uint64_t, page_id_t> fsm_cursors_;
+    // extents claimed by hinted allocations, an extent is released when its last page is deallocated
+    std::vector<bool> owned_extents_;
+  };
+
+  /**
+   * @return the open segment, opening its file on first use, nullptr if it does not exist.
+   * A segment returned stays open until it is given back with ReleaseSegment, DropSegment waits for that.
+   */
+  Segment *AcquireSegment(segment_id_t segment_id);
+  /** Give back a segment returned by AcquireSegment, nullptr is ignored. */
+  void ReleaseSegment(Segment *segment);
+
+  /** Holds a segment from AcquireSegment for a scope. */
+  class SegmentGuard {
+   public:
+    SegmentGuard(DiskManager *disk_manager, segment_id_t segment_id)
+        : disk_manager_(disk_manager), segment_(disk_manager->AcquireSegment(segment_id)) {}
+    ~SegmentGuard() { disk_manager_->ReleaseSegment(segment_); }
+    DISALLOW_COPY_AND_MOVE(SegmentGuard);
+    Segment *Get() const { return segment_; }
+
+   private:
+    DiskManager *disk_manager_;
+    Segment *segment_;
+  };
+
+  /** Grow the logical size of segment to at least size bytes. */
+  void ExtendFileSize(Segment *segment, int64_t size);
+  // true if the segment files are opened with O_DIRECT where their file system supports it
+  const bool direct_io_;
+  std::atomic<int> num_writes_;
+  std::atomic<int> num_reads_{0};
+
  private:
   int GetFileSize(const std::string &file_name);
+  /** Open the files of segment_id, creating them if create is set. Must be called with segments_latch_ held. */
+  Segment *OpenSegment(segment_id_t segment_id, bool create);
+  /** Close the files of segment and free it. */
+  void CloseSegment(Segment *segment);
+  /**
+   * Take segment_id out of use and close it once nobody holds it, saving its free-space map unless the files are
+   * about to be removed. Must be called with segments_latch_ held.
+   */
+  void RetireSegment(segment_id_t segment_id, bool save_map = true);
+  /** @return the file names of segment_id, data file first and free-space map second */
+  std::pair<std::string, std::string> SegmentFileNames(segment_id_t segment_id) const;
+  /**
+   * Find the segment files of the database, so that new segments get new ids. Files next to a new db file are left
+   * over from a removed database: they are left alone and only their ids are skipped.
+   */
+  void ScanSegments(bool orphaned);
+  /** Read the free-space map of segment, or start an empty one for a new segment file. Pages it misses are in use. */
+  void LoadFreeSpaceMap(Segment *segment);
+  /** Write the bitmap pages changed since the last call. Must be called with fsm_latch_ held. */
+  void WriteFreeSpaceMap(Segment *segment);
+  /** Write one bitmap page without syncing it, @return false on an I/O error. Must be called with fsm_latch_ held. */
+  bool WriteFreeSpaceMapPage(Segment *segment, size_t page);
+  /** Set or clear the bit of a page number, growing the map as needed. Must be called with fsm_latch_ held. */
+  void SetAllocated(Segment *segment, page_id_t page_number, bool allocated);
+  /** @return true if the bit of a page number is set. Must be called with fsm_latch_ held. */
+  bool TestAllocated(const Segment *segment, page_id_t page_number) const;
+  /** @return true if a page number lies in an extent owned by an object. Must be called with fsm_latch_ held. */
+  bool IsOwnedExtent(const Segment *segment, page_id_t page_number) const;
+  /** @return true if no page of the extent is allocated. Must be called with fsm_latch_ held. */
+  bool IsFreeExtent(const Segment *segment, size_t extent) const;
+  /** Grow the segment file to the end of the extent holding a page number. Must be called with fsm_latch_ held. */
+  void Preallocate(Segment *segment, page_id_t page_number);
   // stream to write log file
   std::fstream log_io_;
   std::string log_name_;
-  // stream to write db file
-  std::fstream db_io_;
   std::string file_name_;
-  std::atomic<page_id_t> next_page_id_;
+  // file name of the db file up to its extension, and the extension
+  std::string base_name_;
+  std::string extension_;
+  // open segments by id, looked up without a latch
+  std::vector<std::atomic<Segment *>> segments_;
+  // holders of each segment, counted before segments_ is read so that a retired segment is not freed under them
+  std::vector<std::atomic<uint32_t>> segment_users_;
+  // next id CreateSegment tries
+  segment_id_t next_segment_id_{1};
+  // protects opening, creating and dropping segments
+  std::mutex segments_latch_;
+  // pages per extent, a multiple of 64 so extents cover whole words of the map
+  page_id_t extent_pages_{0};
+  // cleared once fallocate fails, files then grow page by page as they are written
+  bool fallocate_supported_{true};
+  // protects the free-space maps and the extents, taken after segments_latch_
+  std::mutex fsm_latch_;
   int num_flushes_;
-  int num_writes_;
   bool flush_log_;
   std::future<void> *flush_log_f_;
 };
@@ -0,0 +1,164 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// io_uring_disk_manager.h
+//
+// Identification: src/include/storage/disk/io_uring_disk_manager.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>  // NOLINT
+#include <string>
+#include <vector>
+
+#include "common/config.h"
+#include "storage/disk/disk_manager.h"
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+namespace bustub {
+
+/** A finished asynchronous page I/O. */
+struct IoCompletion {
+  /** The tag the request was prepared with. */
+  uint64_t tag_;
+  /** PAGE_SIZE on success, a negative errno on failure. */
+  int result_;
+};
+
+/**
+ * IoUringDiskManager is a DiskManager that can also keep many page reads and writes in flight from one thread,
+ * using a Linux io_uring. It talks to the kernel through the raw io_uring syscalls, there is no liburing dependency.
+ *
+ * Requests are queued with PrepareRead/PrepareWrite, handed to the kernel in one batch by Submit, and reaped with
+ * PollCompletions. Buffers registered with RegisterBuffers, e.g. the frames of a buffer pool, are addressed by
+ * their index and skip the per-I/O page pinning of the kernel.
+ *
+ * The synchronous ReadPage/WritePage inherited from DiskManager keep working unchanged for all current callers,
+ * they use pread/pwrite and can run in parallel with the ring. The ring itself is serialized by a latch, it is
+ * meant to be driven by one thread per IoUringDiskManager.
+ */
+class IoUringDiskManager : public DiskManager {
+ public:
+  /**
+   * Creates a new io_uring disk manager that writes to the specified database file.
+   * @param db_file the file name of the database file to write to
+   * @param queue_depth the most requests that can be in flight at once
+   * @param direct_io open the database files with O_DIRECT, asynchronous requests then need buffers aligned to
+   * GetDirectIoAlignment() of the segment they go to
+   * @throws Exception if the kernel does not support io_uring
+   */
+  explicit IoUringDiskManager(const std::string &db_file, uint32_t queue_depth = IO_URING_QUEUE_DEPTH,
+                              bool direct_io = false);
+
+  ~IoUringDiskManager() override;
+
+  /**
+   * Register buffers of PAGE_SIZE bytes with the kernel, buffer i is then addressed as buffer_index i.
+   * Can be called once.
+   * @param buffers the start of every buffer
+   * @return false if the kernel refused the registration, requests then have to pass buffer_index -1
+   */
+  bool RegisterBuffers(const std::vector<char *> &buffers);
+
+  /**
+   * Queue a read of a page, it is not handed to the kernel before Submit.
+   * A read past the end of the file completes with the missing part of the page zeroed.
+   * @param page_id id of the page
+   * @param[out] page_data output buffer, it must stay valid until the completion is reaped
+   * @param tag returned in the completion of the request
+   * @param buffer_index index of page_data in the registered buffers, -1 if it is not registered
+   * @return false if queue_depth requests are in flight already, reap some completions first
+   */
+  bool PrepareRead(page_id_t page_id, char *page_data, uint64_t tag, int buffer_index = -1);
+
+  /**
+   * Queue a write of a page, it is not handed to the kernel before Submit. Like WritePage, it is durable only
+   * after the next SyncPages.
+   * @param page_id id of the page
+   * @param page_data raw page data, it must stay unchanged until the completion is reaped
+   * @param tag returned in the completion of the request
+   * @param buffer_index index of page_data in the registered buffers, -1 if it is not registered
+   * @return false if queue_depth requests are in flight already, reap some completions first
+   */
+  bool PrepareWrite(page_id_t page_id, const char *page_data, uint64_t tag, int buffer_index = -1);
+
+  /**
+   * Hand all prepared requests to the kernel with a single syscall. If the kernel refuses them, they fail with the
+   * negative errno and their completions come with the next PollCompletions.
+   * @return the number of requests submitted
+   */
+  size_t Submit();
+
+  /**
+   * Reap finished requests.
+   * @param[out] completions the finished requests are appended here
+   * @param min_complete block until at least this many requests finished, 0 to only poll
+   * @return the number of completions appended
+   */
+  size_t PollCompletions(std::vector<IoCompletion> *completions, size_t min_complete = 0);
+
+  /** @return the number of requests prepared or submitted whose completion was not reaped yet */
+  size_t InFlight();
+
+ private:
+  struct Request {
+    uint64_t tag_;
+    page_id_t page_id_;
+    char *data_;
+    bool is_read_;
+    // held from AcquireSegment until the request completes, so that a drop waits for it
+    Segment *segment_;
+  };
+
+  /** Fill the next submission queue entry. Must be called with latch_ held. */
+  bool Prepare(uint8_t opcode, page_id_t page_id, char *data, uint64_t tag, int buffer_index);
+
+  /** Submit the prepared requests. Must be called with latch_ held. */
+  size_t SubmitPrepared();
+
+  /** Fail the prepared requests the kernel did not take with result. Must be called with latch_ held. */
+  void FailPrepared(int result);
+
+  /** Turn a completion queue entry into an IoCompletion. Must be called with latch_ held. */
+  IoCompletion Complete(const io_uring_cqe &cqe);
+
+  int ring_fd_{-1};
+  uint32_t queue_depth_;
+  /** The mmapped rings, unmapped in the destructor. */
+  void *sq_ring_{nullptr};
+  size_t sq_ring_size_{0};
+  void *cq_ring_{nullptr};
+  size_t cq_ring_size_{0};
+  io_uring_sqe *sqes_{nullptr};
+  size_t sqes_size_{0};
+  /** Pointers into the submission queue ring. */
+  unsigned *sq_head_;
+  unsigned *sq_tail_;
+  unsigned sq_mask_;
+  unsigned *sq_array_;
+  /** Pointers into the completion queue ring. */
+  unsigned *cq_head_;
+  unsigned *cq_tail_;
+  unsigned cq_mask_;
+  io_uring_cqe *cqes_;
+  /** Requests prepared but not yet submitted. */
+  unsigned to_submit_{0};
+  /** One slot per request that can be in flight, the slot index is the user_data of the kernel request. */
+  std::vector<Request> requests_;
+  std::vector<uint32_t> free_slots_;
+  /** Completions of requests that never reached the kernel, handed out by the next PollCompletions. */
+  std::vector<IoCompletion> failed_;
+  bool buffers_registered_{false};
+  /** Protects the rings and the request slots. */
+  std::mutex latch_;
+};
+
+}  // namespace bustub
@@ -10,6 +10,8 @@
 //===----------------------------------------------------------------------===//
 #pragma once
 
+#include <atomic>
+#include <functional>
 #include <queue>
 #include <string>
 #include <vector>
@@ -37,6 +39,13 @@ enum UsedOp { SEARCH, INSERT, DELETE };
  * // lab add
  * NOTE:leaf插入采取 >= MaxSize()时分裂，删除时<MinSize重新分配或合并
  * internal 插入采取 > MaxSize()时分裂（因为第一个key为空），删除时<MinSize重新分配或合并
+ *
+ * Every node has a high key and a link to its right sibling (Lehman and Yao's B-link tree). By default writers
+ * still latch crab down from root_latch_, and the links only matter to optimistic readers. In B-link mode
+ * (blink = true) no operation holds more than one latch on the way down, and descents skip root_latch_: a descent
+ * that raced a split moves right instead, which also gets it past a root that was replaced after it read the root
+ * id, and a split latches its parent only after the child is done, one level at a time. Deletes leave underfull
+ * nodes behind in that mode, merging would need latches on both siblings and the parent at once.
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTree {
@@ -45,7 +54,8 @@ class BPlusTree {
 
  public:
   explicit BPlusTree(std::string name, BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
-                     int leaf_max_size = LEAF_PAGE_SIZE, int internal_max_size = INTERNAL_PAGE_SIZE);
+                     int leaf_max_size = LEAF_PAGE_SIZE, int internal_max_size = INTERNAL_PAGE_SIZE,
+                     bool blink = false);
 
   // Returns true if this B+ tree has no keys and values.
   bool IsEmpty() const;
@@ -56,6 +66,20 @@ class BPlusTree {
   // Remove a key and its value from this B+ tree.
   void Remove(const KeyType &key, Transaction *transaction = nullptr);
 
+  // Drop the tree with all its pages by unlinking its segment file. No other operation may run meanwhile.
+  void Drop();
+
+  /**
+   * Build the tree bottom up from (key, value) pairs in increasing key order. Leaves are packed to fill_factor of
+   * their capacity and the inner levels are built above them as the leaves fill up, so every page is written once
+   * and no descent or split happens. The tree must be empty and no other operation may run meanwhile.
+   * The last node of each level is balanced with its left sibling, so that it is at least about half full.
+   * @param next produces the next pair, returns false once the input is exhausted
+   * @param fill_factor share of a node's capacity to fill, in (0, 1]
+   * @return false if the tree was not empty or the keys were not strictly increasing, the tree is left empty then
+   */
+  bool BulkLoad(const std::function<bool(KeyType *, ValueType *)> &next, double fill_factor = 1.0);
+
   // return the value associated with a given key
   bool GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *transaction = nullptr);
 
@@ -64,6 +88,9 @@ class BPlusTree {
   INDEXITERATOR_TYPE Begin(const KeyType &key);
   INDEXITERATOR_TYPE end();
 
+  // return the page id of the root, INVALID_PAGE_ID if the tree is empty
+  page_id_t GetRootPageId() const { return root_page_id_; }
+
   void Print(BufferPoolManager *bpm) {
     ToString(reinterpret_cast<BPlusTreePage *>(bpm->FetchPage(root_page_id_)->GetData()), bpm);
   }
@@ -95,8 +122,41 @@ class BPlusTree {
   void InsertIntoParent(BPlusTreePage *old_node, const KeyType &key, BPlusTreePage *new_node, bool *root_locked,
                         Transaction *transaction = nullptr);
 
+  // B-link mode versions of the above
+  bool InsertIntoLeafBLink(const KeyType &key, const ValueType &value);
+
+  /**
+   * Insert the separator of a split into the parent, moving right until the parent that points to old_page, and
+   * split the parent in turn if it overflows.
+   * @param old_page the split node, write latched
+   * @param key the separator, the first key of new_page
+   * @param new_page the new right sibling, write latched
+   * Both pages are unlatched and unpinned once the parent took the separator.
+   */
+  void InsertIntoParentBLink(Page *old_page, const KeyType &key, Page *new_page);
+
+  /**
+   * Bulk load step: make new_page the right sibling of the node open at level and append it to the node open one
+   * level up, starting a new node there (or a new root above) when that one is full.
+   * @param open the pinned rightmost node of every level, leaves first
+   * @param separator the first key under new_page
+   */
+  void BulkAppendSibling(std::vector<Page *> *open, size_t level, const KeyType &separator, Page *new_page,
+                         int internal_fill);
+  void BulkFixRightEdge(std::vector<Page *> *open, size_t level);
+
+  /**
+   * Put a new root above the old one after it split into old_node and new_node. Needs root_latch_ held, or in
+   * B-link mode the old root write latched: only one thread at a time can split it.
+   */
+  void GrowRoot(BPlusTreePage *old_node, const KeyType &key, BPlusTreePage *new_node);
+
+  /**
+   * @param[out] new_page the page of the new node, write latched in B-link mode until the caller linked it into
+   * the parent
+   */
   template <typename N>
-  N *Split(N *node);
+  N *Split(N *node, Page **new_page = nullptr);
 
   template <typename N>
   bool CoalesceOrRedistribute(N *node, bool *root_locked, Transaction *transaction = nullptr);
@@ -119,13 +179,79 @@ class BPlusTree {
 
   template <typename N>
   bool IsSafe(N *node, UsedOp op);
+
+  /**
+   * Optimistic descent. Inner nodes are read without latching and validated through their version, only the leaf
+   * is latched: read latched for UsedOp::SEARCH, write latched for UsedOp::INSERT and UsedOp::DELETE.
+   * A writer only keeps the leaf if it is safe for used_op, a split or merge needs the pessimistic descent.
+   * @param[out] out_page the latched leaf, nullptr if the tree is empty or, for a writer, the leaf is not safe
+   * @return false if a concurrent writer got in the way, nothing is latched or pinned then and the caller retries
+   */
+  bool FindLeafPageOptimistic(Page **out_page, const KeyType &key, FindOp op, UsedOp used_op = UsedOp::SEARCH);
+
+  /**
+   * B-link descent. It holds one latch at a time: inner nodes are read latched and let go before the child is
+   * latched, a node that split meanwhile is left through its right link.
+   * @return the leaf, read latched for UsedOp::SEARCH and write latched otherwise, nullptr if the tree is empty
+   */
+  Page *FindLeafPageBLink(const KeyType &key, FindOp op, UsedOp used_op);
+
+  /**
+   * @return the right sibling to move to if the key (or op) lies past node's high key, INVALID_PAGE_ID if the
+   * descent goes on in node itself
+   */
+  page_id_t MoveRightTo(BPlusTreePage *node, const KeyType &key, FindOp op) const;
+
+  /**
+   * Copy node's right link and high key out of the page, so that an optimistic reader can validate them before it
+   * compares against the high key.
+   * @return the right sibling, INVALID_PAGE_ID if node is the rightmost of its level
+   */
+  page_id_t ReadRightLink(BPlusTreePage *node, KeyType *high_key) const;
+
+  /** MoveRightTo on a right link and high key read by ReadRightLink. */
+  page_id_t MoveRightTo(page_id_t next_pid, const KeyType &high_key, const KeyType &key, FindOp op) const;
+
+  /**
+   * Pin the root through its swizzled reference, swizzling it again if the root moved. Takes no latch, root_id may
+   * be out of date by the time the page is pinned and the caller has to cope with that.
+   * @param root_id a valid root page id read from root_page_id_
+   */
+  Page *FetchRoot(page_id_t root_id);
+
+  /**
+   * Pin child index of an inner node through the parent's swizzled reference, see Page::GetSwips. A reference
+   * whose frame got another page since, or that is still unset, is swizzled from a regular FetchPage.
+   * @param parent_page the pinned parent
+   * @param index index of the child pointer in the parent
+   * @param child_id the child pointer read at index
+   * @return the pinned child
+   */
+  Page *FetchChild(Page *parent_page, int index, page_id_t child_id);
+
+  /** Optimistic descents a search tries before it falls back to latch crabbing. */
+  static constexpr int OPTIMISTIC_SEARCH_ATTEMPTS = 3;
+  /** Optimistic descents an insert or delete tries before it falls back to latch crabbing. */
+  static constexpr int OPTIMISTIC_WRITE_ATTEMPTS = 2;
+  /** Entries the array of an internal page has room for, an optimistic reader never looks past them. */
+  static constexpr size_t INTERNAL_PAGE_CAPACITY =
+      (PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / sizeof(std::pair<KeyType, page_id_t>);
+
   // member variable
   std::string index_name_;
-  page_id_t root_page_id_;
+  // written once the new root page is complete: under root_latch_, or in B-link mode by GrowRoot with only the old
+  // root write latched, see GrowRoot. Descents that skip root_latch_ read it as is.
+  std::atomic<page_id_t> root_page_id_;
+  // frame the root was last found in, a swizzled reference to it that FetchSwizzledPage checks before use
+  std::atomic<Page *> root_frame_{nullptr};
+  // segment file holding the pages of the tree, created with its first root
+  segment_id_t segment_id_{INVALID_SEGMENT_ID};
   BufferPoolManager *buffer_pool_manager_;
   KeyComparator comparator_;
   int leaf_max_size_;
   int internal_max_size_;
+  // B-link mode, see the class comment
+  const bool blink_;
   std::mutex root_latch_;
 };
 
@@ -17,6 +17,7 @@
 
 #include "storage/index/b_plus_tree.h"
 #include "storage/index/index.h"
+#include "storage/table/table_heap.h"
 
 namespace bustub {
 
@@ -33,12 +34,29 @@ class BPlusTreeIndex : public Index {
 
   void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
 
+  /**
+   * Build the index over all tuples of a table with BPlusTree::BulkLoad. The (key, RID) pairs are cut into runs of
+   * run_size entries, which up to num_threads threads sort and spill to temporary files while the table is still
+   * being scanned. The runs are then merged into the bulk load. A duplicate key keeps its first RID, as Insert
+   * would have.
+   * @param tuple_schema schema of the table's tuples
+   * @param fill_factor see BPlusTree::BulkLoad
+   * @param run_size entries sorted in memory at a time
+   * @param num_threads runs sorted at the same time
+   * @return false if the index is not empty
+   */
+  bool BulkBuild(TableHeap *table_heap, const Schema &tuple_schema, Transaction *transaction,
+                 double fill_factor = 1.0, size_t run_size = BULK_BUILD_RUN_SIZE, size_t num_threads = 4);
+
   INDEXITERATOR_TYPE GetBeginIterator();
 
   INDEXITERATOR_TYPE GetBeginIterator(const KeyType &key);
 
   INDEXITERATOR_TYPE GetEndIterator();
 
+  /** Default number of entries sorted in memory per run of BulkBuild. */
+  static constexpr size_t BULK_BUILD_RUN_SIZE = 1 << 16;
+
  protected:
   // comparator for key
   KeyComparator comparator_;
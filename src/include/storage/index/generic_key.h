@@ -14,6 +14,7 @@
 
 #include <cstring>
 
+#include "storage/index/key_normalizer.h"
 #include "storage/table/tuple.h"
 #include "type/value.h"
 
@@ -25,20 +26,27 @@ namespace bustub {
  * This key type uses an fixed length array to hold data for indexing
  * purposes, the actual size of which is specified and instantiated
  * with a template argument.
+ *
+ * Keys whose columns are all inlined are stored encoded by KeyNormalizer, so
+ * that GenericComparator compares them with memcmp.
  */
 template <size_t KeySize>
 class GenericKey {
  public:
-  inline void SetFromKey(const Tuple &tuple) {
+  inline void SetFromKey(const Tuple &tuple, const Schema &key_schema) {
     // intialize to 0
     memset(data_, 0, KeySize);
     memcpy(data_, tuple.GetData(), tuple.GetLength());
+    if (KeyNormalizer::IsNormalized(key_schema, KeySize)) {
+      KeyNormalizer::Encode(key_schema, data_);
+    }
   }
 
   // NOTE: for test purpose only
+  // the key schema has to be a single bigint column
   inline void SetFromInteger(int64_t key) {
     memset(data_, 0, KeySize);
-    memcpy(data_, &key, sizeof(int64_t));
+    KeyNormalizer::EncodeBigInt(key, data_);
   }
 
   inline Value ToValue(Schema *schema, uint32_t column_idx) const {
@@ -46,7 +54,12 @@ class GenericKey {
     const auto &col = schema->GetColumn(column_idx);
     const TypeId column_type = col.GetType();
     const bool is_inlined = col.IsInlined();
-    if (is_inlined) {
+    // 编码过的列先解码回tuple的格式
+    char decoded[sizeof(uint64_t)];
+    if (is_inlined && KeyNormalizer::IsNormalized(*schema, KeySize)) {
+      KeyNormalizer::DecodeColumn(column_type, data_ + col.GetOffset(), decoded);
+      data_ptr = decoded;
+    } else if (is_inlined) {
       data_ptr = (data_ + col.GetOffset());
     } else {
       int32_t offset = *reinterpret_cast<int32_t *>(const_cast<char *>(data_ + col.GetOffset()));
@@ -56,11 +69,11 @@ class GenericKey {
   }
 
   // NOTE: for test purpose only
-  // interpret the first 8 bytes as int64_t from data vector
-  inline int64_t ToString() const { return *reinterpret_cast<int64_t *>(const_cast<char *>(data_)); }
+  // decode the first 8 bytes as a bigint column
+  inline int64_t ToString() const { return KeyNormalizer::DecodeBigInt(data_); }
 
   // NOTE: for test purpose only
-  // interpret the first 8 bytes as int64_t from data vector
+  // decode the first 8 bytes as a bigint column
   friend std::ostream &operator<<(std::ostream &os, const GenericKey &key) {
     os << key.ToString();
     return os;
@@ -77,6 +90,15 @@ template <size_t KeySize>
 class GenericComparator {
  public:
   inline int operator()(const GenericKey<KeySize> &lhs, const GenericKey<KeySize> &rhs) const {
+    if (normalized_length_ == sizeof(uint64_t)) {
+      uint64_t lhs_prefix = KeyNormalizer::LoadPrefix(lhs.data_);
+      uint64_t rhs_prefix = KeyNormalizer::LoadPrefix(rhs.data_);
+      return lhs_prefix < rhs_prefix ? -1 : (lhs_prefix > rhs_prefix ? 1 : 0);
+    }
+    if (normalized_length_ != 0) {
+      return memcmp(lhs.data_, rhs.data_, normalized_length_);
+    }
+
     uint32_t column_count = key_schema_->GetColumnCount();
 
     for (uint32_t i = 0; i < column_count; i++) {
@@ -94,13 +116,21 @@ class GenericComparator {
     return 0;
   }
 
-  GenericComparator(const GenericComparator &other) : key_schema_{other.key_schema_} {}
+  /** @return true if the keys order like the big endian uint64 in their first 8 bytes, see SimdKeySearch */
+  inline bool IsUInt64Ordered() const { return normalized_length_ == sizeof(uint64_t); }
+
+  GenericComparator(const GenericComparator &other)
+      : key_schema_{other.key_schema_}, normalized_length_{other.normalized_length_} {}
 
   // constructor
-  explicit GenericComparator(Schema *key_schema) : key_schema_(key_schema) {}
+  explicit GenericComparator(Schema *key_schema)
+      : key_schema_(key_schema),
+        normalized_length_(KeyNormalizer::IsNormalized(*key_schema, KeySize) ? key_schema->GetLength() : 0) {}
 
  private:
   Schema *key_schema_;
+  // length of the encoded keys, 0 if the keys are compared column by column
+  uint32_t normalized_length_;
 };
 
 }  // namespace bustub
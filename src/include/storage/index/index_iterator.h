@@ -43,6 +43,9 @@ class IndexIterator {
   }
 
  private:
+  // move on to the next leaf while the current one has no entry left at index_
+  void SkipExhaustedPages();
+
   // add your own private member variables here
   Page *page_;
   LeafPage *node_;
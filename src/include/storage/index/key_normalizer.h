@@ -0,0 +1,160 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// key_normalizer.h
+//
+// Identification: src/include/storage/index/key_normalizer.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+#include "catalog/schema.h"
+
+namespace bustub {
+
+/**
+ * 把索引key编码成可以直接memcmp比较的字节串。
+ * Encodes index keys into a byte comparable form: comparing two encoded keys with memcmp orders them like comparing
+ * their columns one by one as Values. Every column keeps its offset and width in the key tuple, integers are stored
+ * big endian with the sign bit flipped and decimals big endian with the sign bit flipped for positive numbers and all
+ * bits flipped for negative ones. NULLs are stored as their sentinel values and sort where those would.
+ *
+ * Only keys made of inlined columns can be encoded, a key with a VARCHAR column keeps the tuple layout.
+ */
+class KeyNormalizer {
+ public:
+  /** @return true if the keys of key_schema are stored encoded in a key of key_size bytes */
+  static bool IsNormalized(const Schema &key_schema, size_t key_size) {
+    return key_schema.IsInlined() && key_schema.GetLength() <= key_size;
+  }
+
+  /** Encode the key tuple data in place. */
+  static void Encode(const Schema &key_schema, char *data) {
+    for (const auto &column : key_schema.GetColumns()) {
+      EncodeColumn(column.GetType(), data + column.GetOffset());
+    }
+  }
+
+  /** Decode one column of an encoded key into tuple layout at dst. */
+  static void DecodeColumn(TypeId type, const char *src, char *dst) {
+    switch (type) {
+      case TypeId::BOOLEAN:
+      case TypeId::TINYINT:
+        Store(dst, static_cast<uint8_t>(LoadBigEndian<uint8_t>(src) ^ SignBit<uint8_t>()));
+        break;
+      case TypeId::SMALLINT:
+        Store(dst, static_cast<uint16_t>(LoadBigEndian<uint16_t>(src) ^ SignBit<uint16_t>()));
+        break;
+      case TypeId::INTEGER:
+        Store(dst, LoadBigEndian<uint32_t>(src) ^ SignBit<uint32_t>());
+        break;
+      case TypeId::BIGINT:
+        Store(dst, LoadBigEndian<uint64_t>(src) ^ SignBit<uint64_t>());
+        break;
+      case TypeId::DECIMAL: {
+        uint64_t bits = LoadBigEndian<uint64_t>(src);
+        Store(dst, (bits & SignBit<uint64_t>()) != 0 ? bits ^ SignBit<uint64_t>() : ~bits);
+        break;
+      }
+      case TypeId::TIMESTAMP:
+        Store(dst, LoadBigEndian<uint64_t>(src));
+        break;
+      default:
+        break;
+    }
+  }
+
+  /** Store value encoded as a BIGINT column at dst. */
+  static void EncodeBigInt(int64_t value, char *dst) {
+    StoreBigEndian(dst, static_cast<uint64_t>(value) ^ SignBit<uint64_t>());
+  }
+
+  /** @return the BIGINT column encoded at src */
+  static int64_t DecodeBigInt(const char *src) {
+    return static_cast<int64_t>(LoadBigEndian<uint64_t>(src) ^ SignBit<uint64_t>());
+  }
+
+  /** @return the 8 bytes at src as a number that orders like the bytes */
+  static uint64_t LoadPrefix(const char *src) { return LoadBigEndian<uint64_t>(src); }
+
+ private:
+  static void EncodeColumn(TypeId type, char *data) {
+    switch (type) {
+      case TypeId::BOOLEAN:
+      case TypeId::TINYINT:
+        StoreBigEndian(data, static_cast<uint8_t>(Load<uint8_t>(data) ^ SignBit<uint8_t>()));
+        break;
+      case TypeId::SMALLINT:
+        StoreBigEndian(data, static_cast<uint16_t>(Load<uint16_t>(data) ^ SignBit<uint16_t>()));
+        break;
+      case TypeId::INTEGER:
+        StoreBigEndian(data, Load<uint32_t>(data) ^ SignBit<uint32_t>());
+        break;
+      case TypeId::BIGINT:
+        StoreBigEndian(data, Load<uint64_t>(data) ^ SignBit<uint64_t>());
+        break;
+      case TypeId::DECIMAL: {
+        uint64_t bits = Load<uint64_t>(data);
+        StoreBigEndian(data, (bits & SignBit<uint64_t>()) != 0 ? ~bits : bits ^ SignBit<uint64_t>());
+        break;
+      }
+      case TypeId::TIMESTAMP:
+        StoreBigEndian(data, Load<uint64_t>(data));
+        break;
+      default:
+        break;
+    }
+  }
+
+  template <typename T>
+  static constexpr T SignBit() {
+    return static_cast<T>(T{1} << (sizeof(T) * 8 - 1));
+  }
+
+  template <typename T>
+  static T Load(const char *src) {
+    T value;
+    memcpy(&value, src, sizeof(T));
+    return value;
+  }
+
+  template <typename T>
+  static void Store(char *dst, T value) {
+    memcpy(dst, &value, sizeof(T));
+  }
+
+  template <typename T>
+  static T LoadBigEndian(const char *src) {
+    if constexpr (sizeof(T) == sizeof(uint64_t)) {
+      return __builtin_bswap64(Load<uint64_t>(src));
+    } else if constexpr (sizeof(T) == sizeof(uint32_t)) {
+      return __builtin_bswap32(Load<uint32_t>(src));
+    } else if constexpr (sizeof(T) == sizeof(uint16_t)) {
+      return __builtin_bswap16(Load<uint16_t>(src));
+    } else {
+      return Load<T>(src);
+    }
+  }
+
+  template <typename T>
+  static void StoreBigEndian(char *dst, T value) {
+    if constexpr (sizeof(T) == sizeof(uint64_t)) {
+      Store(dst, __builtin_bswap64(value));
+    } else if constexpr (sizeof(T) == sizeof(uint32_t)) {
+      Store(dst, __builtin_bswap32(value));
+    } else if constexpr (sizeof(T) == sizeof(uint16_t)) {
+      Store(dst, __builtin_bswap16(value));
+    } else {
+      Store(dst, value);
+    }
+  }
+
+  static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "KeyNormalizer assumes a little endian host");
+};
+
+}  // namespace bustub
@@ -0,0 +1,43 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// simd_key_search.h
+//
+// Identification: src/include/storage/index/simd_key_search.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace bustub {
+
+/**
+ * 在页内的有序key数组上查找，一条指令比较多个key。
+ * Search kernel for sorted keys that order like the big endian uint64 in their first 8 bytes, which is what
+ * KeyNormalizer makes of 8-byte keys. The keys sit stride bytes apart, as in the (key, value) arrays of B+ tree pages.
+ * A binary search narrows the range down to SEARCH_WINDOW keys, which are then compared all at once: four per
+ * instruction with AVX2, two with SSE4.2, one by one otherwise. The instruction set is the one the build targets.
+ */
+class SimdKeySearch {
+ public:
+  /** @return the index of the first of the count keys at base that is not less than key, count if there is none */
+  static int LowerBound(const char *base, size_t stride, int count, uint64_t key);
+
+  /** @return the index of the first of the count keys at base that is greater than key, count if there is none */
+  static int UpperBound(const char *base, size_t stride, int count, uint64_t key);
+
+  /** Number of keys left to the vector compare. */
+  static constexpr int SEARCH_WINDOW = 16;
+
+ private:
+  /** @return the number of keys among the count keys at base that are less than key, or not greater if upper */
+  static int CountBefore(const char *base, size_t stride, int count, uint64_t key, bool upper);
+
+  static int Search(const char *base, size_t stride, int count, uint64_t key, bool upper);
+};
+
+}  // namespace bustub
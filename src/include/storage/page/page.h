@@ -12,14 +12,23 @@
 
 #pragma once
 
+#include <algorithm>
+#include <atomic>
 #include <cstring>
 #include <iostream>
+#include <vector>
 
 #include "common/config.h"
+#include "common/macros.h"
 #include "common/rwlatch.h"
 
 namespace bustub {
 
+class Page;
+
+/** Frames the children of an inner index node were last found in, indexed like the node's child pointers. */
+using SwipArray = std::vector<std::atomic<Page *>>;
+
 /**
  * 页是数据库系统内的基本存储单元。页面为实际数据页面提供了一个保存在主存储器中的包装器。
  * 页面还包含缓冲池管理器使用的簿记信息，例如pin_count、is_dirty、page_id等。
@@ -29,32 +38,81 @@ namespace bustub {
  */
 class Page {
   // There is book-keeping information inside the page that should only be relevant to the buffer pool manager.
-  friend class BufferPoolManager;
+  friend class BufferPoolManagerInstance;
 
  public:
   /** Constructor. Zeros out the page data. */
   Page() { ResetMemory(); }
 
-  /** Default destructor. */
-  ~Page() = default;
+  /** Destructor. Frees the swizzled references. */
+  ~Page() { ResetSwips(); }
 
   /** @return the actual data contained within this page */
   inline char *GetData() { return data_; }
 
   /** @return the page id of this page */
-  inline page_id_t GetPageId() { return page_id_; }
+  inline page_id_t GetPageId() { return page_id_.load(std::memory_order_acquire); }
 
   /** @return the pin count of this page */
-  inline int GetPinCount() { return pin_count_; }
+  inline int GetPinCount() { return std::max(pin_count_.load(), 0); }
 
   /** @return true if the page in memory has been modified from the page on disk, false otherwise */
   inline bool IsDirty() { return is_dirty_; }
 
-  /** Acquire the page write latch. */
-  inline void WLatch() { rwlatch_.WLock(); }
+  /** Acquire the page write latch. The version turns odd while the latch is held. */
+  inline void WLatch() {
+    rwlatch_.WLock();
+#ifdef BUSTUB_THREAD_SANITIZER
+    version_.fetch_add(1, std::memory_order_acq_rel);
+#else
+    version_.fetch_add(1, std::memory_order_relaxed);
+    // An optimistic reader that sees a write made under the latch must also see the version turn odd. The store of
+    // the increment itself may become visible after later stores, only the fence orders it before them.
+    std::atomic_thread_fence(std::memory_order_release);
+#endif
+  }
 
   /** Release the page write latch. */
-  inline void WUnlatch() { rwlatch_.WUnlock(); }
+  inline void WUnlatch() {
+    version_.fetch_add(1, std::memory_order_release);
+    rwlatch_.WUnlock();
+  }
+
+  /**
+   * Start an optimistic read. The reader takes no latch: it remembers the version, reads the page and then calls
+   * ValidateRead. Whatever it read may be torn and must not be trusted before the validation succeeded.
+   * @param[out] version the version to validate against
+   * @return false if the page is write latched right now, the reader should take the read latch instead
+   */
+  inline bool TryOptimisticRead(uint64_t *version) {
+    *version = version_.load(std::memory_order_acquire);
+    return (*version & 1) == 0;
+  }
+
+  /** @return true if no write latch was taken since TryOptimisticRead handed out version */
+  inline bool ValidateRead(uint64_t version) {
+#ifdef BUSTUB_THREAD_SANITIZER
+    return version_.load(std::memory_order_acquire) == version;
+#else
+    // An acquire load only orders what comes after it, the fence keeps the optimistic reads before the check.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return version_.load(std::memory_order_relaxed) == version;
+#endif
+  }
+
+  /**
+   * Turn an optimistic read into a write latch.
+   * @return true if no write latch was taken since TryOptimisticRead handed out version, the write latch is held
+   * then. Otherwise the latch is released again.
+   */
+  inline bool TryUpgradeToWLatch(uint64_t version) {
+    WLatch();
+    if (version_.load(std::memory_order_relaxed) == version + 1) {
+      return true;
+    }
+    WUnlatch();
+    return false;
+  }
 
   /** Acquire the page read latch. */
   inline void RLatch() { rwlatch_.RLock(); }
@@ -68,6 +126,26 @@ class Page {
   /** Sets the page LSN. */
   inline void SetLSN(lsn_t lsn) { memcpy(GetData() + OFFSET_LSN, &lsn, sizeof(lsn_t)); }
 
+  /**
+   * Swizzled child references of the inner index node held in this frame, see BPlusTree::FetchChild. They live
+   * beside the page data, are never written to disk and are dropped when the buffer pool reuses the frame, so the
+   * caller must hold a pin while it uses them.
+   * @param size number of slots, only used by the call that creates them
+   * @return the references, all nullptr when just created
+   */
+  inline SwipArray *GetSwips(size_t size) {
+    SwipArray *swips = swips_.load(std::memory_order_acquire);
+    if (swips != nullptr) {
+      return swips;
+    }
+    auto *created = new SwipArray(size);
+    if (swips_.compare_exchange_strong(swips, created, std::memory_order_acq_rel)) {
+      return created;
+    }
+    delete created;
+    return swips;
+  }
+
  protected:
   static_assert(sizeof(page_id_t) == 4);
   static_assert(sizeof(lsn_t) == 4);
@@ -80,16 +158,29 @@ class Page {
   /** Zeroes out the data that is held within the page. */
   inline void ResetMemory() { memset(data_, OFFSET_PAGE_START, PAGE_SIZE); }  // 将data_的PAGE_SIZE个字节填充为0
 
-  /** The actual data that is stored within a page. */
-  char data_[PAGE_SIZE]{};
-  /** The ID of this page. */
-  page_id_t page_id_ = INVALID_PAGE_ID;
-  /** The pin count of this page. */
-  int pin_count_ = 0;
+  /** Drop the swizzled references, the frame is about to hold another page or none. */
+  inline void ResetSwips() { delete swips_.exchange(nullptr, std::memory_order_acq_rel); }
+
+  /**
+   * The actual data that is stored within a page. It has to stay the first member, callers cast a Page * to the
+   * page type stored in it. The alignment lets O_DIRECT read and write frames in place.
+   */
+  alignas(DIRECT_IO_ALIGNMENT) char data_[PAGE_SIZE]{};
+  /** The ID of this page. Atomic so that a swizzled reference can check it holds before pinning through it. */
+  std::atomic<page_id_t> page_id_{INVALID_PAGE_ID};
+  /**
+   * The pin count of this page. Atomic so that buffer pool hits can pin without the pool latch,
+   * -1 while the buffer pool has claimed the frame for itself (free, or being evicted).
+   */
+  std::atomic<int> pin_count_{0};
   /** True if the page is dirty, i.e. it is different from its corresponding page on disk. */
-  bool is_dirty_ = false;
+  std::atomic<bool> is_dirty_{false};
   /** Page latch. */
   ReaderWriterLatch rwlatch_;
+  /** Bumped by WLatch and WUnlatch, odd while a writer holds the latch. */
+  std::atomic<uint64_t> version_{0};
+  /** Swizzled child references, nullptr until an index descent asks for them. */
+  std::atomic<SwipArray *> swips_{nullptr};
 };
 
 }  // namespace bustub
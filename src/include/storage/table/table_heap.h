@@ -12,6 +12,11 @@
 
 #pragma once
 
+#include <memory>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
 #include "buffer/buffer_pool_manager.h"
 #include "recovery/log_manager.h"
 #include "storage/page/table_page.h"
@@ -55,9 +60,10 @@ class TableHeap {
    * @param tuple tuple to insert
    * @param[out] rid the rid of the inserted tuple
    * @param txn the transaction performing the insert
+   * @param strategy the ring of a bulk load, nullptr to use the whole buffer pool
    * @return true iff the insert is successful
    */
-  bool InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn);
+  bool InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn, BufferAccessStrategy *strategy = nullptr);
 
   /**
    * Mark the tuple as deleted. The actual delete will occur when ApplyDelete is called.
@@ -95,12 +101,25 @@ class TableHeap {
    * @param rid rid of the tuple to read
    * @param tuple output variable for the tuple
    * @param txn transaction performing the read
+   * @param strategy the ring of the bulk scan the read belongs to, nullptr to use the whole buffer pool
    * @return true if the read was successful (i.e. the tuple exists)
    */
-  bool GetTuple(const RID &rid, Tuple *tuple, Transaction *txn);
+  bool GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, BufferAccessStrategy *strategy = nullptr);
 
-  /** @return the begin iterator of this table */
-  TableIterator Begin(Transaction *txn);
+  /**
+   * @param txn the transaction performing the scan
+   * @param strategy the ring of a bulk scan, nullptr to use the whole buffer pool. Must outlive the iterator.
+   * @return the begin iterator of this table
+   */
+  TableIterator Begin(Transaction *txn, BufferAccessStrategy *strategy = nullptr);
+
+  /**
+   * Create the ring a bulk scan or load of this table should go through, of min(BULK_RING_SIZE, pool size / 4) frames.
+   * Only a table larger than a quarter of the buffer pool gets one, a smaller table may as well stay resident. Its size
+   * is the part of the page chain the heap knows, a reopened table is sized by what scans and inserts walked so far.
+   * @return the ring, nullptr to use the whole buffer pool
+   */
+  std::unique_ptr<BufferAccessStrategy> MakeBulkAccessStrategy();
 
   /** @return the end iterator of this table */
   TableIterator End();
@@ -108,11 +127,56 @@ class TableHeap {
   /** @return the id of the first page of this table */
   inline page_id_t GetFirstPageId() const { return first_page_id_; }
 
+  /**
+   * Drop the table with all its pages. A table created by this class lives in a segment file of its own, which is
+   * unlinked at once. None of its pages may be in use, the heap is empty and unusable afterwards.
+   */
+  void Drop();
+
+  /** Set how many pages a scan keeps in flight ahead of itself, 0 disables read-ahead. */
+  inline void SetReadAheadPages(size_t read_ahead_pages) { read_ahead_pages_ = read_ahead_pages; }
+
  private:
+  /** Fetch a page through strategy if there is one. */
+  Page *FetchPage(page_id_t page_id, BufferAccessStrategy *strategy);
+
+  /** Create a page after hint, in the extent of this table, through strategy if there is one. */
+  Page *NewPage(page_id_t *page_id, page_id_t hint, BufferAccessStrategy *strategy);
+
+  /**
+   * Remember that next_page_id follows page_id in the page chain. Inserts and scans call this while walking the chain.
+   * @param page_id a page of this table
+   * @param next_page_id the page after it, INVALID_PAGE_ID if it is the last one
+   */
+  void RecordNextPage(page_id_t page_id, page_id_t next_page_id);
+
+  /**
+   * Collect the pages a scan positioned on page_id should have in flight.
+   * The chain is learned as it is walked. Beyond its known part, a chain that so far ran through consecutive pages is
+   * assumed to go on doing so, which lets a scan of a table opened by its first page id read ahead from the start.
+   * @param page_id the page the scan is on
+   * @param window how many pages after page_id to cover
+   * @param[in,out] read_ahead_end chain position up to which pages were already requested, advanced by the call and
+   * moved back to page_id's successor when the chain turns out not to run on where it was guessed to
+   * @return the pages not requested yet, in chain order
+   */
+  std::vector<page_id_t> ReadAheadPages(page_id_t page_id, size_t window, size_t *read_ahead_end);
+
   BufferPoolManager *buffer_pool_manager_;
   LockManager *lock_manager_;
   LogManager *log_manager_;
   page_id_t first_page_id_{};
+  /**
+   * The known prefix of the page chain, page_directory_[0] is first_page_id_.
+   * Pages are never unlinked from the chain, so an entry never goes stale.
+   */
+  std::vector<page_id_t> page_directory_;
+  /** page id -> index in page_directory_ */
+  std::unordered_map<page_id_t, size_t> page_index_;
+  /** This latch protects page_directory_ and page_index_. */
+  std::mutex page_directory_latch_;
+  /** How many pages a scan keeps in flight ahead of itself. */
+  size_t read_ahead_pages_{TABLE_READ_AHEAD_PAGES};
 };
 
 }  // namespace bustub
@@ -14,6 +14,7 @@
 
 #include <cassert>
 
+#include "buffer/buffer_access_strategy.h"
 #include "common/rid.h"
 #include "concurrency/transaction.h"
 #include "storage/table/tuple.h"
@@ -29,10 +30,14 @@ class TableIterator {
   friend class Cursor;
 
  public:
-  TableIterator(TableHeap *table_heap, RID rid, Transaction *txn);
+  TableIterator(TableHeap *table_heap, RID rid, Transaction *txn, BufferAccessStrategy *strategy = nullptr);
 
   TableIterator(const TableIterator &other)
-      : table_heap_(other.table_heap_), tuple_(new Tuple(*other.tuple_)), txn_(other.txn_) {}
+      : table_heap_(other.table_heap_),
+        tuple_(new Tuple(*other.tuple_)),
+        txn_(other.txn_),
+        strategy_(other.strategy_),
+        read_ahead_end_(other.read_ahead_end_) {}
 
   ~TableIterator() { delete tuple_; }
 
@@ -52,13 +57,26 @@ class TableIterator {
     table_heap_ = other.table_heap_;
     *tuple_ = *other.tuple_;
     txn_ = other.txn_;
+    strategy_ = other.strategy_;
+    read_ahead_end_ = other.read_ahead_end_;
     return *this;
   }
 
  private:
+  /**
+   * Keep the window of heap pages after page_id in flight, called whenever the scan moves to a new page.
+   * @param page_id the page the scan moved to
+   * @param next_page_id the page after it, taught to the heap's page directory
+   */
+  void ReadAhead(page_id_t page_id, page_id_t next_page_id);
+
   TableHeap *table_heap_;
   Tuple *tuple_;
   Transaction *txn_;
+  /** The ring of a bulk scan, nullptr if the scan uses the whole buffer pool. */
+  BufferAccessStrategy *strategy_;
+  /** Position in the heap's page chain up to which pages were handed to the prefetcher. */
+  size_t read_ahead_end_{0};
 };
 
 }  // namespace bustub
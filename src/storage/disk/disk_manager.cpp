@@ -10,33 +10,136 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <dirent.h>
+#include <fcntl.h>
 #include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
 #include <cassert>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
 #include <cstring>
 #include <iostream>
+#include <memory>
 #include <string>
 #include <thread>  // NOLINT
 
 #include "common/exception.h"
 #include "common/logger.h"
+#include "common/macros.h"
 #include "storage/disk/disk_manager.h"
 
 namespace bustub {
 
 static char *buffer_used;
 
+/** Free space map geometry: one bit per page, PAGE_SIZE bytes per bitmap page. */
+static constexpr size_t FSM_BITS_PER_WORD = 64;
+static constexpr size_t FSM_WORDS_PER_PAGE = PAGE_SIZE / sizeof(uint64_t);
+
+/**
+ * O_DIRECT needs aligned buffers, other page buffers are copied through this per-thread one
+ */
+static char *DirectIoBounceBuffer() {
+  thread_local std::unique_ptr<char, decltype(&free)> buffer(static_cast<char *>(aligned_alloc(PAGE_SIZE, PAGE_SIZE)),
+                                                             &free);
+  return buffer.get();
+}
+
+static bool IsDirectIoAligned(const char *data, size_t alignment) {
+  return reinterpret_cast<uintptr_t>(data) % alignment == 0;
+}
+
+/**
+ * @return the buffer alignment O_DIRECT reads and writes of whole pages of fd need, 0 if they are not possible.
+ * Without STATX_DIOALIGN the file system block size is assumed, a multiple of the device's logical block size.
+ */
+static size_t DirectIoAlignment(int fd) {
+  size_t memory_alignment = 0;
+  size_t offset_alignment = 0;
+#ifdef STATX_DIOALIGN
+  struct statx stx;
+  if (statx(fd, "", AT_EMPTY_PATH, STATX_DIOALIGN, &stx) == 0 && (stx.stx_mask & STATX_DIOALIGN) != 0) {
+    if (stx.stx_dio_offset_align == 0) {
+      return 0;
+    }
+    memory_alignment = stx.stx_dio_mem_align;
+    offset_alignment = stx.stx_dio_offset_align;
+  }
+#endif
+  if (memory_alignment == 0) {
+    struct stat stat_buf;
+    if (fstat(fd, &stat_buf) != 0) {
+      return 0;
+    }
+    memory_alignment = offset_alignment = stat_buf.st_blksize;
+  }
+  // the bounce buffer is page aligned
+  if (offset_alignment > PAGE_SIZE || PAGE_SIZE % offset_alignment != 0 || memory_alignment > PAGE_SIZE) {
+    return 0;
+  }
+  return memory_alignment;
+}
+
 /**
- * Constructor: open/create a single database file & log file
+ * @return the ids of the segment files <base_name>.<segment id><extension> next to the db file, in directory order
+ */
+static std::vector<segment_id_t> FindSegmentFiles(const std::string &base_name, const std::string &extension) {
+  std::string::size_type slash = base_name.rfind('/');
+  std::string dir = slash == std::string::npos ? "." : base_name.substr(0, slash + 1);
+  std::string prefix = (slash == std::string::npos ? base_name : base_name.substr(slash + 1)) + ".";
+  std::vector<segment_id_t> found;
+  DIR *dirp = opendir(dir.c_str());
+  if (dirp == nullptr) {
+    return found;
+  }
+  while (dirent *entry = readdir(dirp)) {
+    // <base>.<segment id><extension>
+    std::string name = entry->d_name;
+    if (name.size() <= prefix.size() + extension.size() || name.compare(0, prefix.size(), prefix) != 0 ||
+        name.compare(name.size() - extension.size(), extension.size(), extension) != 0) {
+      continue;
+    }
+    std::string digits = name.substr(prefix.size(), name.size() - prefix.size() - extension.size());
+    if (digits.size() > 4 || digits.find_first_not_of("0123456789") != std::string::npos) {
+      continue;
+    }
+    segment_id_t segment_id = std::stoi(digits);
+    if (segment_id > 0 && segment_id < MAX_SEGMENTS) {
+      found.push_back(segment_id);
+    }
+  }
+  closedir(dirp);
+  return found;
+}
+
+/**
+ * Constructor: open/create the database file & log file
  * @input db_file: database file name
  */
-DiskManager::DiskManager(const std::string &db_file)
-    : file_name_(db_file), next_page_id_(0), num_flushes_(0), num_writes_(0), flush_log_(false), flush_log_f_(nullptr) {
+DiskManager::DiskManager(const std::string &db_file, bool direct_io, size_t extent_size)
+    : direct_io_(direct_io),
+      num_writes_(0),
+      file_name_(db_file),
+      num_flushes_(0),
+      flush_log_(false),
+      flush_log_f_(nullptr) {
+  size_t extent_words = std::max<size_t>((extent_size + PAGE_SIZE * FSM_BITS_PER_WORD - 1) /
+                                             (PAGE_SIZE * FSM_BITS_PER_WORD),
+                                         1);
+  extent_pages_ = static_cast<page_id_t>(extent_words * FSM_BITS_PER_WORD);
+  segments_ = std::vector<std::atomic<Segment *>>(MAX_SEGMENTS);
+  segment_users_ = std::vector<std::atomic<uint32_t>>(MAX_SEGMENTS);
+
   std::string::size_type n = file_name_.rfind('.');
   if (n == std::string::npos) {
     LOG_DEBUG("wrong file format");
     return;
   }
-  log_name_ = file_name_.substr(0, n) + ".log";
+  base_name_ = file_name_.substr(0, n);
+  extension_ = file_name_.substr(n);
+  log_name_ = base_name_ + ".log";
 
   log_io_.open(log_name_, std::ios::binary | std::ios::in | std::ios::app | std::ios::out);
   // directory or file does not exist
@@ -52,27 +155,35 @@ DiskManager::DiskManager(const std::string &db_file)
     }
   }
 
-  db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
-  // directory or file does not exist
-  if (!db_io_.is_open()) {
-    db_io_.clear();
-    // create a new file
-    db_io_.open(db_file, std::ios::binary | std::ios::trunc | std::ios::out);
-    db_io_.close();
-    // reopen with original mode
-    db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
-    if (!db_io_.is_open()) {
-      throw Exception("can't open db file");
-    }
+  // create the file if it does not exist
+  std::scoped_lock lock(segments_latch_);
+  Segment *segment = OpenSegment(0, true);
+  if (segment == nullptr) {
+    throw Exception("can't open db file");
   }
+  // the segments of a new db file are left over from a removed database
+  ScanSegments(segment->file_size_ == 0);
   buffer_used = nullptr;
 }
 
+DiskManager::~DiskManager() {
+  std::scoped_lock lock(segments_latch_);
+  for (segment_id_t segment_id = 0; segment_id < MAX_SEGMENTS; segment_id++) {
+    RetireSegment(segment_id);
+  }
+}
+
 /**
  * Close all file streams
  */
 void DiskManager::ShutDown() {
-  db_io_.close();
+  SyncPages();
+  {
+    std::scoped_lock lock(segments_latch_);
+    for (segment_id_t segment_id = 0; segment_id < MAX_SEGMENTS; segment_id++) {
+      RetireSegment(segment_id);
+    }
+  }
   log_io_.close();
 }
 
@@ -80,44 +191,103 @@ void DiskManager::ShutDown() {
  * Write the contents of the specified page into disk file
  */
 void DiskManager::WritePage(page_id_t page_id, const char *page_data) {
-  size_t offset = static_cast<size_t>(page_id) * PAGE_SIZE;
-  // set write cursor to offset
-  num_writes_ += 1;
-  db_io_.seekp(offset);
-  db_io_.write(page_data, PAGE_SIZE);
-  // check for I/O error
-  if (db_io_.bad()) {
-    LOG_DEBUG("I/O error while writing");
+  SegmentGuard guard(this, SegmentOf(page_id));
+  Segment *segment = guard.Get();
+  if (segment == nullptr) {
+    LOG_DEBUG("I/O error writing page %d of a missing segment", page_id);
     return;
   }
-  // needs to flush to keep disk file in sync
-  db_io_.flush();
+  off_t offset = static_cast<off_t>(PageNumberOf(page_id)) * PAGE_SIZE;
+  num_writes_ += 1;
+  if (segment->direct_io_ && !IsDirectIoAligned(page_data, segment->direct_io_alignment_)) {
+    char *bounce = DirectIoBounceBuffer();
+    memcpy(bounce, page_data, PAGE_SIZE);
+    page_data = bounce;
+  }
+  size_t written = 0;
+  while (written < PAGE_SIZE) {
+    ssize_t rc = pwrite(segment->fd_, page_data + written, PAGE_SIZE - written, offset + written);
+    // check for I/O error
+    if (rc < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      LOG_DEBUG("I/O error while writing");
+      return;
+    }
+    written += rc;
+  }
+  ExtendFileSize(segment, offset + PAGE_SIZE);
 }
 
 /**
  * Read the contents of the specified page into the given memory area
  */
 void DiskManager::ReadPage(page_id_t page_id, char *page_data) {
-  int offset = page_id * PAGE_SIZE;
+  SegmentGuard guard(this, SegmentOf(page_id));
+  Segment *segment = guard.Get();
+  if (segment == nullptr) {
+    LOG_DEBUG("I/O error reading page %d of a missing segment", page_id);
+    // the caller must not see what the buffer held before
+    memset(page_data, 0, PAGE_SIZE);
+    return;
+  }
+  off_t offset = static_cast<off_t>(PageNumberOf(page_id)) * PAGE_SIZE;
+  num_reads_ += 1;
   // check if read beyond file length
-  if (offset > GetFileSize(file_name_)) {
+  if (offset > segment->file_size_.load(std::memory_order_relaxed)) {
     LOG_DEBUG("I/O error reading past end of file");
     // std::cerr << "I/O error while reading" << std::endl;
-  } else {
-    // set read cursor to offset
-    db_io_.seekp(offset);
-    db_io_.read(page_data, PAGE_SIZE);
-    if (db_io_.bad()) {
+    memset(page_data, 0, PAGE_SIZE);
+    return;
+  }
+  char *out = page_data;
+  if (segment->direct_io_ && !IsDirectIoAligned(page_data, segment->direct_io_alignment_)) {
+    page_data = DirectIoBounceBuffer();
+  }
+  size_t read_count = 0;
+  while (read_count < PAGE_SIZE) {
+    ssize_t rc = pread(segment->fd_, page_data + read_count, PAGE_SIZE - read_count, offset + read_count);
+    if (rc < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
       LOG_DEBUG("I/O error while reading");
       return;
     }
-    // if file ends before reading PAGE_SIZE
-    int read_count = db_io_.gcount();
-    if (read_count < PAGE_SIZE) {
-      LOG_DEBUG("Read less than a page");
-      db_io_.clear();
-      // std::cerr << "Read less than a page" << std::endl;
-      memset(page_data + read_count, 0, PAGE_SIZE - read_count);
+    if (rc == 0) {
+      break;
+    }
+    read_count += rc;
+  }
+  // if file ends before reading PAGE_SIZE
+  if (read_count < PAGE_SIZE) {
+    LOG_DEBUG("Read less than a page");
+    // std::cerr << "Read less than a page" << std::endl;
+    memset(page_data + read_count, 0, PAGE_SIZE - read_count);
+  }
+  if (page_data != out) {
+    memcpy(out, page_data, PAGE_SIZE);
+  }
+}
+
+/**
+ * Make the pages written so far durable
+ */
+void DiskManager::SyncPages() {
+  std::scoped_lock lock(segments_latch_);
+  for (auto &slot : segments_) {
+    Segment *segment = slot.load(std::memory_order_relaxed);
+    if (segment != nullptr && fdatasync(segment->fd_) != 0) {
+      LOG_DEBUG("I/O error while syncing %s", segment->name_.c_str());
+    }
+  }
+  // the free space maps go to disk after the pages they describe
+  std::scoped_lock fsm_lock(fsm_latch_);
+  for (auto &slot : segments_) {
+    Segment *segment = slot.load(std::memory_order_relaxed);
+    if (segment != nullptr) {
+      WriteFreeSpaceMap(segment);
     }
   }
 }
@@ -186,16 +356,431 @@ bool DiskManager::ReadLog(char *log_data, int size, int offset) {
 
 /**
  * Allocate new page (operations like create index/table)
- * For now just keep an increasing counter
  */
-page_id_t DiskManager::AllocatePage() { return next_page_id_++; }
+page_id_t DiskManager::AllocatePage(page_id_t hint) { return AllocatePage(1, 0, hint); }
+
+/**
+ * Allocate new page from one residue class of page ids
+ */
+page_id_t DiskManager::AllocatePage(uint32_t stride, uint32_t residue, page_id_t hint) {
+  BUSTUB_ASSERT(residue < stride, "residue out of range");
+  BUSTUB_ASSERT(static_cast<page_id_t>(stride) <= extent_pages_, "an extent must hold every residue class");
+  segment_id_t segment_id = hint == INVALID_PAGE_ID ? 0 : SegmentOf(hint);
+  SegmentGuard guard(this, segment_id);
+  Segment *segment = guard.Get();
+  BUSTUB_ASSERT(segment != nullptr, "allocating in a dropped segment");
+  // the residue class of the page numbers within the segment
+  auto base = static_cast<uint32_t>(MakePageId(segment_id, 0) % stride);
+  residue = (residue + stride - base) % stride;
+  hint = hint == INVALID_PAGE_ID ? INVALID_PAGE_ID : PageNumberOf(hint);
+
+  std::scoped_lock lock(fsm_latch_);
+  page_id_t page_number = INVALID_PAGE_ID;
+  if (hint != INVALID_PAGE_ID) {
+    if (IsOwnedExtent(segment, hint)) {
+      // the extent of the object, from the hint on and then from its start
+      page_id_t extent_start = hint / extent_pages_ * extent_pages_;
+      page_id_t starts[] = {hint, extent_start};
+      for (page_id_t start : starts) {
+        for (page_id_t number = start + (residue + stride - start % stride) % stride;
+             number < extent_start + extent_pages_ && page_number == INVALID_PAGE_ID; number += stride) {
+          if (!TestAllocated(segment, number)) {
+            page_number = number;
+          }
+        }
+      }
+    }
+    if (page_number == INVALID_PAGE_ID) {
+      // claim the lowest wholly free extent for the object
+      size_t extent = 0;
+      auto &owned = segment->owned_extents_;
+      while ((extent < owned.size() && owned[extent]) || !IsFreeExtent(segment, extent)) {
+        extent++;
+      }
+      if (extent >= owned.size()) {
+        owned.resize(extent + 1, false);
+      }
+      owned[extent] = true;
+      page_number = static_cast<page_id_t>(extent) * extent_pages_ + residue;
+    }
+  } else {
+    page_id_t &cursor =
+        segment->fsm_cursors_.emplace((static_cast<uint64_t>(stride) << 32) | residue, residue).first->second;
+    page_number = cursor;
+    const auto &map = segment->free_space_map_;
+    if (stride == 1) {
+      // skip full words, the pages of owned extents count as taken
+      size_t word = page_number / FSM_BITS_PER_WORD;
+      auto taken_at = [&](size_t w) -> uint64_t {
+        uint64_t bits = w < map.size() ? map[w] : 0;
+        return IsOwnedExtent(segment, static_cast<page_id_t>(w * FSM_BITS_PER_WORD)) ? ~0ULL : bits;
+      };
+      uint64_t taken = taken_at(word) | ((1ULL << (page_number % FSM_BITS_PER_WORD)) - 1);
+      while (taken == ~0ULL) {
+        taken = taken_at(++word);
+      }
+      page_number = std::max<page_id_t>(page_number, word * FSM_BITS_PER_WORD + __builtin_ctzll(~taken));
+    } else {
+      while (TestAllocated(segment, page_number) || IsOwnedExtent(segment, page_number)) {
+        page_number += stride;
+      }
+    }
+    cursor = page_number + stride;
+  }
+  BUSTUB_ASSERT(page_number < (1 << SEGMENT_PAGE_BITS), "segment is full");
+  SetAllocated(segment, page_number, true);
+  // the map file learns of the page before anyone can write it, a map older than the pages only leaks pages
+  WriteFreeSpaceMapPage(segment, page_number / (FSM_WORDS_PER_PAGE * FSM_BITS_PER_WORD));
+  // the page exists from now on, reading it before its first write returns zeros
+  Preallocate(segment, page_number);
+  return MakePageId(segment_id, page_number);
+}
+
+bool DiskManager::IsOwnedExtent(const Segment *segment, page_id_t page_number) const {
+  size_t extent = page_number / extent_pages_;
+  return extent < segment->owned_extents_.size() && segment->owned_extents_[extent];
+}
+
+bool DiskManager::IsFreeExtent(const Segment *segment, size_t extent) const {
+  const auto &map = segment->free_space_map_;
+  size_t words = extent_pages_ / FSM_BITS_PER_WORD;
+  for (size_t word = extent * words; word < (extent + 1) * words && word < map.size(); word++) {
+    if (map[word] != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void DiskManager::Preallocate(Segment *segment, page_id_t page_number) {
+  int64_t size = segment->file_size_;
+  int64_t needed = (static_cast<int64_t>(page_number) + 1) * PAGE_SIZE;
+  if (needed <= size) {
+    return;
+  }
+  // one fallocate per extent instead of a block allocation on every first write of a page
+  int64_t extent_bytes = static_cast<int64_t>(extent_pages_) * PAGE_SIZE;
+  int64_t target = (needed + extent_bytes - 1) / extent_bytes * extent_bytes;
+  if (fallocate_supported_ && fallocate(segment->fd_, 0, size, target - size) == 0) {
+    ExtendFileSize(segment, target);
+    return;
+  }
+  if (fallocate_supported_) {
+    LOG_DEBUG("fallocate is not supported, the db file grows as pages are written");
+    fallocate_supported_ = false;
+  }
+  ExtendFileSize(segment, needed);
+}
 
 /**
  * Deallocate page (operations like drop index/table)
- * Need bitmap in header page for tracking pages
- * This does not actually need to do anything for now.
  */
-void DiskManager::DeallocatePage(__attribute__((unused)) page_id_t page_id) {}
+void DiskManager::DeallocatePage(page_id_t page_id) {
+  if (page_id == INVALID_PAGE_ID) {
+    return;
+  }
+  SegmentGuard guard(this, SegmentOf(page_id));
+  Segment *segment = guard.Get();
+  if (segment == nullptr) {
+    return;
+  }
+  page_id_t page_number = PageNumberOf(page_id);
+  std::scoped_lock lock(fsm_latch_);
+  SetAllocated(segment, page_number, false);
+  // the lowest page that became free for allocations without a hint
+  page_id_t lowest = page_number;
+  if (IsOwnedExtent(segment, page_number) && IsFreeExtent(segment, page_number / extent_pages_)) {
+    // the object dropped its last page here, anyone may claim the extent again
+    segment->owned_extents_[page_number / extent_pages_] = false;
+    lowest = page_number / extent_pages_ * extent_pages_;
+  }
+  for (auto &[key, cursor] : segment->fsm_cursors_) {
+    auto stride = static_cast<uint32_t>(key >> 32);
+    auto residue = static_cast<uint32_t>(key & 0xffffffff);
+    cursor = std::min(cursor, lowest + static_cast<page_id_t>((residue + stride - lowest % stride) % stride));
+  }
+}
+
+bool DiskManager::IsAllocated(page_id_t page_id) {
+  SegmentGuard guard(this, SegmentOf(page_id));
+  Segment *segment = guard.Get();
+  if (segment == nullptr) {
+    return false;
+  }
+  std::scoped_lock lock(fsm_latch_);
+  return TestAllocated(segment, PageNumberOf(page_id));
+}
+
+bool DiskManager::TestAllocated(const Segment *segment, page_id_t page_number) const {
+  const auto &map = segment->free_space_map_;
+  size_t word = page_number / FSM_BITS_PER_WORD;
+  return word < map.size() && (map[word] >> (page_number % FSM_BITS_PER_WORD) & 1) != 0;
+}
+
+void DiskManager::SetAllocated(Segment *segment, page_id_t page_number, bool allocated) {
+  auto &map = segment->free_space_map_;
+  size_t word = page_number / FSM_BITS_PER_WORD;
+  if (!allocated && word >= map.size()) {
+    return;
+  }
+  if (word >= map.size()) {
+    // grow by whole bitmap pages
+    size_t pages = word / FSM_WORDS_PER_PAGE + 1;
+    map.resize(pages * FSM_WORDS_PER_PAGE, 0);
+    segment->fsm_dirty_pages_.resize(pages, false);
+  }
+  uint64_t bit = 1ULL << (page_number % FSM_BITS_PER_WORD);
+  map[word] = allocated ? map[word] | bit : map[word] & ~bit;
+  segment->fsm_dirty_pages_[word / FSM_WORDS_PER_PAGE] = true;
+}
+
+void DiskManager::LoadFreeSpaceMap(Segment *segment) {
+  if (segment->file_size_ == 0) {
+    // a new segment file has no pages, whatever map is left over belongs to a removed one
+    if (ftruncate(segment->fsm_fd_, 0) != 0) {
+      LOG_DEBUG("can't truncate free space map");
+    }
+    return;
+  }
+  struct stat stat_buf;
+  if (fstat(segment->fsm_fd_, &stat_buf) != 0) {
+    return;
+  }
+  size_t pages = stat_buf.st_size / PAGE_SIZE;
+  segment->free_space_map_.resize(pages * FSM_WORDS_PER_PAGE, 0);
+  segment->fsm_dirty_pages_.resize(pages, false);
+  size_t bytes = pages * PAGE_SIZE;
+  auto *data = reinterpret_cast<char *>(segment->free_space_map_.data());
+  size_t read_count = 0;
+  while (read_count < bytes) {
+    ssize_t rc = pread(segment->fsm_fd_, data + read_count, bytes - read_count, read_count);
+    if (rc <= 0) {
+      if (rc < 0 && errno == EINTR) {
+        continue;
+      }
+      LOG_DEBUG("I/O error while reading free space map");
+      break;
+    }
+    read_count += rc;
+  }
+  // Pages of the file the map does not cover may be in use, a lost or short map leaks them rather than hand them out
+  auto covered = static_cast<int64_t>(read_count / PAGE_SIZE * FSM_WORDS_PER_PAGE * FSM_BITS_PER_WORD);
+  int64_t file_pages = segment->file_size_ / PAGE_SIZE;
+  for (int64_t page_number = covered; page_number < file_pages; page_number++) {
+    SetAllocated(segment, static_cast<page_id_t>(page_number), true);
+  }
+}
+
+bool DiskManager::WriteFreeSpaceMapPage(Segment *segment, size_t page) {
+  const auto *data = reinterpret_cast<const char *>(&segment->free_space_map_[page * FSM_WORDS_PER_PAGE]);
+  if (pwrite(segment->fsm_fd_, data, PAGE_SIZE, page * PAGE_SIZE) != PAGE_SIZE) {
+    LOG_DEBUG("I/O error while writing free space map");
+    return false;
+  }
+  return true;
+}
+
+void DiskManager::WriteFreeSpaceMap(Segment *segment) {
+  bool written = false;
+  for (size_t page = 0; page < segment->fsm_dirty_pages_.size(); page++) {
+    if (!segment->fsm_dirty_pages_[page] || !WriteFreeSpaceMapPage(segment, page)) {
+      continue;
+    }
+    segment->fsm_dirty_pages_[page] = false;
+    written = true;
+  }
+  if (written && fdatasync(segment->fsm_fd_) != 0) {
+    LOG_DEBUG("I/O error while syncing free space map");
+  }
+}
+
+/**
+ * Create the segment file of a new object
+ */
+segment_id_t DiskManager::CreateSegment() {
+  std::scoped_lock lock(segments_latch_);
+  if (next_segment_id_ >= MAX_SEGMENTS) {
+    throw Exception("too many segments");
+  }
+  segment_id_t segment_id = next_segment_id_++;
+  if (OpenSegment(segment_id, true) == nullptr) {
+    throw Exception("can't create segment file");
+  }
+  return segment_id;
+}
+
+/**
+ * Drop an object: its pages go away with its file
+ */
+void DiskManager::DropSegment(segment_id_t segment_id) {
+  BUSTUB_ASSERT(segment_id > 0 && segment_id < MAX_SEGMENTS, "segment 0 can't be dropped");
+  std::scoped_lock lock(segments_latch_);
+  RetireSegment(segment_id, false);
+  auto [name, fsm_name] = SegmentFileNames(segment_id);
+  unlink(name.c_str());
+  unlink(fsm_name.c_str());
+}
+
+DiskManager::Segment *DiskManager::AcquireSegment(segment_id_t segment_id) {
+  if (segment_id < 0 || segment_id >= MAX_SEGMENTS) {
+    return nullptr;
+  }
+  // Announce the use before reading the slot, RetireSegment empties the slot first and then waits for the users.
+  std::atomic<uint32_t> &users = segment_users_[segment_id];
+  users.fetch_add(1, std::memory_order_seq_cst);
+  Segment *segment = segments_[segment_id].load(std::memory_order_seq_cst);
+  if (segment != nullptr) {
+    return segment;
+  }
+  // RetireSegment waits with segments_latch_ held, do not keep it waiting for us
+  users.fetch_sub(1, std::memory_order_release);
+  // a segment created before a restart is opened on first use
+  std::scoped_lock lock(segments_latch_);
+  segment = OpenSegment(segment_id, false);
+  if (segment != nullptr) {
+    users.fetch_add(1, std::memory_order_relaxed);
+  }
+  return segment;
+}
+
+bool DiskManager::IsDirectIo(segment_id_t segment_id) {
+  SegmentGuard guard(this, segment_id);
+  return guard.Get() != nullptr && guard.Get()->direct_io_;
+}
+
+size_t DiskManager::GetDirectIoAlignment(segment_id_t segment_id) {
+  SegmentGuard guard(this, segment_id);
+  return guard.Get() == nullptr ? 1 : guard.Get()->direct_io_alignment_;
+}
+
+void DiskManager::ReleaseSegment(Segment *segment) {
+  if (segment != nullptr) {
+    segment_users_[segment->id_].fetch_sub(1, std::memory_order_release);
+  }
+}
+
+void DiskManager::RetireSegment(segment_id_t segment_id, bool save_map) {
+  Segment *segment = segments_[segment_id].exchange(nullptr, std::memory_order_seq_cst);
+  if (segment == nullptr) {
+    return;
+  }
+  // users that read the slot before it was emptied are still reading or writing the file
+  std::atomic<uint32_t> &users = segment_users_[segment_id];
+  while (users.load(std::memory_order_acquire) != 0) {
+    std::this_thread::yield();
+  }
+  if (save_map) {
+    std::scoped_lock fsm_lock(fsm_latch_);
+    WriteFreeSpaceMap(segment);
+  }
+  CloseSegment(segment);
+}
+
+DiskManager::Segment *DiskManager::OpenSegment(segment_id_t segment_id, bool create) {
+  Segment *segment = segments_[segment_id].load(std::memory_order_relaxed);
+  if (segment != nullptr) {
+    return segment;
+  }
+  auto [name, fsm_name] = SegmentFileNames(segment_id);
+  int flags = O_RDWR | (create ? O_CREAT : 0);
+  int fd = -1;
+  bool direct_io = direct_io_;
+  size_t alignment = 1;
+  if (direct_io) {
+    fd = open(name.c_str(), flags | O_DIRECT, 0644);
+    if (fd < 0) {
+      if (errno == EINVAL) {
+        // the file system does not support O_DIRECT (e.g. tmpfs), fall back to buffered I/O
+        LOG_DEBUG("O_DIRECT not supported for %s", name.c_str());
+        direct_io = false;
+      } else {
+        return nullptr;
+      }
+    } else {
+      alignment = DirectIoAlignment(fd);
+      if (alignment == 0) {
+        LOG_WARN("%s cannot do direct I/O of whole pages, using buffered I/O", name.c_str());
+        close(fd);
+        direct_io = false;
+        alignment = 1;
+      }
+    }
+  }
+  if (!direct_io) {
+    fd = open(name.c_str(), flags, 0644);
+  }
+  if (fd < 0) {
+    return nullptr;
+  }
+  segment = new Segment();
+  segment->id_ = segment_id;
+  segment->name_ = name;
+  segment->fd_ = fd;
+  // only this segment falls back, the others keep their mode. Both are set before the segment is published.
+  segment->direct_io_ = direct_io;
+  segment->direct_io_alignment_ = alignment;
+  struct stat stat_buf;
+  if (fstat(fd, &stat_buf) == 0) {
+    segment->file_size_ = stat_buf.st_size;
+  }
+  segment->fsm_name_ = fsm_name;
+  segment->fsm_fd_ = open(fsm_name.c_str(), O_RDWR | O_CREAT, 0644);
+  if (segment->fsm_fd_ < 0) {
+    CloseSegment(segment);
+    throw Exception("can't open free space map file");
+  }
+  LoadFreeSpaceMap(segment);
+  segments_[segment_id].store(segment, std::memory_order_release);
+  return segment;
+}
+
+void DiskManager::CloseSegment(Segment *segment) {
+  if (segment == nullptr) {
+    return;
+  }
+  if (segment->fd_ >= 0) {
+    close(segment->fd_);
+  }
+  if (segment->fsm_fd_ >= 0) {
+    close(segment->fsm_fd_);
+  }
+  delete segment;
+}
+
+std::pair<std::string, std::string> DiskManager::SegmentFileNames(segment_id_t segment_id) const {
+  if (segment_id == 0) {
+    return {file_name_, base_name_ + ".fsm"};
+  }
+  std::string prefix = base_name_ + "." + std::to_string(segment_id);
+  return {prefix + extension_, prefix + ".fsm"};
+}
+
+void DiskManager::ScanSegments(bool orphaned) {
+  for (segment_id_t segment_id : FindSegmentFiles(base_name_, extension_)) {
+    if (orphaned) {
+      LOG_WARN("%s is left over from a removed database, it is not used", SegmentFileNames(segment_id).first.c_str());
+    }
+    next_segment_id_ = std::max(next_segment_id_, segment_id + 1);
+  }
+}
+
+void DiskManager::RemoveFiles(const std::string &db_file) {
+  remove(db_file.c_str());
+  std::string::size_type n = db_file.rfind('.');
+  if (n == std::string::npos) {
+    return;
+  }
+  // same names as the constructor and SegmentFileNames give them
+  std::string base_name = db_file.substr(0, n);
+  std::string extension = db_file.substr(n);
+  remove((base_name + ".log").c_str());
+  remove((base_name + ".fsm").c_str());
+  for (segment_id_t segment_id : FindSegmentFiles(base_name, extension)) {
+    std::string prefix = base_name + "." + std::to_string(segment_id);
+    remove((prefix + extension).c_str());
+    remove((prefix + ".fsm").c_str());
+  }
+}
 
 /**
  * Returns number of flushes made so far
@@ -207,11 +792,25 @@ int DiskManager::GetNumFlushes() const { return num_flushes_; }
  */
 int DiskManager::GetNumWrites() const { return num_writes_; }
 
+/**
+ * Returns number of page reads made so far
+ */
+int DiskManager::GetNumReads() const { return num_reads_; }
+
 /**
  * Returns true if the log is currently being flushed
  */
 bool DiskManager::GetFlushState() const { return flush_log_; }
 
+/**
+ * Private helper function to grow the logical size of a segment file
+ */
+void DiskManager::ExtendFileSize(Segment *segment, int64_t size) {
+  int64_t current = segment->file_size_.load(std::memory_order_relaxed);
+  while (current < size && !segment->file_size_.compare_exchange_weak(current, size, std::memory_order_relaxed)) {
+  }
+}
+
 /**
  * Private helper function to get disk file size
  */
@@ -0,0 +1,296 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// io_uring_disk_manager.cpp
+//
+// Identification: src/storage/disk/io_uring_disk_manager.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/io_uring_disk_manager.h"
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include "common/exception.h"
+#include "common/logger.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+namespace {
+
+int IoUringSetup(unsigned entries, io_uring_params *params) {
+  return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+int IoUringEnter(int ring_fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+  return static_cast<int>(syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+int IoUringRegister(int ring_fd, unsigned opcode, const void *arg, unsigned nr_args) {
+  return static_cast<int>(syscall(__NR_io_uring_register, ring_fd, opcode, arg, nr_args));
+}
+
+// The head and tail indexes are shared with the kernel.
+unsigned LoadAcquire(const unsigned *p) { return __atomic_load_n(p, __ATOMIC_ACQUIRE); }
+void StoreRelease(unsigned *p, unsigned v) { __atomic_store_n(p, v, __ATOMIC_RELEASE); }
+
+}  // namespace
+
+IoUringDiskManager::IoUringDiskManager(const std::string &db_file, uint32_t queue_depth, bool direct_io)
+    : DiskManager(db_file, direct_io), queue_depth_(queue_depth) {
+  io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  ring_fd_ = IoUringSetup(queue_depth_, &params);
+  if (ring_fd_ < 0) {
+    throw Exception("io_uring is not available");
+  }
+
+  sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+  if (single_mmap) {
+    sq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+  }
+  sq_ring_ = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_,
+                  IORING_OFF_SQ_RING);
+  if (sq_ring_ == MAP_FAILED) {
+    close(ring_fd_);
+    throw Exception("can't map io_uring submission queue");
+  }
+  if (single_mmap) {
+    cq_ring_ = sq_ring_;
+  } else {
+    cq_ring_ = mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_,
+                    IORING_OFF_CQ_RING);
+    if (cq_ring_ == MAP_FAILED) {
+      munmap(sq_ring_, sq_ring_size_);
+      close(ring_fd_);
+      throw Exception("can't map io_uring completion queue");
+    }
+  }
+  sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+  void *sqes = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQES);
+  if (sqes == MAP_FAILED) {
+    if (!single_mmap) {
+      munmap(cq_ring_, cq_ring_size_);
+    }
+    munmap(sq_ring_, sq_ring_size_);
+    close(ring_fd_);
+    throw Exception("can't map io_uring submission queue entries");
+  }
+  sqes_ = static_cast<io_uring_sqe *>(sqes);
+
+  auto *sq = static_cast<char *>(sq_ring_);
+  sq_head_ = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+  sq_tail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+  sq_mask_ = *reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+  sq_array_ = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+  auto *cq = static_cast<char *>(cq_ring_);
+  cq_head_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+  cq_tail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+  cq_mask_ = *reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+  cqes_ = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+
+  // The kernel may round the depth up, but never more requests than queue_depth_ are in flight,
+  // so the completion queue (at least as large as the submission queue) cannot overflow.
+  requests_.resize(queue_depth_);
+  free_slots_.reserve(queue_depth_);
+  for (uint32_t slot = queue_depth_; slot > 0; slot--) {
+    free_slots_.push_back(slot - 1);
+  }
+}
+
+IoUringDiskManager::~IoUringDiskManager() {
+  // Wait for whatever is still in flight, the kernel may be writing into the callers' buffers.
+  std::vector<IoCompletion> completions;
+  Submit();
+  while (InFlight() > 0) {
+    completions.clear();
+    PollCompletions(&completions, 1);
+  }
+  munmap(sqes_, sqes_size_);
+  if (cq_ring_ != sq_ring_) {
+    munmap(cq_ring_, cq_ring_size_);
+  }
+  munmap(sq_ring_, sq_ring_size_);
+  close(ring_fd_);
+}
+
+bool IoUringDiskManager::RegisterBuffers(const std::vector<char *> &buffers) {
+  std::scoped_lock lock(latch_);
+  if (buffers_registered_) {
+    return false;
+  }
+  std::vector<iovec> iovecs(buffers.size());
+  for (size_t i = 0; i < buffers.size(); i++) {
+    iovecs[i].iov_base = buffers[i];
+    iovecs[i].iov_len = PAGE_SIZE;
+  }
+  if (IoUringRegister(ring_fd_, IORING_REGISTER_BUFFERS, iovecs.data(), iovecs.size()) != 0) {
+    LOG_DEBUG("io_uring buffer registration failed: %s", strerror(errno));
+    return false;
+  }
+  buffers_registered_ = true;
+  return true;
+}
+
+bool IoUringDiskManager::PrepareRead(page_id_t page_id, char *page_data, uint64_t tag, int buffer_index) {
+  std::scoped_lock lock(latch_);
+  return Prepare(buffer_index >= 0 ? IORING_OP_READ_FIXED : IORING_OP_READ, page_id, page_data, tag, buffer_index);
+}
+
+bool IoUringDiskManager::PrepareWrite(page_id_t page_id, const char *page_data, uint64_t tag, int buffer_index) {
+  std::scoped_lock lock(latch_);
+  // the kernel only reads from the buffer of a write
+  return Prepare(buffer_index >= 0 ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE, page_id, const_cast<char *>(page_data),
+                 tag, buffer_index);
+}
+
+bool IoUringDiskManager::Prepare(uint8_t opcode, page_id_t page_id, char *data, uint64_t tag, int buffer_index) {
+  BUSTUB_ASSERT(buffer_index < 0 || buffers_registered_, "buffer_index needs registered buffers");
+  if (free_slots_.empty()) {
+    return false;
+  }
+  if (*sq_tail_ - LoadAcquire(sq_head_) > sq_mask_) {
+    // the submission queue is full of prepared requests, hand them over first
+    SubmitPrepared();
+  }
+  // a failed submission takes its entries back
+  unsigned tail = *sq_tail_;
+  uint32_t slot = free_slots_.back();
+  free_slots_.pop_back();
+  bool is_read = opcode == IORING_OP_READ || opcode == IORING_OP_READ_FIXED;
+  // a missing segment completes with -EBADF
+  Segment *segment = AcquireSegment(SegmentOf(page_id));
+  BUSTUB_ASSERT(segment == nullptr || !segment->direct_io_ ||
+                    reinterpret_cast<uintptr_t>(data) % segment->direct_io_alignment_ == 0,
+                "direct I/O needs buffers aligned to GetDirectIoAlignment()");
+  requests_[slot] = {tag, page_id, data, is_read, segment};
+
+  unsigned index = tail & sq_mask_;
+  io_uring_sqe *sqe = &sqes_[index];
+  memset(sqe, 0, sizeof(*sqe));
+  sqe->opcode = opcode;
+  sqe->fd = segment != nullptr ? segment->fd_ : -1;
+  sqe->off = static_cast<uint64_t>(PageNumberOf(page_id)) * PAGE_SIZE;
+  sqe->addr = reinterpret_cast<uint64_t>(data);
+  sqe->len = PAGE_SIZE;
+  if (buffer_index >= 0) {
+    sqe->buf_index = static_cast<uint16_t>(buffer_index);
+  }
+  sqe->user_data = slot;
+  sq_array_[index] = index;
+  StoreRelease(sq_tail_, tail + 1);
+  to_submit_++;
+  if (!is_read) {
+    num_writes_ += 1;
+  }
+  return true;
+}
+
+size_t IoUringDiskManager::Submit() {
+  std::scoped_lock lock(latch_);
+  return SubmitPrepared();
+}
+
+size_t IoUringDiskManager::SubmitPrepared() {
+  size_t submitted = 0;
+  while (to_submit_ > 0) {
+    int rc = IoUringEnter(ring_fd_, to_submit_, 0, 0);
+    if (rc < 0) {
+      if (errno == EINTR || errno == EAGAIN || errno == EBUSY) {
+        continue;
+      }
+      int error = errno;
+      LOG_DEBUG("io_uring submission failed: %s", strerror(error));
+      FailPrepared(-error);
+      break;
+    }
+    to_submit_ -= rc;
+    submitted += rc;
+  }
+  return submitted;
+}
+
+void IoUringDiskManager::FailPrepared(int result) {
+  // the kernel only takes entries inside io_uring_enter, whatever is past its head now never reaches it
+  unsigned head = LoadAcquire(sq_head_);
+  for (unsigned index = head; index != *sq_tail_; index++) {
+    auto slot = static_cast<uint32_t>(sqes_[sq_array_[index & sq_mask_]].user_data);
+    Request &request = requests_[slot];
+    ReleaseSegment(request.segment_);
+    free_slots_.push_back(slot);
+    failed_.push_back({request.tag_, result});
+  }
+  StoreRelease(sq_tail_, head);
+  to_submit_ = 0;
+}
+
+size_t IoUringDiskManager::PollCompletions(std::vector<IoCompletion> *completions, size_t min_complete) {
+  std::scoped_lock lock(latch_);
+  // requests prepared but not submitted would never complete
+  SubmitPrepared();
+  size_t reaped = failed_.size();
+  completions->insert(completions->end(), failed_.begin(), failed_.end());
+  failed_.clear();
+  while (true) {
+    unsigned head = *cq_head_;
+    unsigned tail = LoadAcquire(cq_tail_);
+    for (; head != tail; head++) {
+      completions->push_back(Complete(cqes_[head & cq_mask_]));
+      reaped++;
+    }
+    StoreRelease(cq_head_, head);
+    // only the requests the kernel took can complete
+    size_t in_flight = queue_depth_ - free_slots_.size();
+    if (reaped >= min_complete || in_flight == 0) {
+      return reaped;
+    }
+    auto wait_for = static_cast<unsigned>(std::min(min_complete - reaped, in_flight));
+    int rc = IoUringEnter(ring_fd_, 0, wait_for, IORING_ENTER_GETEVENTS);
+    if (rc < 0 && errno != EINTR) {
+      LOG_DEBUG("io_uring wait failed: %s", strerror(errno));
+      return reaped;
+    }
+  }
+}
+
+IoCompletion IoUringDiskManager::Complete(const io_uring_cqe &cqe) {
+  auto slot = static_cast<uint32_t>(cqe.user_data);
+  Request &request = requests_[slot];
+  int result = cqe.res;
+  if (result >= 0 && result < PAGE_SIZE) {
+    if (request.is_read_) {
+      // the file ends before the page does
+      memset(request.data_ + result, 0, PAGE_SIZE - result);
+      result = PAGE_SIZE;
+    } else {
+      LOG_DEBUG("short write of page %d", request.page_id_);
+      result = -EIO;
+    }
+  }
+  if (result == PAGE_SIZE && !request.is_read_) {
+    ExtendFileSize(request.segment_, (static_cast<int64_t>(PageNumberOf(request.page_id_)) + 1) * PAGE_SIZE);
+  }
+  ReleaseSegment(request.segment_);
+  free_slots_.push_back(slot);
+  return {request.tag_, result};
+}
+
+size_t IoUringDiskManager::InFlight() {
+  std::scoped_lock lock(latch_);
+  return queue_depth_ - free_slots_.size() + failed_.size();
+}
+
+}  // namespace bustub
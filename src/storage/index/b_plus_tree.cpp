@@ -11,6 +11,7 @@
 
 #include <sys/syscall.h>  // for SYS_xxx definitions
 #include <unistd.h>       // for syscall()
+#include <algorithm>
 #include <string>
 
 #include "common/exception.h"
@@ -21,13 +22,14 @@
 namespace bustub {
 INDEX_TEMPLATE_ARGUMENTS
 BPLUSTREE_TYPE::BPlusTree(std::string name, BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
-                          int leaf_max_size, int internal_max_size)
+                          int leaf_max_size, int internal_max_size, bool blink)
     : index_name_(std::move(name)),
       root_page_id_(INVALID_PAGE_ID),
       buffer_pool_manager_(buffer_pool_manager),
       comparator_(comparator),
       leaf_max_size_(leaf_max_size),
-      internal_max_size_(internal_max_size) {}
+      internal_max_size_(internal_max_size),
+      blink_(blink) {}
 
 /*
  * Helper function to decide whether current b+tree is empty
@@ -75,16 +77,19 @@ bool BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result
  */
 INDEX_TEMPLATE_ARGUMENTS
 bool BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transaction *transaction) {
-  root_latch_.lock();
-  // LOG_DEBUG("%s:%d thread %ld root_lock\n", __FILE__, __LINE__, syscall(SYS_gettid));
+  // 只有空树需要root_latch_来建root
   if (IsEmpty()) {
-    StartNewTree(key, value);
+    root_latch_.lock();
+    // LOG_DEBUG("%s:%d thread %ld root_lock\n", __FILE__, __LINE__, syscall(SYS_gettid));
+    if (IsEmpty()) {
+      StartNewTree(key, value);
+      // LOG_DEBUG("%s:%d thread %ld root_unlock\n", __FILE__, __LINE__, syscall(SYS_gettid));
+      root_latch_.unlock();
+      return true;
+    }
     // LOG_DEBUG("%s:%d thread %ld root_unlock\n", __FILE__, __LINE__, syscall(SYS_gettid));
     root_latch_.unlock();
-    return true;
   }
-  // LOG_DEBUG("%s:%d thread %ld root_unlock\n", __FILE__, __LINE__, syscall(SYS_gettid));
-  root_latch_.unlock();
 
   return InsertIntoLeaf(key, value, transaction);
 }
@@ -98,17 +103,20 @@ INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value) {
   // 创建新page
   auto new_page_id = INVALID_PAGE_ID;
-  Page *page = buffer_pool_manager_->NewPage(&new_page_id);
+  if (segment_id_ == INVALID_SEGMENT_ID) {
+    segment_id_ = buffer_pool_manager_->CreateSegment();
+  }
+  Page *page = buffer_pool_manager_->NewPage(&new_page_id, DiskManager::MakePageId(segment_id_, 0));
   if (page == nullptr) {
     throw std::runtime_error("out of memory");
   }
-  // 更新root
-  root_page_id_ = new_page_id;
-  UpdateRootPageId(1);
   // 插入
   LeafPage *root_leaf = reinterpret_cast<LeafPage *>(page->GetData());
-  root_leaf->Init(root_page_id_, INVALID_PAGE_ID, leaf_max_size_);
+  root_leaf->Init(new_page_id, INVALID_PAGE_ID, leaf_max_size_);
   root_leaf->Insert(key, value, comparator_);
+  // 更新root，descents without root_latch_ may follow it from here on
+  root_page_id_ = new_page_id;
+  UpdateRootPageId(1);
 
   buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
 }
@@ -123,6 +131,9 @@ void BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value) {
  */
 INDEX_TEMPLATE_ARGUMENTS
 bool BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value, Transaction *transaction) {
+  if (blink_) {
+    return InsertIntoLeafBLink(key, value);
+  }
   // find the right leaf page
   Page *page = nullptr;
   auto root_locked = FindLeafPageEx(&page, key, FindOp::None, UsedOp::INSERT, transaction);
@@ -144,6 +155,7 @@ bool BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value,
       // LOG_DEBUG("%s:%d thread %ld Page %d unlock\n", __FILE__, __LINE__, syscall(SYS_gettid),
       // item_page->GetPageId());
       item_page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(item_page->GetPageId(), true);
     }
     transaction->GetPageSet()->clear();
     // LOG_DEBUG("%s:%d thread %ld Page %d unlock\n", __FILE__, __LINE__, syscall(SYS_gettid), page->GetPageId());
@@ -168,6 +180,7 @@ bool BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value,
   for (auto item_page : *transaction->GetPageSet()) {
     // LOG_DEBUG("%s:%d thread %ld Page %d unlock\n", __FILE__, __LINE__, syscall(SYS_gettid), item_page->GetPageId());
     item_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(item_page->GetPageId(), true);
   }
   transaction->GetPageSet()->clear();
   // LOG_DEBUG("%s:%d thread %ld Page %d unlock\n", __FILE__, __LINE__, syscall(SYS_gettid), page->GetPageId());
@@ -185,13 +198,22 @@ bool BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value,
  */
 INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
-N *BPLUSTREE_TYPE::Split(N *node) {
+N *BPLUSTREE_TYPE::Split(N *node, Page **new_page) {
   auto new_pid = INVALID_PAGE_ID;
-  Page *new_page = buffer_pool_manager_->NewPage(&new_pid);
-  if (new_page == nullptr) {
+  // the index's pages share its extents on disk
+  Page *page = buffer_pool_manager_->NewPage(&new_pid, node->GetPageId());
+  if (page == nullptr) {
     throw std::runtime_error("out of memory");
   }
-  N *new_node = reinterpret_cast<N *>(new_page->GetData());
+  if (blink_) {
+    // moved children learn the new node as their parent before it is linked into the tree
+    page->WLatch();
+  }
+  if (new_page != nullptr) {
+    *new_page = page;
+  }
+  N *new_node = reinterpret_cast<N *>(page->GetData());
+  // 新节点接过旧节点的high key和右链，旧节点的high key变为分隔key
   if (node->IsLeafPage()) {
     LeafPage *old_leaf = reinterpret_cast<LeafPage *>(node);
     LeafPage *new_leaf = reinterpret_cast<LeafPage *>(new_node);
@@ -199,12 +221,18 @@ N *BPLUSTREE_TYPE::Split(N *node) {
     old_leaf->MoveHalfTo(new_leaf);
     // leaf page需要更新next_page_id
     new_leaf->SetNextPageId(old_leaf->GetNextPageId());
+    new_leaf->SetHighKey(old_leaf->GetHighKey());
     old_leaf->SetNextPageId(new_leaf->GetPageId());
+    old_leaf->SetHighKey(new_leaf->KeyAt(0));
   } else {
     InternalPage *old_internal = reinterpret_cast<InternalPage *>(node);
     InternalPage *new_internal = reinterpret_cast<InternalPage *>(new_node);
     new_internal->Init(new_pid, INVALID_PAGE_ID, internal_max_size_);
     old_internal->MoveHalfTo(new_internal, buffer_pool_manager_);
+    new_internal->SetNextPageId(old_internal->GetNextPageId());
+    new_internal->SetHighKey(old_internal->GetHighKey());
+    old_internal->SetNextPageId(new_internal->GetPageId());
+    old_internal->SetHighKey(new_internal->KeyAt(0));
   }
 
   return new_node;
@@ -228,24 +256,7 @@ void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node, const KeyType &ke
       *root_locked = true;
       // LOG_DEBUG("%s:%d thread %ld root_lock\n", __FILE__, __LINE__, syscall(SYS_gettid));
     }
-    page_id_t new_root_pid = INVALID_PAGE_ID;
-    Page *new_root_page = buffer_pool_manager_->NewPage(&new_root_pid);
-    if (new_root_page == nullptr) {
-      throw std::runtime_error("out of memory");
-    }
-    // 更新root id
-    root_page_id_ = new_root_pid;
-    UpdateRootPageId(0);
-    // init
-    InternalPage *new_root_node = reinterpret_cast<InternalPage *>(new_root_page->GetData());
-    new_root_node->Init(new_root_pid, INVALID_PAGE_ID, internal_max_size_);
-    // 填充新Root
-    new_root_node->PopulateNewRoot(old_node->GetPageId(), key, new_node->GetPageId());
-    // 修改父id
-    old_node->SetParentPageId(new_root_node->GetPageId());
-    new_node->SetParentPageId(new_root_node->GetPageId());
-
-    buffer_pool_manager_->UnpinPage(new_root_page->GetPageId(), true);
+    GrowRoot(old_node, key, new_node);
 
     if (*root_locked) {
       *root_locked = false;
@@ -257,6 +268,7 @@ void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node, const KeyType &ke
       // LOG_DEBUG("%s:%d thread %ld Page %d unlock\n", __FILE__, __LINE__, syscall(SYS_gettid),
       // item_page->GetPageId());
       item_page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(item_page->GetPageId(), true);
     }
     transaction->GetPageSet()->clear();
 
@@ -285,6 +297,7 @@ void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node, const KeyType &ke
       // LOG_DEBUG("%s:%d thread %ld Page %d unlock\n", __FILE__, __LINE__, syscall(SYS_gettid),
       // item_page->GetPageId());
       item_page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(item_page->GetPageId(), true);
     }
     transaction->GetPageSet()->clear();
 
@@ -301,15 +314,323 @@ void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node, const KeyType &ke
   for (auto item_page : *transaction->GetPageSet()) {
     // LOG_DEBUG("%s:%d thread %ld Page %d unlock\n", __FILE__, __LINE__, syscall(SYS_gettid), item_page->GetPageId());
     item_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(item_page->GetPageId(), true);
   }
   transaction->GetPageSet()->clear();
 
   buffer_pool_manager_->UnpinPage(pnode->GetPageId(), true);
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::GrowRoot(BPlusTreePage *old_node, const KeyType &key, BPlusTreePage *new_node) {
+  page_id_t new_root_pid = INVALID_PAGE_ID;
+  Page *new_root_page = buffer_pool_manager_->NewPage(&new_root_pid, old_node->GetPageId());
+  if (new_root_page == nullptr) {
+    throw std::runtime_error("out of memory");
+  }
+  // init
+  InternalPage *new_root_node = reinterpret_cast<InternalPage *>(new_root_page->GetData());
+  new_root_node->Init(new_root_pid, INVALID_PAGE_ID, internal_max_size_);
+  // 填充新Root
+  new_root_node->PopulateNewRoot(old_node->GetPageId(), key, new_node->GetPageId());
+  // 修改父id
+  old_node->SetParentPageId(new_root_node->GetPageId());
+  new_node->SetParentPageId(new_root_node->GetPageId());
+  // 更新root id，新root已完整
+  root_page_id_ = new_root_pid;
+  UpdateRootPageId(0);
+
+  buffer_pool_manager_->UnpinPage(new_root_page->GetPageId(), true);
+}
+
+/*
+ * B-link insert: only the leaf is write latched on the way down. A split
+ * latches the parent after the leaf is split, then lets go of the leaf, so
+ * latches are only ever taken bottom up and left to right.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::InsertIntoLeafBLink(const KeyType &key, const ValueType &value) {
+  Page *page = FindLeafPageBLink(key, FindOp::None, UsedOp::INSERT);
+  // B-link树在StartNewTree之后不会再变空
+  assert(page != nullptr);
+  LeafPage *leaf_page = reinterpret_cast<LeafPage *>(page->GetData());
+  ValueType un_value;
+  if (leaf_page->Lookup(key, &un_value, comparator_)) {
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    return false;
+  }
+
+  int newsz = leaf_page->Insert(key, value, comparator_);
+  if (newsz >= leaf_page->GetMaxSize()) {
+    Page *new_page = nullptr;
+    LeafPage *new_leaf_page = Split(leaf_page, &new_page);
+    InsertIntoParentBLink(page, new_leaf_page->KeyAt(0), new_page);
+    return true;
+  }
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::InsertIntoParentBLink(Page *old_page, const KeyType &key, Page *new_page) {
+  KeyType separator = key;
+  while (true) {
+    auto old_node = reinterpret_cast<BPlusTreePage *>(old_page->GetData());
+    auto new_node = reinterpret_cast<BPlusTreePage *>(new_page->GetData());
+    Page *parent_page = nullptr;
+    if (old_node->IsRootPage()) {
+      // old_node is write latched, nobody else can have put a root above it or be doing so
+      GrowRoot(old_node, separator, new_node);
+    } else {
+      parent_page = buffer_pool_manager_->FetchPage(old_node->GetParentPageId());
+      assert(parent_page != nullptr);
+      parent_page->WLatch();
+      // The parent may have split since old_node learned its id, the pointer to old_node then moved right.
+      auto parent_node = reinterpret_cast<InternalPage *>(parent_page->GetData());
+      while (parent_node->ValueIndex(old_node->GetPageId()) == -1) {
+        page_id_t next_pid = parent_node->GetNextPageId();
+        assert(next_pid != INVALID_PAGE_ID);
+        Page *next_page = buffer_pool_manager_->FetchPage(next_pid);
+        parent_page->WUnlatch();
+        buffer_pool_manager_->UnpinPage(parent_page->GetPageId(), false);
+        next_page->WLatch();
+        parent_page = next_page;
+        parent_node = reinterpret_cast<InternalPage *>(parent_page->GetData());
+      }
+      new_node->SetParentPageId(parent_node->GetPageId());
+      parent_node->InsertNodeAfter(old_node->GetPageId(), separator, new_node->GetPageId());
+    }
+    // the separator is in place, the children are done
+    new_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(new_page->GetPageId(), true);
+    old_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(old_page->GetPageId(), true);
+    if (parent_page == nullptr) {
+      return;
+    }
+
+    auto parent_node = reinterpret_cast<InternalPage *>(parent_page->GetData());
+    if (parent_node->GetSize() <= parent_node->GetMaxSize()) {
+      parent_page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(parent_page->GetPageId(), true);
+      return;
+    }
+    // 父节点溢出，向上一层继续分裂
+    Page *split_page = nullptr;
+    InternalPage *new_parent_node = Split(parent_node, &split_page);
+    separator = new_parent_node->KeyAt(0);
+    old_page = parent_page;
+    new_page = split_page;
+  }
+}
+
+/*****************************************************************************
+ * BULK LOADING
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::BulkLoad(const std::function<bool(KeyType *, ValueType *)> &next, double fill_factor) {
+  if (!IsEmpty()) {
+    return false;
+  }
+  fill_factor = std::min(std::max(fill_factor, 0.0), 1.0);
+  // leaf在size达到max时分裂，internal在超过max时分裂
+  int leaf_fill = std::max(1, static_cast<int>(fill_factor * (leaf_max_size_ - 1)));
+  int internal_fill = std::max(2, static_cast<int>(fill_factor * internal_max_size_));
+
+  KeyType key;
+  ValueType value;
+  if (!next(&key, &value)) {
+    return true;
+  }
+  StartNewTree(key, value);
+  // 每一层最右边的节点，leaf在前
+  std::vector<Page *> open{buffer_pool_manager_->FetchPage(root_page_id_)};
+  KeyType last_key = key;
+  bool sorted = true;
+  while (next(&key, &value)) {
+    if (comparator_(key, last_key) <= 0) {
+      sorted = false;
+      break;
+    }
+    last_key = key;
+    LeafPage *leaf = reinterpret_cast<LeafPage *>(open[0]->GetData());
+    if (leaf->GetSize() < leaf_fill) {
+      leaf->Append(key, value);
+      continue;
+    }
+    page_id_t new_pid = INVALID_PAGE_ID;
+    Page *new_page = buffer_pool_manager_->NewPage(&new_pid, leaf->GetPageId());
+    if (new_page == nullptr) {
+      throw std::runtime_error("out of memory");
+    }
+    LeafPage *new_leaf = reinterpret_cast<LeafPage *>(new_page->GetData());
+    new_leaf->Init(new_pid, INVALID_PAGE_ID, leaf_max_size_);
+    new_leaf->Append(key, value);
+    BulkAppendSibling(&open, 0, key, new_page, internal_fill);
+  }
+  if (sorted) {
+    // 从上往下，使右边缘上每个节点的父节点至少有两个child
+    for (size_t level = open.size() - 1; level-- > 0;) {
+      BulkFixRightEdge(&open, level);
+    }
+  }
+  for (auto page : open) {
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+  }
+  if (!sorted) {
+    Drop();
+    return false;
+  }
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::BulkAppendSibling(std::vector<Page *> *open, size_t level, const KeyType &separator,
+                                       Page *new_page, int internal_fill) {
+  Page *old_page = (*open)[level];
+  auto old_node = reinterpret_cast<BPlusTreePage *>(old_page->GetData());
+  auto new_node = reinterpret_cast<BPlusTreePage *>(new_page->GetData());
+  // 右链和high key与Split设置的一致
+  if (old_node->IsLeafPage()) {
+    LeafPage *old_leaf = reinterpret_cast<LeafPage *>(old_node);
+    old_leaf->SetNextPageId(new_node->GetPageId());
+    old_leaf->SetHighKey(separator);
+  } else {
+    InternalPage *old_internal = reinterpret_cast<InternalPage *>(old_node);
+    old_internal->SetNextPageId(new_node->GetPageId());
+    old_internal->SetHighKey(separator);
+  }
+
+  if (level + 1 == open->size()) {
+    // old_node has been the root so far
+    GrowRoot(old_node, separator, new_node);
+    open->push_back(buffer_pool_manager_->FetchPage(root_page_id_));
+  } else {
+    Page *parent_page = (*open)[level + 1];
+    InternalPage *parent = reinterpret_cast<InternalPage *>(parent_page->GetData());
+    if (parent->GetSize() < internal_fill) {
+      parent->Append(separator, new_node->GetPageId());
+      new_node->SetParentPageId(parent->GetPageId());
+    } else {
+      page_id_t new_parent_pid = INVALID_PAGE_ID;
+      Page *new_parent_page = buffer_pool_manager_->NewPage(&new_parent_pid, parent->GetPageId());
+      if (new_parent_page == nullptr) {
+        throw std::runtime_error("out of memory");
+      }
+      InternalPage *new_parent = reinterpret_cast<InternalPage *>(new_parent_page->GetData());
+      new_parent->Init(new_parent_pid, INVALID_PAGE_ID, internal_max_size_);
+      // 第一个key即上推的分隔key，与Split后的internal page一致
+      new_parent->Append(separator, new_node->GetPageId());
+      new_node->SetParentPageId(new_parent_pid);
+      BulkAppendSibling(open, level + 1, separator, new_parent_page, internal_fill);
+    }
+  }
+  buffer_pool_manager_->UnpinPage(old_page->GetPageId(), true);
+  (*open)[level] = new_page;
+}
+
+/*
+ * The last node of a level may have gotten only a few entries, or a single
+ * child, which the deletes cannot handle. Share the entries of the node and
+ * its left sibling evenly, or merge the two if they fit into one node. A merge
+ * takes a child from the parent, which is fixed up in turn; a root left with
+ * one child is replaced by it.
+ * open[level + 1] must have at least two children.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::BulkFixRightEdge(std::vector<Page *> *open, size_t level) {
+  auto node = reinterpret_cast<BPlusTreePage *>((*open)[level]->GetData());
+  Page *parent_page = (*open)[level + 1];
+  InternalPage *parent = reinterpret_cast<InternalPage *>(parent_page->GetData());
+  int min_size = node->IsLeafPage() ? node->GetMinSize() : node->GetMinSize() + 1;
+  if (node->GetSize() >= min_size) {
+    return;
+  }
+  int index = parent->GetSize() - 1;
+  Page *neighbor_page = buffer_pool_manager_->FetchPage(parent->ValueAt(index - 1));
+  auto neighbor = reinterpret_cast<BPlusTreePage *>(neighbor_page->GetData());
+  int total = neighbor->GetSize() + node->GetSize();
+  // leaf在size达到max时分裂，internal在超过max时分裂
+  int capacity = node->IsLeafPage() ? node->GetMaxSize() - 1 : node->GetMaxSize();
+
+  if (total > capacity) {
+    // 从左兄弟的末尾借，直到两边各一半
+    if (node->IsLeafPage()) {
+      LeafPage *leaf = reinterpret_cast<LeafPage *>(node);
+      LeafPage *neighbor_leaf = reinterpret_cast<LeafPage *>(neighbor);
+      while (leaf->GetSize() < total / 2) {
+        neighbor_leaf->MoveLastToFrontOf(leaf);
+      }
+      parent->SetKeyAt(index, leaf->KeyAt(0));
+      neighbor_leaf->SetHighKey(leaf->KeyAt(0));
+    } else {
+      InternalPage *internal = reinterpret_cast<InternalPage *>(node);
+      InternalPage *neighbor_internal = reinterpret_cast<InternalPage *>(neighbor);
+      while (internal->GetSize() < total / 2) {
+        neighbor_internal->MoveLastToFrontOf(internal, parent->KeyAt(index), buffer_pool_manager_);
+        parent->SetKeyAt(index, internal->KeyAt(0));
+      }
+      neighbor_internal->SetHighKey(internal->KeyAt(0));
+    }
+    buffer_pool_manager_->UnpinPage(neighbor_page->GetPageId(), true);
+    return;
+  }
+
+  // 并入左兄弟，左兄弟成为这一层最右边的节点
+  if (node->IsLeafPage()) {
+    LeafPage *leaf = reinterpret_cast<LeafPage *>(node);
+    LeafPage *neighbor_leaf = reinterpret_cast<LeafPage *>(neighbor);
+    leaf->MoveAllTo(neighbor_leaf);
+    neighbor_leaf->SetNextPageId(leaf->GetNextPageId());
+    neighbor_leaf->SetHighKey(leaf->GetHighKey());
+  } else {
+    InternalPage *internal = reinterpret_cast<InternalPage *>(node);
+    InternalPage *neighbor_internal = reinterpret_cast<InternalPage *>(neighbor);
+    internal->MoveAllTo(neighbor_internal, parent->KeyAt(index), buffer_pool_manager_);
+    neighbor_internal->SetNextPageId(internal->GetNextPageId());
+    neighbor_internal->SetHighKey(internal->GetHighKey());
+  }
+  parent->Remove(index);
+  page_id_t node_pid = node->GetPageId();
+  buffer_pool_manager_->UnpinPage(node_pid, true);
+  buffer_pool_manager_->DeletePage(node_pid);
+  (*open)[level] = neighbor_page;
+
+  if (level + 2 < open->size()) {
+    BulkFixRightEdge(open, level + 1);
+  } else if (parent->GetSize() == 1) {
+    // the root is left with a single child
+    root_page_id_ = neighbor->GetPageId();
+    UpdateRootPageId(0);
+    neighbor->SetParentPageId(INVALID_PAGE_ID);
+    page_id_t parent_pid = parent->GetPageId();
+    buffer_pool_manager_->UnpinPage(parent_pid, true);
+    buffer_pool_manager_->DeletePage(parent_pid);
+    open->pop_back();
+  }
+}
+
 /*****************************************************************************
  * REMOVE
  *****************************************************************************/
+/*
+ * Drop the whole tree: the pages go away with the segment file, there is no
+ * need to visit them.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::Drop() {
+  std::scoped_lock lock(root_latch_);
+  if (segment_id_ == INVALID_SEGMENT_ID) {
+    return;
+  }
+  buffer_pool_manager_->DropSegment(segment_id_);
+  segment_id_ = INVALID_SEGMENT_ID;
+  root_page_id_ = INVALID_PAGE_ID;
+  UpdateRootPageId(0);
+}
+
 /*
  * Delete key & value pair associated with input key
  * If current tree is empty, return immdiately.
@@ -319,15 +640,21 @@ void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node, const KeyType &ke
  */
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {
-  root_latch_.lock();
-  // LOG_DEBUG("%s:%d thread %ld root_lock\n", __FILE__, __LINE__, syscall(SYS_gettid));
   if (IsEmpty()) {
-    // LOG_DEBUG("%s:%d thread %ld root_unlock\n", __FILE__, __LINE__, syscall(SYS_gettid));
-    root_latch_.unlock();
     return;
   }
-  // LOG_DEBUG("%s:%d thread %ld root_unlock\n", __FILE__, __LINE__, syscall(SYS_gettid));
-  root_latch_.unlock();
+
+  if (blink_) {
+    // B-link模式下不合并，underfull的leaf留在树里
+    Page *page = FindLeafPageBLink(key, FindOp::None, UsedOp::DELETE);
+    assert(page != nullptr);
+    LeafPage *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    int old_size = leaf->GetSize();
+    bool removed = leaf->RemoveAndDeleteRecord(key, comparator_) != old_size;
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), removed);
+    return;
+  }
 
   Page *leaf_page = nullptr;
   bool root_locked = FindLeafPageEx(&leaf_page, key, FindOp::None, UsedOp::DELETE, transaction);
@@ -344,6 +671,7 @@ void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {
     for (auto item : *transaction->GetPageSet()) {
       // LOG_DEBUG("%s:%d thread %ld Page %d unlock\n", __FILE__, __LINE__, syscall(SYS_gettid), item->GetPageId());
       item->WUnlatch();
+      buffer_pool_manager_->UnpinPage(item->GetPageId(), true);
     }
     transaction->GetPageSet()->clear();
     // LOG_DEBUG("%s:%d thread %ld Page %d unlock\n", __FILE__, __LINE__, syscall(SYS_gettid), leaf_page->GetPageId());
@@ -362,6 +690,7 @@ void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {
   for (auto item : *transaction->GetPageSet()) {
     // LOG_DEBUG("%s:%d thread %ld Page %d unlock\n", __FILE__, __LINE__, syscall(SYS_gettid), item->GetPageId());
     item->WUnlatch();
+    buffer_pool_manager_->UnpinPage(item->GetPageId(), true);
   }
   transaction->GetPageSet()->clear();
   // LOG_DEBUG("%s:%d thread %ld Page %d unlock\n", __FILE__, __LINE__, syscall(SYS_gettid), leaf_page->GetPageId());
@@ -435,11 +764,12 @@ bool BPLUSTREE_TYPE::CoalesceOrRedistribute(N *node, bool *root_locked, Transact
   for (auto item : *transaction->GetPageSet()) {
     // LOG_DEBUG("%s:%d thread %ld Page %d unlock\n", __FILE__, __LINE__, syscall(SYS_gettid), item->GetPageId());
     item->WUnlatch();
+    buffer_pool_manager_->UnpinPage(item->GetPageId(), true);
   }
   transaction->GetPageSet()->clear();
 
+  // neighbor在page set里，已随之unpin
   buffer_pool_manager_->UnpinPage(parent_node->GetPageId(), true);
-  buffer_pool_manager_->UnpinPage(neighbor_node->GetPageId(), true);
 
   return target_be_deleted;
 }
@@ -470,11 +800,13 @@ bool BPLUSTREE_TYPE::Coalesce(N **neighbor_node, N **node,
       // neighbor在node右边
       leaf_neighbor_node->MoveAllTo(leaf_node);
       leaf_node->SetNextPageId(leaf_neighbor_node->GetNextPageId());
+      leaf_node->SetHighKey(leaf_neighbor_node->GetHighKey());
       (*parent)->Remove(1);
     } else {
       // neighbor在node左边
       leaf_node->MoveAllTo(leaf_neighbor_node);
       leaf_neighbor_node->SetNextPageId(leaf_node->GetNextPageId());
+      leaf_neighbor_node->SetHighKey(leaf_node->GetHighKey());
       (*parent)->Remove(index);
     }
 
@@ -484,10 +816,14 @@ bool BPLUSTREE_TYPE::Coalesce(N **neighbor_node, N **node,
     if (index == 0) {
       // neighbor在node右边
       internal_neighbor_node->MoveAllTo(internal_node, (*parent)->KeyAt(1), buffer_pool_manager_);
+      internal_node->SetNextPageId(internal_neighbor_node->GetNextPageId());
+      internal_node->SetHighKey(internal_neighbor_node->GetHighKey());
       (*parent)->Remove(1);
     } else {
       // neighbor在node左边
       internal_node->MoveAllTo(internal_neighbor_node, (*parent)->KeyAt(index), buffer_pool_manager_);
+      internal_neighbor_node->SetNextPageId(internal_node->GetNextPageId());
+      internal_neighbor_node->SetHighKey(internal_node->GetHighKey());
       (*parent)->Remove(index);
     }
   }
@@ -521,9 +857,11 @@ void BPLUSTREE_TYPE::Redistribute(N *neighbor_node, N *node, int index, bool *ro
       // change parent keys
       // node是第一个node所以只能向右兄弟拿
       p_node->SetKeyAt(1, neighbor_leaf->KeyAt(0));
+      node_leaf->SetHighKey(neighbor_leaf->KeyAt(0));
     } else {
       neighbor_leaf->MoveLastToFrontOf(node_leaf);
       p_node->SetKeyAt(index, node_leaf->KeyAt(0));
+      neighbor_leaf->SetHighKey(node_leaf->KeyAt(0));
     }
   } else {
     InternalPage *node_internal = reinterpret_cast<InternalPage *>(node);
@@ -531,9 +869,11 @@ void BPLUSTREE_TYPE::Redistribute(N *neighbor_node, N *node, int index, bool *ro
     if (index == 0) {
       neighbor_internal->MoveFirstToEndOf(node_internal, p_node->KeyAt(1), buffer_pool_manager_);
       p_node->SetKeyAt(1, neighbor_internal->KeyAt(0));
+      node_internal->SetHighKey(neighbor_internal->KeyAt(0));
     } else {
       neighbor_internal->MoveLastToFrontOf(node_internal, p_node->KeyAt(index), buffer_pool_manager_);
       p_node->SetKeyAt(index, node_internal->KeyAt(0));
+      neighbor_internal->SetHighKey(node_internal->KeyAt(0));
     }
   }
 
@@ -545,6 +885,7 @@ void BPLUSTREE_TYPE::Redistribute(N *neighbor_node, N *node, int index, bool *ro
   for (auto item : *transaction->GetPageSet()) {
     // LOG_DEBUG("%s:%d thread %ld Page %d unlock\n", __FILE__, __LINE__, syscall(SYS_gettid), item->GetPageId());
     item->WUnlatch();
+    buffer_pool_manager_->UnpinPage(item->GetPageId(), true);
   }
   transaction->GetPageSet()->clear();
 
@@ -573,6 +914,7 @@ bool BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root_node) {
     Page *new_root_page = buffer_pool_manager_->FetchPage(new_root_pid);
     InternalPage *new_root_internal = reinterpret_cast<InternalPage *>(new_root_page->GetData());
     new_root_internal->SetParentPageId(INVALID_PAGE_ID);
+    buffer_pool_manager_->UnpinPage(new_root_pid, true);
 
     return true;
   }
@@ -654,6 +996,34 @@ INDEX_TEMPLATE_ARGUMENTS
 bool BPLUSTREE_TYPE::FindLeafPageEx(Page **out_page, const KeyType &key, FindOp op, UsedOp used_op,
                                     Transaction *transaction) {
   // throw Exception(ExceptionType::NOT_IMPLEMENTED, "Implement this for test");
+  if (used_op == UsedOp::SEARCH) {
+    for (int attempt = 0; attempt < OPTIMISTIC_SEARCH_ATTEMPTS; attempt++) {
+      if (FindLeafPageOptimistic(out_page, key, op)) {
+        return false;
+      }
+    }
+  }
+  if (blink_) {
+    Page *page = FindLeafPageBLink(key, op, used_op);
+    if (page != nullptr) {
+      *out_page = page;
+    }
+    return false;
+  }
+  if (used_op != UsedOp::SEARCH) {
+    // 只锁leaf：leaf安全时不会分裂或合并，不需要root_latch_和祖先节点的写锁
+    for (int attempt = 0; attempt < OPTIMISTIC_WRITE_ATTEMPTS; attempt++) {
+      Page *page = nullptr;
+      if (FindLeafPageOptimistic(&page, key, op, used_op)) {
+        if (page != nullptr) {
+          *out_page = page;
+          return false;
+        }
+        // empty tree or an unsafe leaf
+        break;
+      }
+    }
+  }
   bool root_locked = true;
   root_latch_.lock();
   // LOG_DEBUG("%s:%d thread %ld root_lock\n", __FILE__, __LINE__, syscall(SYS_gettid));
@@ -663,7 +1033,7 @@ bool BPLUSTREE_TYPE::FindLeafPageEx(Page **out_page, const KeyType &key, FindOp
     return false;
   }
 
-  Page *page = buffer_pool_manager_->FetchPage(root_page_id_);
+  Page *page = FetchRoot(root_page_id_);
   assert(page != nullptr);
   auto node = reinterpret_cast<BPlusTreePage *>(page->GetData());
   // page lock
@@ -684,22 +1054,23 @@ bool BPLUSTREE_TYPE::FindLeafPageEx(Page **out_page, const KeyType &key, FindOp
 
   while (!node->IsLeafPage()) {
     InternalPage *in_node = reinterpret_cast<InternalPage *>(node);
-    auto next_pid = INVALID_PAGE_ID;
+    int next_index;
     // 查找leaf方式
     switch (op) {
       case FindOp::None:
-        next_pid = in_node->Lookup(key, comparator_);
+        next_index = in_node->LookupIndex(key, comparator_);
         break;
       case FindOp::LeftMost:
-        next_pid = in_node->ValueAt(0);
+        next_index = 0;
         break;
       case FindOp::RightMost:
-        next_pid = in_node->ValueAt(in_node->GetSize() - 1);
+        next_index = in_node->GetSize() - 1;
         break;
       default:
         throw std::runtime_error("FindLeafPageEx: error enum type");
         break;
     }
+    auto next_pid = in_node->ValueAt(next_index);
     assert(next_pid != INVALID_PAGE_ID);
 
     // buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
@@ -707,7 +1078,7 @@ bool BPLUSTREE_TYPE::FindLeafPageEx(Page **out_page, const KeyType &key, FindOp
     // page = buffer_pool_manager_->FetchPage(next_pid);
     // assert(page != nullptr);
     // node = reinterpret_cast<BPlusTreePage *>(page->GetData());
-    auto child_page = buffer_pool_manager_->FetchPage(next_pid);
+    auto child_page = FetchChild(page, next_index, next_pid);
     auto child_node = reinterpret_cast<BPlusTreePage *>(child_page->GetData());
 
     if (used_op == UsedOp::SEARCH) {
@@ -742,6 +1113,230 @@ bool BPLUSTREE_TYPE::FindLeafPageEx(Page **out_page, const KeyType &key, FindOp
   return root_locked;
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::FindLeafPageOptimistic(Page **out_page, const KeyType &key, FindOp op, UsedOp used_op) {
+  page_id_t root_id = root_page_id_;
+  if (root_id == INVALID_PAGE_ID) {
+    *out_page = nullptr;
+    return true;
+  }
+  Page *page = FetchRoot(root_id);
+  assert(page != nullptr);
+  uint64_t version;
+  // The root id is read again after the root's version is taken: if the page still is the root then, a root split
+  // or collapse afterwards writes it and fails the validation.
+  bool readable = page->TryOptimisticRead(&version) && root_page_id_ == root_id;
+  if (!readable) {
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    return false;
+  }
+
+  while (true) {
+    auto node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    bool is_leaf = node->IsLeafPage();
+    // A split of this node that raced with the descent moved the key to the right sibling. Nothing read from the
+    // page is used before it is validated: a torn high key or size could send the reads below out of the frame.
+    KeyType high_key;
+    page_id_t next_link = ReadRightLink(node, &high_key);
+    int size = node->GetSize();
+    if (!page->ValidateRead(version)) {
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+      return false;
+    }
+    // a page that was freed and reused since its parent pointed here validates too, keep its size within the frame
+    size = std::clamp(size, 1, static_cast<int>(INTERNAL_PAGE_CAPACITY));
+    page_id_t right_pid = MoveRightTo(next_link, high_key, key, op);
+    if (is_leaf && right_pid == INVALID_PAGE_ID && used_op != UsedOp::SEARCH) {
+      // Unchanged since the parent pointed here, so it is still the right leaf.
+      if (!page->TryUpgradeToWLatch(version)) {
+        buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+        return false;
+      }
+      if (!IsSafe(node, used_op)) {
+        page->WUnlatch();
+        buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+        *out_page = nullptr;
+        return true;
+      }
+      *out_page = page;
+      return true;
+    }
+    if (is_leaf && right_pid == INVALID_PAGE_ID) {
+      // Unchanged since the parent pointed here, so it is still the right leaf.
+      page->RLatch();
+      if (!page->ValidateRead(version)) {
+        page->RUnlatch();
+        buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+        return false;
+      }
+      *out_page = page;
+      return true;
+    }
+
+    Page *child_page;
+    if (right_pid != INVALID_PAGE_ID) {
+      child_page = buffer_pool_manager_->FetchPage(right_pid);
+    } else {
+      InternalPage *in_node = reinterpret_cast<InternalPage *>(node);
+      int next_index;
+      switch (op) {
+        case FindOp::LeftMost:
+          next_index = 0;
+          break;
+        case FindOp::RightMost:
+          next_index = size - 1;
+          break;
+        default:
+          next_index = in_node->LookupIndex(key, comparator_, size);
+          break;
+      }
+      page_id_t next_pid = in_node->ValueAt(next_index);
+      // next_pid may be garbage read from a half written page, check before following it.
+      if (!page->ValidateRead(version)) {
+        buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+        return false;
+      }
+      child_page = FetchChild(page, next_index, next_pid);
+    }
+    assert(child_page != nullptr);
+    uint64_t child_version;
+    // The parent is validated again after the child's version is taken: a split or merge of the child in between
+    // would have written the parent.
+    bool valid = child_page->TryOptimisticRead(&child_version) && page->ValidateRead(version);
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    if (!valid) {
+      buffer_pool_manager_->UnpinPage(child_page->GetPageId(), false);
+      return false;
+    }
+    page = child_page;
+    version = child_version;
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::FindLeafPageBLink(const KeyType &key, FindOp op, UsedOp used_op) {
+  page_id_t root_id = root_page_id_;
+  if (root_id == INVALID_PAGE_ID) {
+    return nullptr;
+  }
+  Page *page = FetchRoot(root_id);
+  assert(page != nullptr);
+  // The root may split before it is latched, its old page then keeps the left half and a right link.
+  page->RLatch();
+  bool exclusive = false;
+  while (true) {
+    auto node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    if (node->IsLeafPage() && used_op != UsedOp::SEARCH && !exclusive) {
+      // a leaf stays a leaf, but it may split before the write latch is granted
+      page->RUnlatch();
+      page->WLatch();
+      exclusive = true;
+      continue;
+    }
+    Page *next_page;
+    page_id_t right_pid = MoveRightTo(node, key, op);
+    if (right_pid != INVALID_PAGE_ID) {
+      next_page = buffer_pool_manager_->FetchPage(right_pid);
+    } else if (node->IsLeafPage()) {
+      return page;
+    } else {
+      InternalPage *in_node = reinterpret_cast<InternalPage *>(node);
+      int next_index;
+      switch (op) {
+        case FindOp::LeftMost:
+          next_index = 0;
+          break;
+        case FindOp::RightMost:
+          next_index = in_node->GetSize() - 1;
+          break;
+        default:
+          next_index = in_node->LookupIndex(key, comparator_);
+          break;
+      }
+      next_page = FetchChild(page, next_index, in_node->ValueAt(next_index));
+    }
+    assert(next_page != nullptr);
+    // 先放开当前节点再latch下一个节点，同一时刻只持有一个latch
+    if (exclusive) {
+      page->WUnlatch();
+    } else {
+      page->RUnlatch();
+    }
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    page = next_page;
+    if (exclusive) {
+      // moving right along the leaves
+      page->WLatch();
+    } else {
+      page->RLatch();
+    }
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+page_id_t BPLUSTREE_TYPE::MoveRightTo(BPlusTreePage *node, const KeyType &key, FindOp op) const {
+  KeyType high_key;
+  page_id_t next_pid = ReadRightLink(node, &high_key);
+  return MoveRightTo(next_pid, high_key, key, op);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+page_id_t BPLUSTREE_TYPE::ReadRightLink(BPlusTreePage *node, KeyType *high_key) const {
+  if (node->IsLeafPage()) {
+    auto leaf = reinterpret_cast<LeafPage *>(node);
+    *high_key = leaf->GetHighKey();
+    return leaf->GetNextPageId();
+  }
+  auto in_node = reinterpret_cast<InternalPage *>(node);
+  *high_key = in_node->GetHighKey();
+  return in_node->GetNextPageId();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+page_id_t BPLUSTREE_TYPE::MoveRightTo(page_id_t next_pid, const KeyType &high_key, const KeyType &key,
+                                      FindOp op) const {
+  if (next_pid == INVALID_PAGE_ID) {
+    return INVALID_PAGE_ID;
+  }
+  switch (op) {
+    case FindOp::LeftMost:
+      return INVALID_PAGE_ID;
+    case FindOp::RightMost:
+      return next_pid;
+    default:
+      return comparator_(key, high_key) >= 0 ? next_pid : INVALID_PAGE_ID;
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::FetchRoot(page_id_t root_id) {
+  Page *frame = root_frame_;
+  Page *page = frame == nullptr ? nullptr : buffer_pool_manager_->FetchSwizzledPage(frame, root_id);
+  if (page == nullptr) {
+    page = buffer_pool_manager_->FetchPage(root_id);
+    root_frame_ = page;
+  }
+  return page;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::FetchChild(Page *parent_page, int index, page_id_t child_id) {
+  // A node holds at most internal_max_size_ + 1 children while it waits to be split.
+  SwipArray *swips = parent_page->GetSwips(internal_max_size_ + 2);
+  if (index < 0 || static_cast<size_t>(index) >= swips->size()) {
+    return buffer_pool_manager_->FetchPage(child_id);
+  }
+  // The slot is only a hint: after a split or merge it may point at the frame of a former child, which
+  // FetchSwizzledPage rejects by its page id.
+  Page *frame = (*swips)[index].load(std::memory_order_relaxed);
+  Page *page = frame == nullptr ? nullptr : buffer_pool_manager_->FetchSwizzledPage(frame, child_id);
+  if (page == nullptr) {
+    page = buffer_pool_manager_->FetchPage(child_id);
+    (*swips)[index].store(page, std::memory_order_relaxed);
+  }
+  return page;
+}
+
 /*
 Search: Starting with root page, grab read (R) latch on child Then release latch on parent as soon as you land on the
 child page.
@@ -9,6 +9,14 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <cstdio>
+#include <deque>
+#include <future>  // NOLINT
+#include <queue>
+
+#include "buffer/buffer_access_strategy.h"
+#include "common/exception.h"
 #include "storage/index/b_plus_tree_index.h"
 
 namespace bustub {
@@ -25,7 +33,7 @@ INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid, Transaction *transaction) {
   // construct insert index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  index_key.SetFromKey(key, *GetKeySchema());
 
   container_.Insert(index_key, rid, transaction);
 }
@@ -34,7 +42,7 @@ INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) {
   // construct delete index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  index_key.SetFromKey(key, *GetKeySchema());
 
   container_.Remove(index_key, transaction);
 }
@@ -43,11 +51,104 @@ INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) {
   // construct scan index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  index_key.SetFromKey(key, *GetKeySchema());
 
   container_.GetValue(index_key, result, transaction);
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_INDEX_TYPE::BulkBuild(TableHeap *table_heap, const Schema &tuple_schema, Transaction *transaction,
+                                     double fill_factor, size_t run_size, size_t num_threads) {
+  if (!container_.IsEmpty()) {
+    return false;
+  }
+  run_size = std::max<size_t>(run_size, 1);
+  num_threads = std::max<size_t>(num_threads, 1);
+  auto less = [this](const MappingType &a, const MappingType &b) { return comparator_(a.first, b.first) < 0; };
+  // 排序后写入一个临时文件，关闭时自动删除
+  auto sort_run = [less](std::vector<MappingType> run) {
+    std::stable_sort(run.begin(), run.end(), less);
+    std::FILE *file = std::tmpfile();
+    if (file == nullptr || std::fwrite(run.data(), sizeof(MappingType), run.size(), file) != run.size()) {
+      throw Exception("BulkBuild: cannot spill a sorted run");
+    }
+    std::rewind(file);
+    return file;
+  };
+
+  // 1. scan the table, the runs are sorted in the background meanwhile
+  std::vector<MappingType> run;
+  std::deque<std::future<std::FILE *>> sorting;
+  std::vector<std::FILE *> runs;
+  BufferAccessStrategy strategy;
+  for (auto iterator = table_heap->Begin(transaction, &strategy); iterator != table_heap->End(); ++iterator) {
+    KeyType index_key;
+    index_key.SetFromKey(iterator->KeyFromTuple(tuple_schema, *GetKeySchema(), GetKeyAttrs()), *GetKeySchema());
+    run.emplace_back(index_key, iterator->GetRid());
+    if (run.size() < run_size) {
+      continue;
+    }
+    if (sorting.size() == num_threads) {
+      runs.push_back(sorting.front().get());
+      sorting.pop_front();
+    }
+    sorting.push_back(std::async(std::launch::async, sort_run, std::move(run)));
+    run = std::vector<MappingType>();
+  }
+  for (auto &future : sorting) {
+    runs.push_back(future.get());
+  }
+
+  // 2. merge the runs, the last one stays in memory
+  std::stable_sort(run.begin(), run.end(), less);
+  size_t run_cursor = 0;
+  // (entry, run index), run index runs.size() is the one in memory
+  using RunHead = std::pair<MappingType, size_t>;
+  // 相同的key先出早扫描到的run，保留第一次出现的RID
+  auto greater = [this](const RunHead &a, const RunHead &b) {
+    int order = comparator_(a.first.first, b.first.first);
+    return order > 0 || (order == 0 && a.second > b.second);
+  };
+  std::priority_queue<RunHead, std::vector<RunHead>, decltype(greater)> heads(greater);
+  auto advance = [&](size_t index) {
+    MappingType entry;
+    if (index == runs.size()) {
+      if (run_cursor < run.size()) {
+        heads.emplace(run[run_cursor++], index);
+      }
+    } else if (std::fread(&entry, sizeof(MappingType), 1, runs[index]) == 1) {
+      heads.emplace(entry, index);
+    }
+  };
+  for (size_t i = 0; i <= runs.size(); i++) {
+    advance(i);
+  }
+  bool has_last = false;
+  KeyType last_key;
+  bool loaded = container_.BulkLoad(
+      [&](KeyType *key, ValueType *value) {
+        while (!heads.empty()) {
+          RunHead head = heads.top();
+          heads.pop();
+          advance(head.second);
+          if (has_last && comparator_(head.first.first, last_key) == 0) {
+            continue;
+          }
+          has_last = true;
+          last_key = head.first.first;
+          *key = head.first.first;
+          *value = head.first.second;
+          return true;
+        }
+        return false;
+      },
+      fill_factor);
+  for (auto file : runs) {
+    std::fclose(file);
+  }
+  return loaded;
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE BPLUSTREE_INDEX_TYPE::GetBeginIterator() { return container_.begin(); }
 
@@ -18,6 +18,7 @@ INDEXITERATOR_TYPE::IndexIterator(Page *page, int index, BufferPoolManager *buff
   node_ = reinterpret_cast<LeafPage *>(page->GetData());
   index_ = index;
   buffer_manager_ = buffer_manager;
+  SkipExhaustedPages();
 }
 
 INDEX_TEMPLATE_ARGUMENTS
@@ -35,8 +36,14 @@ const MappingType &INDEXITERATOR_TYPE::operator*() { return node_->GetItem(index
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE &INDEXITERATOR_TYPE::operator++() {
   index_++;
-  // 获取下一页
-  if (index_ >= node_->GetSize() && node_->GetNextPageId() != INVALID_PAGE_ID) {
+  SkipExhaustedPages();
+  return *this;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::SkipExhaustedPages() {
+  // 获取下一页，B-link模式下删除不合并，中间可能有空的leaf
+  while (index_ >= node_->GetSize() && node_->GetNextPageId() != INVALID_PAGE_ID) {
     auto next_page = buffer_manager_->FetchPage(node_->GetNextPageId());
     LeafPage *next_node = reinterpret_cast<LeafPage *>(next_page->GetData());
     next_page->RLatch();
@@ -48,7 +55,6 @@ INDEXITERATOR_TYPE &INDEXITERATOR_TYPE::operator++() {
     node_ = next_node;
     index_ = 0;
   }
-  return *this;
 }
 
 template class IndexIterator<GenericKey<4>, RID, GenericComparator<4>>;
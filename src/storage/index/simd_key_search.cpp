@@ -0,0 +1,98 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// simd_key_search.cpp
+//
+// Identification: src/storage/index/simd_key_search.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstring>
+
+#if defined(__AVX2__) || defined(__SSE4_2__)
+#include <immintrin.h>
+#endif
+
+#include "storage/index/simd_key_search.h"
+
+namespace bustub {
+
+namespace {
+// KeyNormalizer::LoadPrefix, spelled out for builds that do not inline
+inline uint64_t KeyAt(const char *base, size_t stride, int index) {
+  uint64_t raw;
+  memcpy(&raw, base + index * stride, sizeof(uint64_t));
+  return __builtin_bswap64(raw);
+}
+
+inline bool IsBefore(uint64_t key_at, uint64_t key, bool upper) { return upper ? key_at <= key : key_at < key; }
+}  // namespace
+
+int SimdKeySearch::LowerBound(const char *base, size_t stride, int count, uint64_t key) {
+  return Search(base, stride, count, key, false);
+}
+
+int SimdKeySearch::UpperBound(const char *base, size_t stride, int count, uint64_t key) {
+  return Search(base, stride, count, key, true);
+}
+
+int SimdKeySearch::Search(const char *base, size_t stride, int count, uint64_t key, bool upper) {
+  int left = 0;
+  while (count > SEARCH_WINDOW) {
+    int half = count / 2;
+    uint64_t key_at = KeyAt(base, stride, left + half);
+    if (upper ? key_at <= key : key_at < key) {
+      left += half + 1;
+      count -= half + 1;
+    } else {
+      count = half;
+    }
+  }
+  return left + CountBefore(base + left * stride, stride, count, key, upper);
+}
+
+int SimdKeySearch::CountBefore(const char *base, size_t stride, int count, uint64_t key, bool upper) {
+  int before = 0;
+  int i = 0;
+#if defined(__AVX2__) || defined(__SSE4_2__)
+  // 有符号比较：把无符号数的符号位翻转
+  const int64_t sign = INT64_MIN;
+  // reverses the bytes of each 64-bit lane
+  const __m128i swap = _mm_set_epi8(8, 9, 10, 11, 12, 13, 14, 15, 0, 1, 2, 3, 4, 5, 6, 7);
+#endif
+#ifdef __AVX2__
+  const __m256i swap4 = _mm256_broadcastsi128_si256(swap);
+  const __m256i sign4 = _mm256_set1_epi64x(sign);
+  const __m256i key4 = _mm256_set1_epi64x(static_cast<int64_t>(key) ^ sign);
+  const auto s = static_cast<int64_t>(stride);
+  const __m256i offsets = _mm256_set_epi64x(3 * s, 2 * s, s, 0);
+  for (; i + 4 <= count; i += 4) {
+    __m256i keys = _mm256_i64gather_epi64(reinterpret_cast<const long long *>(base + i * stride),  // NOLINT
+                                          offsets, 1);
+    keys = _mm256_xor_si256(_mm256_shuffle_epi8(keys, swap4), sign4);
+    // lower: key > keys[j], upper: not keys[j] > key
+    __m256i greater = upper ? _mm256_cmpgt_epi64(keys, key4) : _mm256_cmpgt_epi64(key4, keys);
+    int matches = __builtin_popcount(_mm256_movemask_pd(_mm256_castsi256_pd(greater)));
+    before += upper ? 4 - matches : matches;
+  }
+#endif
+#ifdef __SSE4_2__
+  const __m128i sign2 = _mm_set1_epi64x(sign);
+  const __m128i key2 = _mm_set1_epi64x(static_cast<int64_t>(key) ^ sign);
+  for (; i + 2 <= count; i += 2) {
+    __m128i keys = _mm_unpacklo_epi64(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(base + i * stride)),
+                                      _mm_loadl_epi64(reinterpret_cast<const __m128i *>(base + (i + 1) * stride)));
+    keys = _mm_xor_si128(_mm_shuffle_epi8(keys, swap), sign2);
+    __m128i greater = upper ? _mm_cmpgt_epi64(keys, key2) : _mm_cmpgt_epi64(key2, keys);
+    int matches = __builtin_popcount(_mm_movemask_pd(_mm_castsi128_pd(greater)));
+    before += upper ? 2 - matches : matches;
+  }
+#endif
+  for (; i < count; i++) {
+    before += IsBefore(KeyAt(base, stride, i), key, upper) ? 1 : 0;
+  }
+  return before;
+}
+
+}  // namespace bustub
@@ -13,6 +13,7 @@
 #include <sstream>
 
 #include "common/exception.h"
+#include "storage/index/simd_key_search.h"
 #include "storage/page/b_plus_tree_internal_page.h"
 
 namespace bustub {
@@ -30,8 +31,25 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id
   SetSize(0);
   SetPageId(page_id);
   SetParentPageId(parent_id);
+  SetNextPageId(INVALID_PAGE_ID);
   SetMaxSize(max_size);
 }
+
+/**
+ * Helper methods to set/get the right sibling and the high key, an exclusive
+ * upper bound of the keys in the subtree
+ */
+INDEX_TEMPLATE_ARGUMENTS
+page_id_t B_PLUS_TREE_INTERNAL_PAGE_TYPE::GetNextPageId() const { return next_page_id_; }
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
+
+INDEX_TEMPLATE_ARGUMENTS
+KeyType B_PLUS_TREE_INTERNAL_PAGE_TYPE::GetHighKey() const { return high_key_; }
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetHighKey(const KeyType &key) { high_key_ = key; }
 /*
  * Helper method to get/set the key associated with input "index"(a.k.a
  * array offset)
@@ -76,10 +94,28 @@ ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueAt(int index) const { return arra
  */
 INDEX_TEMPLATE_ARGUMENTS
 ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::Lookup(const KeyType &key, const KeyComparator &comparator) const {
+  return ValueAt(LookupIndex(key, comparator));
+}
+
+/*
+ * Same as Lookup, but returns the index of the child pointer instead of the pointer itself
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_INTERNAL_PAGE_TYPE::LookupIndex(const KeyType &key, const KeyComparator &comparator) const {
+  return LookupIndex(key, comparator, GetSize());
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_INTERNAL_PAGE_TYPE::LookupIndex(const KeyType &key, const KeyComparator &comparator, int size) const {
   // 找到比key更大的key index
-  assert(GetSize() > 0);
+  assert(size > 0);
+  if (comparator.IsUInt64Ordered()) {
+    // 第一个key无效，从第二个开始找
+    return SimdKeySearch::UpperBound(reinterpret_cast<const char *>(&array[1]), sizeof(MappingType), size - 1,
+                                     KeyNormalizer::LoadPrefix(key.data_));
+  }
   int left = 1;
-  int right = GetSize() - 1;
+  int right = size - 1;
   while (left <= right) {
     int mid = left + (right - left) / 2;
     if (comparator(KeyAt(mid), key) > 0) {
@@ -89,7 +125,7 @@ ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::Lookup(const KeyType &key, const KeyCo
     }
   }
 
-  return ValueAt(left - 1);
+  return left - 1;
 }
 
 /*****************************************************************************
@@ -110,6 +146,18 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::PopulateNewRoot(const ValueType &old_value,
   // 算上无效的第一个key
   SetSize(2);
 }
+/*
+ * Append new_key & new_value pair as the last child, for bulk loading. The
+ * first pair appended to an empty page only contributes its value.
+ * @return:  new size after append
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_INTERNAL_PAGE_TYPE::Append(const KeyType &new_key, const ValueType &new_value) {
+  array[GetSize()] = MappingType(new_key, new_value);
+  IncreaseSize(1);
+  return GetSize();
+}
+
 /* 插入到old_value之后
  * Insert new_key & new_value pair right after the pair with its value ==
  * old_value
@@ -14,6 +14,7 @@
 #include "common/exception.h"
 #include "common/logger.h"
 #include "common/rid.h"
+#include "storage/index/simd_key_search.h"
 #include "storage/page/b_plus_tree_leaf_page.h"
 
 namespace bustub {
@@ -46,12 +47,25 @@ page_id_t B_PLUS_TREE_LEAF_PAGE_TYPE::GetNextPageId() const { return next_page_i
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
 
+/**
+ * Helper methods to set/get the high key, an exclusive upper bound of the keys in the page
+ */
+INDEX_TEMPLATE_ARGUMENTS
+KeyType B_PLUS_TREE_LEAF_PAGE_TYPE::GetHighKey() const { return high_key_; }
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::SetHighKey(const KeyType &key) { high_key_ = key; }
+
 /** 查找第一个大于等于key的index
  * Helper method to find the first index i so that array[i].first >= key
  * NOTE: This method is only used when generating index iterator
  */
 INDEX_TEMPLATE_ARGUMENTS
 int B_PLUS_TREE_LEAF_PAGE_TYPE::KeyIndex(const KeyType &key, const KeyComparator &comparator) const {
+  if (comparator.IsUInt64Ordered()) {
+    return SimdKeySearch::LowerBound(reinterpret_cast<const char *>(array), sizeof(MappingType), GetSize(),
+                                     KeyNormalizer::LoadPrefix(key.data_));
+  }
   int left = 0;
   int right = GetSize() - 1;
   while (left <= right) {
@@ -109,6 +123,18 @@ int B_PLUS_TREE_LEAF_PAGE_TYPE::Insert(const KeyType &key, const ValueType &valu
   return GetSize();
 }
 
+/*
+ * Append key & value pair behind the last pair, for bulk loading. key must be
+ * greater than every key in the page.
+ * @return  page size after append
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_LEAF_PAGE_TYPE::Append(const KeyType &key, const ValueType &value) {
+  array[GetSize()] = MappingType(key, value);
+  IncreaseSize(1);
+  return GetSize();
+}
+
 /*****************************************************************************
  * SPLIT
  *****************************************************************************/
@@ -10,7 +10,10 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <cassert>
+#include <memory>
+#include <vector>
 
 #include "common/logger.h"
 #include "storage/table/table_heap.h"
@@ -22,27 +25,32 @@ TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_m
     : buffer_pool_manager_(buffer_pool_manager),
       lock_manager_(lock_manager),
       log_manager_(log_manager),
-      first_page_id_(first_page_id) {}
+      first_page_id_(first_page_id) {
+  RecordNextPage(INVALID_PAGE_ID, first_page_id_);
+}
 
 TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_manager, LogManager *log_manager,
                      Transaction *txn)
     : buffer_pool_manager_(buffer_pool_manager), lock_manager_(lock_manager), log_manager_(log_manager) {
-  // Initialize the first table page.
-  auto first_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->NewPage(&first_page_id_));
+  // Initialize the first table page, in a segment file of the table's own.
+  segment_id_t segment_id = buffer_pool_manager_->CreateSegment();
+  auto first_page = reinterpret_cast<TablePage *>(
+      buffer_pool_manager_->NewPage(&first_page_id_, DiskManager::MakePageId(segment_id, 0)));
   BUSTUB_ASSERT(first_page != nullptr, "Couldn't create a page for the table heap.");
   first_page->WLatch();
   first_page->Init(first_page_id_, PAGE_SIZE, INVALID_LSN, log_manager_, txn);
   first_page->WUnlatch();
   buffer_pool_manager_->UnpinPage(first_page_id_, true);
+  RecordNextPage(INVALID_PAGE_ID, first_page_id_);
 }
 
-bool TableHeap::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn) {
+bool TableHeap::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn, BufferAccessStrategy *strategy) {
   if (tuple.size_ + 32 > PAGE_SIZE) {  // larger than one page size
     txn->SetState(TransactionState::ABORTED);
     return false;
   }
 
-  auto cur_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(first_page_id_));
+  auto cur_page = static_cast<TablePage *>(FetchPage(first_page_id_, strategy));
   if (cur_page == nullptr) {
     txn->SetState(TransactionState::ABORTED);
     return false;
@@ -58,12 +66,13 @@ bool TableHeap::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn) {
       // Unlatch and unpin the current page.
       cur_page->WUnlatch();
       buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), false);
+      RecordNextPage(cur_page->GetTablePageId(), next_page_id);
       // And repeat the process with the next page.
-      cur_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(next_page_id));
+      cur_page = static_cast<TablePage *>(FetchPage(next_page_id, strategy));
       cur_page->WLatch();
     } else {
       // Otherwise we have run out of valid pages. We need to create a new page.
-      auto new_page = static_cast<TablePage *>(buffer_pool_manager_->NewPage(&next_page_id));
+      auto new_page = static_cast<TablePage *>(NewPage(&next_page_id, cur_page->GetTablePageId(), strategy));
       // If we could not create a new page,
       if (new_page == nullptr) {
         // Then life sucks and we abort the transaction.
@@ -78,6 +87,7 @@ bool TableHeap::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn) {
       new_page->Init(next_page_id, PAGE_SIZE, cur_page->GetTablePageId(), log_manager_, txn);
       cur_page->WUnlatch();
       buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), true);
+      RecordNextPage(cur_page->GetTablePageId(), next_page_id);
       cur_page = new_page;
     }
   }
@@ -90,6 +100,25 @@ bool TableHeap::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn) {
   return true;
 }
 
+void TableHeap::Drop() {
+  segment_id_t segment_id = DiskManager::SegmentOf(first_page_id_);
+  if (segment_id != 0) {
+    buffer_pool_manager_->DropSegment(segment_id);
+  } else {
+    // a table of the shared db file gives its pages back one by one
+    for (auto page_id = first_page_id_; page_id != INVALID_PAGE_ID;) {
+      auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+      auto next_page_id = page->GetNextPageId();
+      buffer_pool_manager_->UnpinPage(page_id, false);
+      buffer_pool_manager_->DeletePage(page_id);
+      page_id = next_page_id;
+    }
+  }
+  first_page_id_ = INVALID_PAGE_ID;
+  page_directory_.clear();
+  page_index_.clear();
+}
+
 bool TableHeap::MarkDelete(const RID &rid, Transaction *txn) {
   // TODO(Amadou): remove empty page
   // Find the page which contains the tuple.
@@ -153,9 +182,9 @@ void TableHeap::RollbackDelete(const RID &rid, Transaction *txn) {
   buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
 }
 
-bool TableHeap::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn) {
+bool TableHeap::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, BufferAccessStrategy *strategy) {
   // Find the page which contains the tuple.
-  auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
+  auto page = static_cast<TablePage *>(FetchPage(rid.GetPageId(), strategy));
   // If the page could not be found, then abort the transaction.
   if (page == nullptr) {
     txn->SetState(TransactionState::ABORTED);
@@ -169,16 +198,18 @@ bool TableHeap::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn) {
   return res;
 }
 
-TableIterator TableHeap::Begin(Transaction *txn) {
+TableIterator TableHeap::Begin(Transaction *txn, BufferAccessStrategy *strategy) {
   // Start an iterator from the first page.
   // TODO(Wuwen): Hacky fix for now. Removing empty pages is a better way to handle this.
   RID rid;
   auto page_id = first_page_id_;
   while (page_id != INVALID_PAGE_ID) {
-    auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    auto page = static_cast<TablePage *>(FetchPage(page_id, strategy));
     page->RLatch();
     // If this fails because there is no tuple, then RID will be the default-constructed value, which means EOF.
     auto found_tuple = page->GetFirstTupleRid(&rid);
+    // teach the directory the link the scan steps over first, so that its read-ahead has a run to go by
+    RecordNextPage(page_id, page->GetNextPageId());
     page->RUnlatch();
     buffer_pool_manager_->UnpinPage(page_id, false);
     if (found_tuple) {
@@ -186,9 +217,81 @@ TableIterator TableHeap::Begin(Transaction *txn) {
     }
     page_id = page->GetNextPageId();
   }
-  return TableIterator(this, rid, txn);
+  return TableIterator(this, rid, txn, strategy);
+}
+
+std::unique_ptr<BufferAccessStrategy> TableHeap::MakeBulkAccessStrategy() {
+  size_t pool_share = buffer_pool_manager_->GetPoolSize() / BULK_POOL_FRACTION;
+  size_t num_pages;
+  {
+    std::scoped_lock lock(page_directory_latch_);
+    num_pages = page_directory_.size();
+  }
+  if (pool_share == 0 || num_pages <= pool_share) {
+    return nullptr;
+  }
+  return std::make_unique<BufferAccessStrategy>(std::min<size_t>(BULK_RING_SIZE, pool_share));
 }
 
 TableIterator TableHeap::End() { return TableIterator(this, RID(INVALID_PAGE_ID, 0), nullptr); }
 
+Page *TableHeap::FetchPage(page_id_t page_id, BufferAccessStrategy *strategy) {
+  if (strategy != nullptr) {
+    return buffer_pool_manager_->FetchPage(page_id, *strategy);
+  }
+  return buffer_pool_manager_->FetchPage(page_id);
+}
+
+Page *TableHeap::NewPage(page_id_t *page_id, page_id_t hint, BufferAccessStrategy *strategy) {
+  if (strategy != nullptr) {
+    return buffer_pool_manager_->NewPage(page_id, *strategy, hint);
+  }
+  return buffer_pool_manager_->NewPage(page_id, hint);
+}
+
+void TableHeap::RecordNextPage(page_id_t page_id, page_id_t next_page_id) {
+  std::scoped_lock lock(page_directory_latch_);
+  if (next_page_id == INVALID_PAGE_ID) {
+    return;
+  }
+  // INVALID_PAGE_ID as page_id seeds the directory with the first page.
+  if (page_directory_.empty() ? page_id == INVALID_PAGE_ID : page_directory_.back() == page_id) {
+    page_index_[next_page_id] = page_directory_.size();
+    page_directory_.push_back(next_page_id);
+  }
+}
+
+std::vector<page_id_t> TableHeap::ReadAheadPages(page_id_t page_id, size_t window, size_t *read_ahead_end) {
+  std::scoped_lock lock(page_directory_latch_);
+  std::vector<page_id_t> pages;
+  auto iter = page_index_.find(page_id);
+  if (iter == page_index_.end()) {
+    return pages;
+  }
+  size_t index = iter->second;
+  size_t known = page_directory_.size();
+  if (index + 1 < known && page_directory_[index + 1] != page_directory_[index] + 1 && *read_ahead_end > index + 1) {
+    // the chain leaves its run here, pages guessed past this point are likely not the ones that follow
+    *read_ahead_end = index + 1;
+  }
+  size_t begin = std::max(index + 1, *read_ahead_end);
+  size_t end = index + 1 + window;
+  // Past the known part of the chain, guess that it runs on the way it left off. A table allocates its pages one
+  // after the other in its extents, so a chain that was contiguous so far most likely still is.
+  page_id_t last = page_directory_[known - 1];
+  if (known < 2 || last != page_directory_[known - 2] + 1) {
+    end = std::min(end, known);
+  }
+  for (size_t i = begin; i < end; i++) {
+    page_id_t next = i < known ? page_directory_[i] : last + static_cast<page_id_t>(i - known + 1);
+    if (DiskManager::SegmentOf(next) != DiskManager::SegmentOf(last)) {
+      end = i;
+      break;
+    }
+    pages.push_back(next);
+  }
+  *read_ahead_end = std::max(*read_ahead_end, end);
+  return pages;
+}
+
 }  // namespace bustub
@@ -10,10 +10,15 @@
 //
 //===----------------------------------------------------------------------===//
 
-#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
+#include <sys/stat.h>
+#include <atomic>
+#include <chrono>  // NOLINT
 #include <cstdio>
 #include <random>
 #include <string>
+#include <thread>  // NOLINT
+#include <vector>
 #include "gtest/gtest.h"
 #include "include/common/logger.h"  // 日志调试
 
@@ -31,7 +36,7 @@ TEST(BufferPoolManagerTest, BinaryDataTest) {
   std::uniform_int_distribution<char> uniform_dist(0);
 
   auto *disk_manager = new DiskManager(db_name);
-  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
 
   page_id_t page_id_temp;
   auto *page0 = bpm->NewPage(&page_id_temp);  // 需要实现NewPageImpl
@@ -117,7 +122,7 @@ TEST(BufferPoolManagerTest, BinaryDataTest) {
 
   // Shutdown the disk manager and remove the temporary file we created.
   disk_manager->ShutDown();
-  remove("test.db");
+  DiskManager::RemoveFiles("test.db");
 
   delete bpm;
   delete disk_manager;
@@ -130,7 +135,7 @@ TEST(BufferPoolManagerTest, SampleTest) {
   const size_t buffer_pool_size = 10;
 
   auto *disk_manager = new DiskManager(db_name);
-  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
 
   page_id_t page_id_temp;
   auto *page0 = bpm->NewPage(&page_id_temp);
@@ -174,7 +179,649 @@ TEST(BufferPoolManagerTest, SampleTest) {
 
   // Shutdown the disk manager and remove the temporary file we created.
   disk_manager->ShutDown();
-  remove("test.db");
+  DiskManager::RemoveFiles("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+// Concurrent fetchers of an evicted page must all see the data written before the eviction.
+TEST(BufferPoolManagerTest, ConcurrentFetchTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 4;
+  const int num_pages = 16;
+  const int num_threads = 8;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  page_id_t page_id_temp;
+  for (int i = 0; i < num_pages; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([bpm, tid]() {
+      char expected[PAGE_SIZE];
+      for (int round = 0; round < 50; ++round) {
+        page_id_t page_id = (round + tid) % num_pages;
+        auto *page = bpm->FetchPage(page_id);
+        if (page == nullptr) {
+          // all frames are pinned by the other threads
+          continue;
+        }
+        snprintf(expected, PAGE_SIZE, "page %d", page_id);
+        EXPECT_EQ(0, strcmp(page->GetData(), expected));
+        EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  // Shutdown the disk manager and remove the temporary file we created.
+  disk_manager->ShutDown();
+  DiskManager::RemoveFiles("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+// The background writer cleans unpinned dirty pages, so that evicting them later needs no write-back.
+TEST(BufferPoolManagerTest, BackgroundWriterTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // Scenario: keep every frame clean, at most 4 pages per wake-up.
+  bpm->RunBackgroundWriter(1.0, 4);
+  auto all_clean = [bpm, buffer_pool_size]() {
+    for (size_t i = 0; i < buffer_pool_size; ++i) {
+      if (bpm->GetPages()[i].IsDirty()) {
+        return false;
+      }
+    }
+    return true;
+  };
+  for (int i = 0; i < 200 && !all_clean(); ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  bpm->StopBackgroundWriter();
+  ASSERT_TRUE(all_clean());
+
+  // Scenario: evicting the cleaned pages writes nothing but the new pages themselves.
+  int writes = disk_manager->GetNumWrites();
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+  }
+  EXPECT_EQ(writes + static_cast<int>(buffer_pool_size), disk_manager->GetNumWrites());
+
+  // Scenario: pages keep being modified while the writer runs, no modification may get lost.
+  bpm->RunBackgroundWriter(1.0, 4);
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < 4; ++tid) {
+    threads.emplace_back([bpm, tid]() {
+      for (int round = 0; round < 100; ++round) {
+        page_id_t page_id = tid * 5 + round % 5;
+        auto *page = bpm->FetchPage(page_id);
+        if (page == nullptr) {
+          continue;
+        }
+        page->WLatch();
+        snprintf(page->GetData(), PAGE_SIZE, "page %d round %d", page_id, round);
+        page->WUnlatch();
+        EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  bpm->StopBackgroundWriter();
+  char expected[PAGE_SIZE];
+  for (page_id_t page_id = 0; page_id < 20; ++page_id) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(expected, PAGE_SIZE, "page %d round %d", page_id, 95 + page_id % 5);
+    EXPECT_EQ(0, strcmp(page->GetData(), expected));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+
+  // Shutdown the disk manager and remove the temporary file we created.
+  disk_manager->ShutDown();
+  DiskManager::RemoveFiles("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+// A page being deleted while the background writer cleans it must not be handed to a concurrent fetch.
+TEST(BufferPoolManagerTest, DeleteWhileBackgroundWriteTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  page_id_t page_id;
+  auto *page = bpm->NewPage(&page_id);
+  ASSERT_NE(nullptr, page);
+  snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id);
+  EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+
+  // Scenario: the writer takes the read latch for its write, holding the write latch parks it in the middle.
+  page->WLatch();
+  bpm->RunBackgroundWriter(1.0, 4);
+  for (int i = 0; i < 200 && page->IsDirty(); ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  ASSERT_FALSE(page->IsDirty());
+
+  // The delete waits for the write, a fetch meanwhile pins the page and the delete has to give up.
+  bool deleted = true;
+  std::thread deleter([&] { deleted = bpm->DeletePage(page_id); });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_EQ(page, bpm->FetchPage(page_id));
+  page->WUnlatch();
+  deleter.join();
+  bpm->StopBackgroundWriter();
+  EXPECT_FALSE(deleted);
+  EXPECT_EQ(page_id, page->GetPageId());
+  EXPECT_EQ(0, strcmp(page->GetData(), ("page " + std::to_string(page_id)).c_str()));
+  EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  EXPECT_EQ(true, bpm->DeletePage(page_id));
+
+  // Every frame is free again.
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  }
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+
+  // Shutdown the disk manager and remove the temporary file we created.
+  disk_manager->ShutDown();
+  DiskManager::RemoveFiles("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+// Prefetched pages become resident without being pinned.
+TEST(BufferPoolManagerTest, PrefetchTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  page_id_t page_id_temp;
+  for (int i = 0; i < 20; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+  // Pages 10..19 are resident now, 0..9 are not.
+  EXPECT_EQ(nullptr, bpm->FetchResidentPage(0));
+
+  std::vector<page_id_t> page_ids{0, 1, 2, 3, 4};
+  bpm->PrefetchPages(page_ids);
+  for (auto page_id : page_ids) {
+    Page *page = nullptr;
+    for (int i = 0; i < 200 && page == nullptr; ++i) {
+      page = bpm->FetchResidentPage(page_id);
+      if (page == nullptr) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+      }
+    }
+    ASSERT_NE(nullptr, page);
+    // only our own pin
+    EXPECT_EQ(1, page->GetPinCount());
+    char expected[PAGE_SIZE];
+    snprintf(expected, PAGE_SIZE, "page %d", page_id);
+    EXPECT_EQ(0, strcmp(page->GetData(), expected));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+
+  // Scenario: the prefetched pages are unpinned, so all frames can still be handed out.
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  }
+
+  // Shutdown the disk manager and remove the temporary file we created.
+  disk_manager->ShutDown();
+  DiskManager::RemoveFiles("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+// A bulk operation confined to a ring must not evict the pages of the working set.
+TEST(BufferPoolManagerTest, AccessStrategyTest) {
+  const std::string db_name = "test.db";
+  // room for the working set plus the two rings
+  const size_t buffer_pool_size = 12;
+  const int num_hot_pages = 5;
+  const int num_bulk_pages = 50;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  page_id_t page_id_temp;
+  for (int i = 0; i < num_hot_pages; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // Scenario: a bulk load through a ring of 3 frames.
+  BufferAccessStrategy strategy(3);
+  std::vector<page_id_t> bulk_pages;
+  for (int i = 0; i < num_bulk_pages; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp, strategy);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "bulk %d", page_id_temp);
+    bulk_pages.push_back(page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+  // Scenario: a bulk scan of the loaded pages through a new ring.
+  BufferAccessStrategy scan_strategy(3);
+  char expected[PAGE_SIZE];
+  for (auto page_id : bulk_pages) {
+    auto *page = bpm->FetchPage(page_id, scan_strategy);
+    ASSERT_NE(nullptr, page);
+    snprintf(expected, PAGE_SIZE, "bulk %d", page_id);
+    EXPECT_EQ(0, strcmp(page->GetData(), expected));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+  // The working set survived both.
+  for (page_id_t page_id = 0; page_id < num_hot_pages; ++page_id) {
+    auto *page = bpm->FetchResidentPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+
+  // Scenario: the same scan without a ring flushes the working set.
+  for (auto page_id : bulk_pages) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+  for (page_id_t page_id = 0; page_id < num_hot_pages; ++page_id) {
+    EXPECT_EQ(nullptr, bpm->FetchResidentPage(page_id));
+  }
+
+  // Shutdown the disk manager and remove the temporary file we created.
+  disk_manager->ShutDown();
+  DiskManager::RemoveFiles("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+// A ring only recycles the frames it brought its pages into, and not once a caller without the ring used them.
+TEST(BufferPoolManagerTest, AccessStrategyReuseTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 4;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  BufferAccessStrategy strategy(3);
+  std::vector<page_id_t> ring_pages;
+  auto ring_new_page = [&]() {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id, strategy);
+    ASSERT_NE(nullptr, page);
+    ring_pages.push_back(page_id);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  };
+  for (int i = 0; i < 3; ++i) {
+    ring_new_page();
+  }
+
+  // Scenario: the first ring page is used without the ring, it has joined the working set.
+  ASSERT_NE(nullptr, bpm->FetchPage(ring_pages[0]));
+  EXPECT_EQ(true, bpm->UnpinPage(ring_pages[0], false));
+  for (int i = 0; i < 3; ++i) {
+    ring_new_page();
+  }
+  // Its slot took the last free frame, the other two slots recycled their frames.
+  EXPECT_NE(nullptr, bpm->FetchResidentPage(ring_pages[0]));
+  EXPECT_EQ(true, bpm->UnpinPage(ring_pages[0], false));
+  EXPECT_EQ(nullptr, bpm->FetchResidentPage(ring_pages[1]));
+  EXPECT_EQ(nullptr, bpm->FetchResidentPage(ring_pages[2]));
+
+  // Scenario: the ring page of the next slot is deleted, and its id and frame go to a page created without the ring.
+  ASSERT_EQ(true, bpm->DeletePage(ring_pages[3]));
+  page_id_t page_id;
+  Page *page = bpm->NewPage(&page_id);
+  ASSERT_NE(nullptr, page);
+  ASSERT_EQ(ring_pages[3], page_id);
+  snprintf(page->GetData(), PAGE_SIZE, "reused");
+  EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  ring_new_page();
+  EXPECT_EQ(page, bpm->FetchResidentPage(page_id));
+  EXPECT_EQ(0, strcmp(page->GetData(), "reused"));
+  EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+
+  // Shutdown the disk manager and remove the temporary file we created.
+  disk_manager->ShutDown();
+  DiskManager::RemoveFiles("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+// A swizzled reference pins its page without the page table, and stops working once the frame is reused.
+TEST(BufferPoolManagerTest, SwizzledPageTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 3;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  page_id_t page_id;
+  Page *frame = bpm->NewPage(&page_id);
+  ASSERT_NE(nullptr, frame);
+  snprintf(frame->GetData(), PAGE_SIZE, "swizzled");
+  SwipArray *swips = frame->GetSwips(4);
+  EXPECT_EQ(4U, swips->size());
+  EXPECT_EQ(swips, frame->GetSwips(8));
+  EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+
+  // Scenario: the page is still in its frame.
+  EXPECT_EQ(frame, bpm->FetchSwizzledPage(frame, page_id));
+  EXPECT_EQ(1, frame->GetPinCount());
+  EXPECT_EQ(0, strcmp(frame->GetData(), "swizzled"));
+  // a reference to another page is rejected without touching the pin count
+  EXPECT_EQ(nullptr, bpm->FetchSwizzledPage(frame, page_id + 1));
+  EXPECT_EQ(1, frame->GetPinCount());
+  EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+
+  // Scenario: the page is evicted and the frame reused, its swips are dropped with it.
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+  }
+  EXPECT_EQ(nullptr, bpm->FetchSwizzledPage(frame, page_id));
+  EXPECT_NE(frame->GetSwips(2), nullptr);
+  EXPECT_EQ(2U, frame->GetSwips(4)->size());
+
+  // The page comes back through the page table, after which it can be swizzled again.
+  Page *page = bpm->FetchPage(page_id);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(0, strcmp(page->GetData(), "swizzled"));
+  EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  EXPECT_EQ(page, bpm->FetchSwizzledPage(page, page_id));
+  EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  // a pointer outside the pool is never followed
+  Page stray;
+  EXPECT_EQ(nullptr, bpm->FetchSwizzledPage(&stray, page_id));
+
+  // Shutdown the disk manager and remove the temporary file we created.
+  disk_manager->ShutDown();
+  DiskManager::RemoveFiles("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+// The pool grows and shrinks online, a shrink writes back the dirty pages of the dropped frames and waits for pins.
+TEST(BufferPoolManagerTest, ResizeTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 5;
+  const size_t max_pool_size = 16;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, nullptr, ReplacerType::LRU, max_pool_size);
+  EXPECT_EQ(buffer_pool_size, bpm->GetPoolSize());
+  EXPECT_EQ(max_pool_size, bpm->GetMaxPoolSize());
+  EXPECT_FALSE(bpm->Resize(0));
+  EXPECT_FALSE(bpm->Resize(max_pool_size + 1));
+
+  // Scenario: after growing to 10 frames, 10 pages can be pinned at once.
+  page_id_t page_id_temp;
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id_temp);
+    page_ids.push_back(page_id_temp);
+  }
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_TRUE(bpm->Resize(10));
+  EXPECT_EQ(10U, bpm->GetPoolSize());
+  for (size_t i = buffer_pool_size; i < 10; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id_temp);
+    page_ids.push_back(page_id_temp);
+  }
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+
+  // Scenario: a shrink waits until the pages in the dropped frames are unpinned.
+  std::atomic<bool> shrunk{false};
+  std::thread shrinker([bpm, &shrunk]() {
+    EXPECT_TRUE(bpm->Resize(3));
+    shrunk = true;
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_FALSE(shrunk);
+  for (auto page_id : page_ids) {
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+  shrinker.join();
+  EXPECT_EQ(3U, bpm->GetPoolSize());
+
+  // Scenario: the dirty pages were written back, and only 3 frames are left.
+  char expected[PAGE_SIZE];
+  for (auto page_id : page_ids) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(expected, PAGE_SIZE, "page %d", page_id);
+    EXPECT_EQ(0, strcmp(page->GetData(), expected));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_NE(nullptr, bpm->FetchPage(page_ids[i]));
+  }
+  EXPECT_EQ(nullptr, bpm->FetchPage(page_ids[3]));
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(true, bpm->UnpinPage(page_ids[i], false));
+  }
+
+  // Shutdown the disk manager and remove the temporary file we created.
+  disk_manager->ShutDown();
+  DiskManager::RemoveFiles("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+// A shrink stops at a page that stays pinned, the pool keeps the frames up to it and works on with them.
+TEST(BufferPoolManagerTest, ShrinkTimeoutTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  auto old_timeout = resize_drain_timeout;
+  resize_drain_timeout = std::chrono::milliseconds(50);
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, nullptr, ReplacerType::LRU_K);
+  page_id_t page_id_temp;
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id_temp);
+    page_ids.push_back(page_id_temp);
+  }
+  // the page in frame 7 stays pinned
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    if (i != 7) {
+      EXPECT_EQ(true, bpm->UnpinPage(page_ids[i], true));
+    }
+  }
+
+  // Scenario: the shrink drains frames 9 and 8, then gives up on frame 7.
+  EXPECT_FALSE(bpm->Resize(3));
+  EXPECT_EQ(8U, bpm->GetPoolSize());
+
+  // Scenario: all 8 frames are in use again, the drained pages were written back.
+  EXPECT_EQ(true, bpm->UnpinPage(page_ids[7], true));
+  char expected[PAGE_SIZE];
+  for (size_t i = 2; i < buffer_pool_size; ++i) {
+    auto *page = bpm->FetchPage(page_ids[i]);
+    ASSERT_NE(nullptr, page);
+    snprintf(expected, PAGE_SIZE, "page %d", page_ids[i]);
+    EXPECT_EQ(0, strcmp(page->GetData(), expected));
+  }
+  EXPECT_EQ(nullptr, bpm->FetchPage(page_ids[0]));
+  for (size_t i = 2; i < buffer_pool_size; ++i) {
+    EXPECT_EQ(true, bpm->UnpinPage(page_ids[i], false));
+  }
+
+  // Scenario: with nothing pinned the shrink gets through.
+  EXPECT_TRUE(bpm->Resize(3));
+  EXPECT_EQ(3U, bpm->GetPoolSize());
+
+  resize_drain_timeout = old_timeout;
+  disk_manager->ShutDown();
+  DiskManager::RemoveFiles("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+// Fetchers keep seeing the right data while the pool is resized under them.
+TEST(BufferPoolManagerTest, ConcurrentResizeTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 8;
+  const int num_pages = 32;
+  const int num_threads = 4;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, nullptr, ReplacerType::LRU, 32);
+
+  page_id_t page_id_temp;
+  for (int i = 0; i < num_pages; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+
+  std::atomic<bool> done{false};
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([bpm, tid]() {
+      char expected[PAGE_SIZE];
+      for (int round = 0; round < 500; ++round) {
+        page_id_t page_id = (round * 7 + tid) % num_pages;
+        auto *page = bpm->FetchPage(page_id);
+        if (page == nullptr) {
+          // all frames are pinned by the other threads
+          continue;
+        }
+        snprintf(expected, PAGE_SIZE, "page %d", page_id);
+        EXPECT_EQ(0, strcmp(page->GetData(), expected));
+        EXPECT_EQ(true, bpm->UnpinPage(page_id, round % 3 == 0));
+      }
+    });
+  }
+  std::thread resizer([bpm, &done]() {
+    for (size_t round = 0; !done; ++round) {
+      EXPECT_TRUE(bpm->Resize(round % 2 == 0 ? 32 : 4));
+    }
+  });
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  done = true;
+  resizer.join();
+
+  // Shutdown the disk manager and remove the temporary file we created.
+  disk_manager->ShutDown();
+  DiskManager::RemoveFiles("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+// Dropping a segment waits for its pinned pages and forgets them, nothing of it is written or read afterwards.
+TEST(BufferPoolManagerTest, DropSegmentTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  segment_id_t segment_id = bpm->CreateSegment();
+  page_id_t hint = DiskManager::MakePageId(segment_id, 0);
+  std::vector<page_id_t> page_ids;
+  for (int i = 0; i < 20; ++i) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id, hint);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id);
+    page_ids.push_back(page_id);
+    if (i < 19) {
+      EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+    }
+  }
+  // Scenario: pages 0..4 are queued for a prefetch, the last page is still pinned and dirty.
+  std::vector<page_id_t> evicted(page_ids.begin(), page_ids.begin() + 5);
+  bpm->PrefetchPages(evicted);
+  std::thread unpinner([&] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    snprintf(bpm->FetchResidentPage(page_ids.back())->GetData(), PAGE_SIZE, "late write");
+    bpm->UnpinPage(page_ids.back(), true);
+    bpm->UnpinPage(page_ids.back(), true);
+  });
+  bpm->DropSegment(segment_id);
+  unpinner.join();
+
+  // The pinned page was thrown out after its unpin, the flush writes nothing of the segment.
+  int writes = disk_manager->GetNumWrites();
+  bpm->FlushAllPages();
+  EXPECT_EQ(writes, disk_manager->GetNumWrites());
+  EXPECT_EQ(nullptr, bpm->FetchResidentPage(page_ids.back()));
+  struct stat stat_buf;
+  EXPECT_NE(0, stat(("test." + std::to_string(segment_id) + ".db").c_str(), &stat_buf));
+  // All frames are free again.
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    page_id_t page_id;
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id));
+  }
+
+  // Shutdown the disk manager and remove the temporary file we created.
+  disk_manager->ShutDown();
+  DiskManager::RemoveFiles("test.db");
 
   delete bpm;
   delete disk_manager;
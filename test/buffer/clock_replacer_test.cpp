@@ -19,7 +19,8 @@
 
 namespace bustub {
 
-TEST(ClockReplacerTest, DISABLED_SampleTest) {
+// TEST(ClockReplacerTest, DISABLED_SampleTest) {
+TEST(ClockReplacerTest, SampleTest) {
   ClockReplacer clock_replacer(7);
 
   // Scenario: unpin six elements, i.e. add them to the replacer.
@@ -59,4 +60,64 @@ TEST(ClockReplacerTest, DISABLED_SampleTest) {
   EXPECT_EQ(4, value);
 }
 
+TEST(ClockReplacerTest, FrameLimitTest) {
+  ClockReplacer clock_replacer(8);
+
+  // Scenario: the pool only uses 4 of the 8 frames, the clock hand does not sweep the others.
+  clock_replacer.SetFrameLimit(4);
+  clock_replacer.Unpin(1);
+  clock_replacer.Unpin(6);
+  EXPECT_EQ(2, clock_replacer.Size());
+  int value;
+  ASSERT_TRUE(clock_replacer.Victim(&value));
+  EXPECT_EQ(1, value);
+  EXPECT_FALSE(clock_replacer.Victim(&value));
+
+  // Scenario: the pool grows back, frame 6 is a victim again.
+  clock_replacer.SetFrameLimit(8);
+  ASSERT_TRUE(clock_replacer.Victim(&value));
+  EXPECT_EQ(6, value);
+}
+
+TEST(ClockReplacerTest, ConcurrencyTest) {
+  const int num_threads = 8;
+  const int frames_per_thread = 64;
+  ClockReplacer clock_replacer(num_threads * frames_per_thread);
+
+  // Scenario: every thread pins and unpins its own frames while all of them race for victims.
+  std::vector<std::thread> threads;
+  std::vector<std::vector<int>> victims(num_threads);
+  for (int tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([&clock_replacer, &victims, tid]() {
+      for (int i = 0; i < frames_per_thread; i++) {
+        int frame_id = tid * frames_per_thread + i;
+        clock_replacer.Unpin(frame_id);
+        clock_replacer.Pin(frame_id);
+        clock_replacer.Unpin(frame_id);
+      }
+      int value;
+      for (int i = 0; i < frames_per_thread / 2; i++) {
+        if (clock_replacer.Victim(&value)) {
+          victims[tid].push_back(value);
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  // Every frame is handed out at most once and the size stays consistent.
+  std::vector<bool> seen(num_threads * frames_per_thread, false);
+  size_t num_victims = 0;
+  for (auto &thread_victims : victims) {
+    for (auto frame_id : thread_victims) {
+      EXPECT_FALSE(seen[frame_id]);
+      seen[frame_id] = true;
+      num_victims++;
+    }
+  }
+  EXPECT_EQ(num_threads * frames_per_thread - num_victims, clock_replacer.Size());
+}
+
 }  // namespace bustub
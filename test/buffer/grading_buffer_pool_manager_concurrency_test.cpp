@@ -75,8 +75,7 @@ TEST(BufferPoolManagerConcurrencyTest, ConcurrencyTest) {
       threads[i].join();
     }
 
-    remove("test.db");
-    remove("test.log");
+    DiskManager::RemoveFiles("test.db");
     delete disk_manager;
   }
 }
@@ -139,8 +138,7 @@ TEST(BufferPoolManagerConcurrencyTest, HardTest_1) {
     EXPECT_EQ(1, bpm->DeletePage(page_ids[j]));
   }
 
-  remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveFiles("test.db");
   delete bpm;
   delete disk_manager;
 }
@@ -230,8 +228,7 @@ TEST(BufferPoolManagerConcurrencyTest, HardTest_2) {
       EXPECT_EQ(1, bpm->DeletePage(page_ids[j], nullptr));
     }
 
-    remove("test.db");
-    remove("test.log");
+    DiskManager::RemoveFiles("test.db");
     delete disk_manager;
   }
 }
@@ -345,8 +342,7 @@ TEST(BufferPoolManagerConcurrencyTest, HardTest_3) {
       EXPECT_EQ(1, bpm->DeletePage(page_ids[j], nullptr));
     }
 
-    remove("test.db");
-    remove("test.log");
+    DiskManager::RemoveFiles("test.db");
     delete disk_manager;
   }
 }
@@ -477,8 +473,7 @@ TEST(BufferPoolManagerConcurrencyTest, HardTest_4) {
       EXPECT_EQ(1, bpm->DeletePage(page_ids[j], nullptr));
     }
 
-    remove("test.db");
-    remove("test.log");
+    DiskManager::RemoveFiles("test.db");
     delete disk_manager;
   }
 }
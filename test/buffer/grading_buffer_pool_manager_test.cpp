@@ -90,7 +90,7 @@ TEST(BufferPoolManagerTest, SampleTest) {
 
   // Shutdown the disk manager and remove the temporary file we created.
   disk_manager->ShutDown();
-  remove("test.db");
+  DiskManager::RemoveFiles("test.db");
 
   delete bpm;
   delete disk_manager;
@@ -150,7 +150,7 @@ TEST(BufferPoolManagerTest, BinaryDataTest) {
 
   // Shutdown the disk manager and remove the temporary file we created.
   disk_manager->ShutDown();
-  remove("test.db");
+  DiskManager::RemoveFiles("test.db");
 
   delete bpm;
   delete disk_manager;
@@ -212,8 +212,7 @@ TEST(BufferPoolManagerTest, NewPage) {
     EXPECT_EQ(nullptr, new_page);
   }
 
-  remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveFiles("test.db");
   delete bpm;
   delete disk_manager;
 }
@@ -268,8 +267,7 @@ TEST(BufferPoolManagerTest, UnpinPage) {
   EXPECT_EQ(0, strcmp(page->GetData(), "page1updated"));
   strcpy(page->GetData(), "page1againupdated");  // NOLINT
 
-  remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveFiles("test.db");
   delete bpm;
   delete disk_manager;
 }
@@ -374,8 +372,7 @@ TEST(BufferPoolManagerTest, FetchPage) {
   EXPECT_NE(nullptr, page7);
   EXPECT_EQ(0, std::strcmp("7", (page7->GetData())));
 
-  remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveFiles("test.db");
   delete bpm;
   delete disk_manager;
 }
@@ -453,8 +450,7 @@ TEST(BufferPoolManagerTest, DeletePage) {
   EXPECT_EQ(0, std::strcmp(page5->GetData(), "updatedpage5"));
   EXPECT_EQ(0, std::strcmp(page6->GetData(), "updatedpage6"));
 
-  remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveFiles("test.db");
   delete bpm;
   delete disk_manager;
 }
@@ -500,8 +496,7 @@ TEST(BufferPoolManagerTest, IsDirty) {
   ASSERT_NE(nullptr, page0);
   EXPECT_EQ(0, page0->IsDirty());
 
-  remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveFiles("test.db");
   delete bpm;
   delete disk_manager;
 }
@@ -536,8 +531,7 @@ TEST(BufferPoolManagerTest, IntegratedTest) {
   for (int j = 0; j < 10000; j++) {
     EXPECT_EQ(1, bpm->DeletePage(page_ids[j]));
   }
-  remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveFiles("test.db");
   delete bpm;
   delete disk_manager;
 }
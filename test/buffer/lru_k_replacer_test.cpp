@@ -0,0 +1,163 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lru_k_replacer_test.cpp
+//
+// Identification: test/buffer/lru_k_replacer_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/lru_k_replacer.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+namespace {
+/** What a FetchPage followed by an UnpinPage does to the replacer. */
+void Fetch(LRUKReplacer *replacer, frame_id_t frame_id) {
+  replacer->Pin(frame_id);
+  replacer->RecordAccess(frame_id);
+  replacer->Unpin(frame_id);
+}
+}  // namespace
+
+TEST(LRUKReplacerTest, SampleTest) {
+  LRUKReplacer lru_k_replacer(7, 2);
+
+  // Scenario: unpin six elements, i.e. add them to the replacer. None of them was accessed yet.
+  lru_k_replacer.Unpin(1);
+  lru_k_replacer.Unpin(2);
+  lru_k_replacer.Unpin(3);
+  lru_k_replacer.Unpin(4);
+  lru_k_replacer.Unpin(5);
+  lru_k_replacer.Unpin(6);
+  lru_k_replacer.Unpin(1);
+  EXPECT_EQ(6, lru_k_replacer.Size());
+
+  // Scenario: frame 1 is accessed twice, it is now the only frame with a finite backward 2-distance.
+  Fetch(&lru_k_replacer, 1);
+  Fetch(&lru_k_replacer, 2);
+  Fetch(&lru_k_replacer, 1);
+  EXPECT_EQ(6, lru_k_replacer.Size());
+
+  // Scenario: frames with infinite distance go first, in the order they got their pages.
+  int value;
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(2, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(3, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(4, value);
+
+  // Scenario: pin elements in the replacer.
+  // Note that 3 has already been victimized, pinning it starts a new history.
+  lru_k_replacer.Pin(3);
+  lru_k_replacer.Pin(4);
+  EXPECT_EQ(3, lru_k_replacer.Size());
+
+  // Scenario: unpin 4. Its history was cleared on eviction.
+  lru_k_replacer.Unpin(4);
+  EXPECT_EQ(4, lru_k_replacer.Size());
+
+  // Scenario: continue looking for victims. 5, 6 and 4 have infinite distance, 1 is the only frame with two accesses.
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(5, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(6, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(4, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(1, value);
+  EXPECT_EQ(0, lru_k_replacer.Size());
+  EXPECT_FALSE(lru_k_replacer.Victim(&value));
+}
+
+TEST(LRUKReplacerTest, ScanResistanceTest) {
+  LRUKReplacer lru_k_replacer(8, 2);
+
+  // Scenario: frames 0 and 1 hold hot pages that were looked up twice.
+  for (int i = 0; i < 2; i++) {
+    Fetch(&lru_k_replacer, 0);
+    Fetch(&lru_k_replacer, 1);
+  }
+  // Scenario: a scan fetches each of frames 2..7 once per tuple, after the hot pages.
+  for (int i = 2; i < 8; i++) {
+    for (int tuple = 0; tuple < 10; tuple++) {
+      Fetch(&lru_k_replacer, i);
+    }
+  }
+
+  // All the scanned frames are evicted before the hot ones.
+  int value;
+  for (int i = 2; i < 8; i++) {
+    ASSERT_TRUE(lru_k_replacer.Victim(&value));
+    EXPECT_EQ(i, value);
+  }
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(0, value);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(1, value);
+}
+
+TEST(LRUKReplacerTest, CorrelatedAccessTest) {
+  LRUKReplacer lru_k_replacer(4, 2);
+
+  // Scenario: pins without an access, as for a prefetch or a new page, leave the distance infinite.
+  for (int i = 0; i < 3; i++) {
+    lru_k_replacer.Pin(0);
+    lru_k_replacer.Unpin(0);
+  }
+  // Scenario: two fetches of frame 1 while it stays pinned are one access.
+  lru_k_replacer.Pin(1);
+  lru_k_replacer.RecordAccess(1);
+  lru_k_replacer.Pin(1);
+  lru_k_replacer.RecordAccess(1);
+  lru_k_replacer.Unpin(1);
+  // Scenario: frame 2 is fetched twice in a row, frame 3 twice with another access in between.
+  Fetch(&lru_k_replacer, 2);
+  Fetch(&lru_k_replacer, 2);
+  Fetch(&lru_k_replacer, 3);
+  Fetch(&lru_k_replacer, 0);
+  Fetch(&lru_k_replacer, 3);
+
+  // Only frame 3 has a finite distance.
+  int value;
+  for (int expected : {0, 1, 2, 3}) {
+    ASSERT_TRUE(lru_k_replacer.Victim(&value));
+    EXPECT_EQ(expected, value);
+  }
+}
+
+TEST(LRUKReplacerTest, FrameLimitTest) {
+  LRUKReplacer lru_k_replacer(2, 2);
+
+  // Scenario: the pool grows to 4 frames, the new frames get a history.
+  lru_k_replacer.SetFrameLimit(4);
+  for (int i = 0; i < 4; i++) {
+    Fetch(&lru_k_replacer, i);
+  }
+  // Scenario: a shrink to 2 frames, frames 2 and 3 are no victims any more but still count.
+  lru_k_replacer.SetFrameLimit(2);
+  EXPECT_EQ(4, lru_k_replacer.Size());
+  int value;
+  for (int expected : {0, 1}) {
+    ASSERT_TRUE(lru_k_replacer.Victim(&value));
+    EXPECT_EQ(expected, value);
+  }
+  EXPECT_FALSE(lru_k_replacer.Victim(&value));
+  lru_k_replacer.Pin(3);
+  EXPECT_EQ(1, lru_k_replacer.Size());
+  // Scenario: the shrink gave up, frame 2 is a victim again.
+  lru_k_replacer.SetFrameLimit(4);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(2, value);
+}
+
+}  // namespace bustub
@@ -16,18 +16,18 @@
 #include <unordered_map>
 
 #include "../test/buffer/counter.h"
-#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
 
 namespace bustub {
 
-// Add callback functions on BufferPoolManager
-class MockBufferPoolManager : public BufferPoolManager {
+// Add callback functions on BufferPoolManagerInstance
+class MockBufferPoolManager : public BufferPoolManagerInstance {
  public:
   enum class CallbackType { BEFORE, AFTER };
   using bufferpool_callback_fn = void (MockBufferPoolManager::*)(enum CallbackType type, FuncType func_type);
 
   MockBufferPoolManager(size_t pool_size, DiskManager *disk_manager, LogManager *log_manager = nullptr)
-      : BufferPoolManager(pool_size, disk_manager, log_manager) {
+      : BufferPoolManagerInstance(pool_size, disk_manager, log_manager) {
     pool_size_ = pool_size;
     pages_ = nullptr;
     replacer_ = nullptr;
@@ -63,7 +63,7 @@ class MockBufferPoolManager : public BufferPoolManager {
   /** Grading function. Do not modify/call! */
   Page *FetchPage(page_id_t page_id, bufferpool_callback_fn callback = &MockBufferPoolManager::counter_callback) {
     GradingCallback(callback, CallbackType::BEFORE, FuncType::FetchPage, page_id);
-    auto *result = FetchPageImpl(page_id);
+    auto *result = FetchPageImpl(page_id, nullptr);
     GradingCallback(callback, CallbackType::AFTER, FuncType::FetchPage, page_id);
     return result;
   }
@@ -88,7 +88,7 @@ class MockBufferPoolManager : public BufferPoolManager {
   /** Grading function. Do not modify/call! */
   Page *NewPage(page_id_t *page_id, bufferpool_callback_fn callback = &MockBufferPoolManager::counter_callback) {
     GradingCallback(callback, CallbackType::BEFORE, FuncType::NewPage, INVALID_PAGE_ID);
-    auto *result = NewPageImpl(page_id);
+    auto *result = NewPageImpl(page_id, nullptr, INVALID_PAGE_ID);
     GradingCallback(callback, CallbackType::AFTER, FuncType::NewPage, *page_id);
     return result;
   }
@@ -126,11 +126,12 @@ class MockBufferPoolManager : public BufferPoolManager {
   /**
    * Fetch the requested page from the buffer pool.
    * @param page_id id of page to be fetched
+   * @param strategy the ring to bring the page into on a miss, nullptr to use the whole pool
    * @return the requested page
    */
-  Page *FetchPageImpl(page_id_t page_id) {
+  Page *FetchPageImpl(page_id_t page_id, BufferAccessStrategy *strategy) {
     counter.AddCount(FuncType::FetchPage);
-    return BufferPoolManager::FetchPageImpl(page_id);
+    return BufferPoolManagerInstance::FetchPageImpl(page_id, strategy);
   }
 
   /**
@@ -141,7 +142,7 @@ class MockBufferPoolManager : public BufferPoolManager {
    */
   bool UnpinPageImpl(page_id_t page_id, bool is_dirty) {
     counter.AddCount(FuncType::UnpinPage);
-    return BufferPoolManager::UnpinPageImpl(page_id, is_dirty);
+    return BufferPoolManagerInstance::UnpinPageImpl(page_id, is_dirty);
   }
 
   /**
@@ -151,17 +152,19 @@ class MockBufferPoolManager : public BufferPoolManager {
    */
   bool FlushPageImpl(page_id_t page_id) {
     counter.AddCount(FuncType::FlushPage);
-    return BufferPoolManager::FlushPageImpl(page_id);
+    return BufferPoolManagerInstance::FlushPageImpl(page_id);
   }
 
   /**
    * Creates a new page in the buffer pool.
    * @param[out] page_id id of created page
+   * @param strategy the ring to create the page in, nullptr to use the whole pool
+   * @param hint a page of the object the new page belongs to, INVALID_PAGE_ID if none
    * @return nullptr if no new pages could be created, otherwise pointer to new page
    */
-  Page *NewPageImpl(page_id_t *page_id) {
+  Page *NewPageImpl(page_id_t *page_id, BufferAccessStrategy *strategy, page_id_t hint) {
     counter.AddCount(FuncType::NewPage);
-    return BufferPoolManager::NewPageImpl(page_id);
+    return BufferPoolManagerInstance::NewPageImpl(page_id, strategy, hint);
   }
 
   /**
@@ -171,7 +174,7 @@ class MockBufferPoolManager : public BufferPoolManager {
    */
   bool DeletePageImpl(page_id_t page_id) {
     counter.AddCount(FuncType::DeletePage);
-    return BufferPoolManager::DeletePageImpl(page_id);
+    return BufferPoolManagerInstance::DeletePageImpl(page_id);
   }
 
   /**
@@ -179,7 +182,7 @@ class MockBufferPoolManager : public BufferPoolManager {
    */
   void FlushAllPagesImpl() {
     counter.AddCount(FuncType::FlushAllPages);
-    BufferPoolManager::FlushAllPagesImpl();
+    BufferPoolManagerInstance::FlushAllPagesImpl();
   }
 
   // For grading. Do not modify!
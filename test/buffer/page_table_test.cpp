@@ -0,0 +1,135 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table_test.cpp
+//
+// Identification: test/buffer/page_table_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <atomic>
+#include <random>
+#include <thread>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/page_table.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(PageTableTest, SampleTest) {
+  PageTable page_table(8);
+  frame_id_t frame_id;
+  EXPECT_FALSE(page_table.Find(0, &frame_id));
+
+  for (page_id_t page_id = 0; page_id < 8; page_id++) {
+    page_table.Insert(page_id, page_id + 100);
+  }
+  EXPECT_EQ(8, page_table.Size());
+  for (page_id_t page_id = 0; page_id < 8; page_id++) {
+    ASSERT_TRUE(page_table.Find(page_id, &frame_id));
+    EXPECT_EQ(page_id + 100, frame_id);
+  }
+
+  // overwrite
+  page_table.Insert(3, 7);
+  ASSERT_TRUE(page_table.Find(3, &frame_id));
+  EXPECT_EQ(7, frame_id);
+  EXPECT_EQ(8, page_table.Size());
+
+  page_table.Remove(3);
+  page_table.Remove(42);
+  EXPECT_FALSE(page_table.Find(3, &frame_id));
+  EXPECT_EQ(7, page_table.Size());
+}
+
+// Random inserts and removes checked against std::unordered_map, exercises the backward shift of Remove.
+TEST(PageTableTest, RandomTest) {
+  const size_t max_entries = 64;
+  PageTable page_table(max_entries);
+  std::unordered_map<page_id_t, frame_id_t> expected;
+  std::mt19937 rng(15445);
+  std::uniform_int_distribution<page_id_t> page_dist(0, 500);
+
+  for (int i = 0; i < 20000; i++) {
+    page_id_t page_id = page_dist(rng);
+    if (expected.count(page_id) != 0 || expected.size() == max_entries) {
+      page_table.Remove(page_id);
+      expected.erase(page_id);
+    } else {
+      page_table.Insert(page_id, i);
+      expected[page_id] = i;
+    }
+    ASSERT_EQ(expected.size(), page_table.Size());
+  }
+  for (page_id_t page_id = 0; page_id <= 500; page_id++) {
+    frame_id_t frame_id;
+    bool found = page_table.Find(page_id, &frame_id);
+    ASSERT_EQ(expected.count(page_id) != 0, found);
+    if (found) {
+      EXPECT_EQ(expected[page_id], frame_id);
+    }
+  }
+}
+
+// Latch-free readers may miss entries that are being moved, but must never see a wrong mapping.
+TEST(PageTableTest, ConcurrentReadTest) {
+  const size_t max_entries = 64;
+  PageTable page_table(max_entries);
+  // page p is only ever mapped to frame p * 2
+  for (page_id_t page_id = 0; page_id < 32; page_id++) {
+    page_table.Insert(page_id, page_id * 2);
+  }
+
+  std::atomic<bool> done{false};
+  std::vector<std::thread> readers;
+  for (int tid = 0; tid < 3; tid++) {
+    readers.emplace_back([&] {
+      size_t hits = 0;
+      while (!done) {
+        for (page_id_t page_id = 0; page_id < 32; page_id++) {
+          frame_id_t frame_id;
+          if (page_table.Find(page_id, &frame_id)) {
+            ASSERT_EQ(page_id * 2, frame_id);
+            hits++;
+          }
+        }
+      }
+      EXPECT_GT(hits, 0);
+    });
+  }
+
+  // the writer churns the other half of the table
+  std::mt19937 rng(15445);
+  std::uniform_int_distribution<page_id_t> page_dist(1000, 1100);
+  std::vector<page_id_t> churn;
+  for (int i = 0; i < 50000; i++) {
+    if (churn.size() < 32) {
+      page_id_t page_id = page_dist(rng);
+      frame_id_t frame_id;
+      if (!page_table.Find(page_id, &frame_id)) {
+        page_table.Insert(page_id, page_id * 2);
+        churn.push_back(page_id);
+      }
+    } else {
+      page_table.Remove(churn[i % churn.size()]);
+      churn.erase(churn.begin() + i % churn.size());
+    }
+  }
+  done = true;
+  for (auto &reader : readers) {
+    reader.join();
+  }
+
+  for (page_id_t page_id = 0; page_id < 32; page_id++) {
+    frame_id_t frame_id;
+    ASSERT_TRUE(page_table.Find(page_id, &frame_id));
+    EXPECT_EQ(page_id * 2, frame_id);
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,202 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_buffer_pool_manager_test.cpp
+//
+// Identification: test/buffer/parallel_buffer_pool_manager_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/parallel_buffer_pool_manager.h"
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, SampleTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 5;
+  const size_t num_instances = 2;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager);
+  EXPECT_EQ(num_instances * buffer_pool_size, bpm->GetPoolSize());
+
+  page_id_t page_id_temp;
+  auto *page0 = bpm->NewPage(&page_id_temp);
+
+  // Scenario: The buffer pool is empty. We should be able to create a new page.
+  ASSERT_NE(nullptr, page0);
+  EXPECT_EQ(0, page_id_temp);
+
+  // Scenario: Once we have a page, we should be able to read and write content.
+  snprintf(page0->GetData(), PAGE_SIZE, "Hello");
+  EXPECT_EQ(0, strcmp(page0->GetData(), "Hello"));
+
+  // Scenario: We should be able to create new pages until we fill up the buffer pool.
+  // New pages are handed out round robin, so the page ids stay dense.
+  for (size_t i = 1; i < buffer_pool_size * num_instances; ++i) {
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(static_cast<page_id_t>(i), page_id_temp);
+  }
+
+  // Scenario: Once the buffer pool is full, we should not be able to create any new pages.
+  for (size_t i = 0; i < buffer_pool_size * num_instances; ++i) {
+    EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+  }
+
+  // Scenario: After unpinning pages {0, 1, 2, 3, 4} and pinning another 4 new pages,
+  // there would still be one buffer page left for reading page 0.
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_EQ(true, bpm->UnpinPage(i, true));
+  }
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  }
+
+  // Scenario: We should be able to fetch the data we wrote a while ago.
+  page0 = bpm->FetchPage(0);
+  ASSERT_NE(nullptr, page0);
+  EXPECT_EQ(0, strcmp(page0->GetData(), "Hello"));
+  EXPECT_EQ(true, bpm->UnpinPage(0, true));
+
+  // Shutdown the disk manager and remove the temporary file we created.
+  disk_manager->ShutDown();
+  DiskManager::RemoveFiles("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, ConcurrencyTest) {
+  const int num_threads = 8;
+  const int num_runs = 20;
+  for (int run = 0; run < num_runs; run++) {
+    auto *disk_manager = new DiskManager("test.db");
+    auto *bpm = new ParallelBufferPoolManager(4, 50, disk_manager);
+    std::vector<std::thread> threads;
+    for (int tid = 0; tid < num_threads; tid++) {
+      threads.emplace_back([bpm]() {
+        page_id_t temp_page_id;
+        std::vector<page_id_t> page_ids;
+        for (int i = 0; i < 10; i++) {
+          auto *new_page = bpm->NewPage(&temp_page_id);
+          EXPECT_NE(nullptr, new_page);
+          ASSERT_NE(nullptr, new_page);
+          strcpy(new_page->GetData(), std::to_string(temp_page_id).c_str());  // NOLINT
+          page_ids.push_back(temp_page_id);
+        }
+        for (int i = 0; i < 10; i++) {
+          EXPECT_EQ(1, bpm->UnpinPage(page_ids[i], true));
+        }
+        for (int j = 0; j < 10; j++) {
+          auto *page = bpm->FetchPage(page_ids[j]);
+          EXPECT_NE(nullptr, page);
+          ASSERT_NE(nullptr, page);
+          EXPECT_EQ(0, strcmp(page->GetData(), (std::to_string(page_ids[j])).c_str()));
+          EXPECT_EQ(1, bpm->UnpinPage(page_ids[j], true));
+        }
+        for (int j = 0; j < 10; j++) {
+          EXPECT_EQ(1, bpm->DeletePage(page_ids[j]));
+        }
+      });
+    }
+
+    for (int i = 0; i < num_threads; i++) {
+      threads[i].join();
+    }
+
+    // Shutdown the disk manager and remove the temporary file we created.
+    disk_manager->ShutDown();
+    DiskManager::RemoveFiles("test.db");
+
+    delete bpm;
+    delete disk_manager;
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, DeletedPageReuseTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 5;
+  const size_t num_instances = 2;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager);
+
+  page_id_t page_id_temp;
+  for (page_id_t i = 0; i < 6; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(i, page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // Scenario: a deleted page id is handed out again by the instance that owns it, resident or not.
+  EXPECT_EQ(true, bpm->DeletePage(2));
+  bpm->FlushAllPages();
+  EXPECT_EQ(true, bpm->DeletePage(3));
+  EXPECT_FALSE(disk_manager->IsAllocated(2));
+  std::vector<page_id_t> page_ids;
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    page_ids.push_back(page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+  }
+  std::sort(page_ids.begin(), page_ids.end());
+  EXPECT_EQ((std::vector<page_id_t>{2, 3, 6, 7}), page_ids);
+
+  // Shutdown the disk manager and remove the temporary file we created.
+  disk_manager->ShutDown();
+  DiskManager::RemoveFiles("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, ResizeTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 5;
+  const size_t num_instances = 2;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager, nullptr, ReplacerType::LRU, 8);
+  EXPECT_EQ(10U, bpm->GetPoolSize());
+
+  // Scenario: the new size is split over the instances, none of which may get less than 1 or more than 8 frames.
+  EXPECT_FALSE(bpm->Resize(1));
+  EXPECT_FALSE(bpm->Resize(17));
+  EXPECT_TRUE(bpm->Resize(15));
+  EXPECT_EQ(15U, bpm->GetPoolSize());
+  page_id_t page_id_temp;
+  std::vector<page_id_t> page_ids;
+  for (int i = 0; i < 15; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    page_ids.push_back(page_id_temp);
+  }
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+  for (auto page_id : page_ids) {
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+  EXPECT_TRUE(bpm->Resize(2));
+  EXPECT_EQ(2U, bpm->GetPoolSize());
+
+  // Shutdown the disk manager and remove the temporary file we created.
+  disk_manager->ShutDown();
+  DiskManager::RemoveFiles("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+}  // namespace bustub
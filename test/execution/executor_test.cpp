@@ -20,7 +20,7 @@
 #include "execution/plans/delete_plan.h"
 #include "execution/plans/limit_plan.h"
 
-#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
 #include "catalog/table_generator.h"
 #include "concurrency/transaction_manager.h"
 #include "execution/execution_engine.h"
@@ -47,7 +47,7 @@ class ExecutorTest : public ::testing::Test {
     ::testing::Test::SetUp();
     // For each test, we create a new DiskManager, BufferPoolManager, TransactionManager, and Catalog.
     disk_manager_ = std::make_unique<DiskManager>("executor_test.db");
-    bpm_ = std::make_unique<BufferPoolManager>(32, disk_manager_.get());
+    bpm_ = std::make_unique<BufferPoolManagerInstance>(32, disk_manager_.get());
     page_id_t page_id;
     bpm_->NewPage(&page_id);
     lock_manager_ = std::make_unique<LockManager>();
@@ -70,7 +70,7 @@ class ExecutorTest : public ::testing::Test {
     txn_mgr_->Commit(txn_);
     // Shut down the disk manager and clean up the transaction.
     disk_manager_->ShutDown();
-    remove("executor_test.db");
+    DiskManager::RemoveFiles("executor_test.db");
     delete txn_;
   };
 
@@ -30,15 +30,13 @@ class RecoveryTest : public ::testing::Test {
  protected:
   // This function is called before every test.
   void SetUp() override {
-    remove("test.db");
-    remove("test.log");
+    DiskManager::RemoveFiles("test.db");
   }
 
   // This function is called after every test.
   void TearDown() override {
     LOG_INFO("Tearing down the system..");
-    remove("test.db");
-    remove("test.log");
+    DiskManager::RemoveFiles("test.db");
   };
 };
 
@@ -251,7 +249,7 @@ TEST_F(RecoveryTest, DISABLED_CheckpointTest) {
   bustub_instance->checkpoint_manager_->BeginCheckpoint();
   bustub_instance->checkpoint_manager_->EndCheckpoint();
 
-  Page *pages = bustub_instance->buffer_pool_manager_->GetPages();
+  Page *pages = dynamic_cast<BufferPoolManagerInstance *>(bustub_instance->buffer_pool_manager_)->GetPages();
   size_t pool_size = bustub_instance->buffer_pool_manager_->GetPoolSize();
 
   // make sure that all pages in the buffer pool are marked as non-dirty
@@ -0,0 +1,211 @@
+/**
+ * b_plus_tree_blink_test.cpp
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <thread>                   // NOLINT
+#include "b_plus_tree_test_util.h"  // NOLINT
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree.h"
+
+namespace bustub {
+
+using BLinkTree = BPlusTree<GenericKey<8>, RID, GenericComparator<8>>;
+using BLinkInternalPage = BPlusTreeInternalPage<GenericKey<8>, page_id_t, GenericComparator<8>>;
+using BLinkLeafPage = BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>>;
+
+namespace {
+void InsertKeys(BLinkTree *tree, const std::vector<int64_t> &keys) {
+  GenericKey<8> index_key;
+  Transaction transaction(0);
+  for (auto key : keys) {
+    index_key.SetFromInteger(key);
+    tree->Insert(index_key, RID(static_cast<int32_t>(key >> 32), static_cast<uint32_t>(key & 0xFFFFFFFF)),
+                 &transaction);
+  }
+}
+
+/*
+ * Walk every level from its leftmost node along the right links and check that each node's keys lie below its
+ * high key and at or above the high key of its left sibling.
+ * @return the number of nodes on each level, root first
+ */
+std::vector<int> CheckLevels(BLinkTree *tree, BufferPoolManager *bpm, const GenericComparator<8> &comparator) {
+  std::vector<int> widths;
+  page_id_t leftmost = tree->GetRootPageId();
+  while (leftmost != INVALID_PAGE_ID) {
+    int width = 0;
+    page_id_t next_leftmost = INVALID_PAGE_ID;
+    bool has_low_key = false;
+    GenericKey<8> low_key;
+    for (page_id_t page_id = leftmost; page_id != INVALID_PAGE_ID; width++) {
+      auto *node = reinterpret_cast<BPlusTreePage *>(bpm->FetchPage(page_id)->GetData());
+      page_id_t next;
+      GenericKey<8> high_key;
+      int first = 0;
+      if (node->IsLeafPage()) {
+        auto *leaf = reinterpret_cast<BLinkLeafPage *>(node);
+        next = leaf->GetNextPageId();
+        high_key = leaf->GetHighKey();
+      } else {
+        auto *internal = reinterpret_cast<BLinkInternalPage *>(node);
+        next = internal->GetNextPageId();
+        high_key = internal->GetHighKey();
+        // the first key of an internal page is only a placeholder
+        first = 1;
+        if (width == 0) {
+          next_leftmost = internal->ValueAt(0);
+        }
+      }
+      for (int i = first; i < node->GetSize(); i++) {
+        GenericKey<8> key = node->IsLeafPage() ? reinterpret_cast<BLinkLeafPage *>(node)->KeyAt(i)
+                                               : reinterpret_cast<BLinkInternalPage *>(node)->KeyAt(i);
+        if (next != INVALID_PAGE_ID) {
+          EXPECT_LT(comparator(key, high_key), 0);
+        }
+        if (has_low_key) {
+          EXPECT_GE(comparator(key, low_key), 0);
+        }
+      }
+      has_low_key = true;
+      low_key = high_key;
+      bpm->UnpinPage(page_id, false);
+      page_id = next;
+    }
+    widths.push_back(width);
+    leftmost = next_leftmost;
+  }
+  return widths;
+}
+}  // namespace
+
+// NOLINTNEXTLINE
+// Splits in B-link mode give every node a high key and a right link, readers find every key through them.
+TEST(BPlusTreeBLinkTest, SplitLinksTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(500, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  BLinkTree tree("foo_pk", bpm, comparator, 4, 4, true);
+
+  std::vector<int64_t> keys(200);
+  std::iota(keys.begin(), keys.end(), 1);
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+  InsertKeys(&tree, keys);
+
+  std::vector<int> widths = CheckLevels(&tree, bpm, comparator);
+  ASSERT_GE(widths.size(), 3U);
+  EXPECT_EQ(1, widths[0]);
+  for (size_t level = 1; level < widths.size(); level++) {
+    EXPECT_GT(widths[level], widths[level - 1]);
+  }
+
+  std::vector<RID> rids;
+  GenericKey<8> index_key;
+  for (int64_t key = 1; key <= 200; key++) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(tree.GetValue(index_key, &rids));
+    ASSERT_EQ(1U, rids.size());
+    EXPECT_EQ(key, rids[0].GetSlotNum());
+  }
+
+  // Scenario: deletes leave underfull and even empty leaves behind, which the iterator steps over.
+  Transaction transaction(0);
+  for (int64_t key = 1; key <= 200; key++) {
+    if (key % 10 != 0) {
+      index_key.SetFromInteger(key);
+      tree.Remove(index_key, &transaction);
+    }
+  }
+  int64_t expected = 10;
+  for (auto iterator = tree.begin(); iterator != tree.end(); ++iterator) {
+    EXPECT_EQ(expected, (*iterator).second.GetSlotNum());
+    expected += 10;
+  }
+  EXPECT_EQ(210, expected);
+  {
+    index_key.SetFromInteger(11);
+    auto iterator = tree.Begin(index_key);
+    EXPECT_EQ(20, (*iterator).second.GetSlotNum());
+  }
+  rids.clear();
+  index_key.SetFromInteger(15);
+  EXPECT_FALSE(tree.GetValue(index_key, &rids));
+  EXPECT_EQ(widths, CheckLevels(&tree, bpm, comparator));
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete bpm;
+  delete disk_manager;
+  DiskManager::RemoveFiles("test.db");
+}
+
+// NOLINTNEXTLINE
+// Concurrent inserts, lookups and deletes in B-link mode.
+TEST(BPlusTreeBLinkTest, ConcurrentMixedTest) {
+  const int num_threads = 8;
+  const int64_t keys_per_thread = 1000;
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(2000, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  // small nodes, so that splits reach the root again and again
+  BLinkTree tree("foo_pk", bpm, comparator, 8, 8, true);
+
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([&tree, tid]() {
+      std::vector<int64_t> keys;
+      for (int64_t i = 0; i < keys_per_thread; i++) {
+        keys.push_back(i * num_threads + tid);
+      }
+      std::shuffle(keys.begin(), keys.end(), std::mt19937(tid));
+      GenericKey<8> index_key;
+      Transaction transaction(tid);
+      std::vector<RID> rids;
+      for (size_t i = 0; i < keys.size(); i++) {
+        index_key.SetFromInteger(keys[i]);
+        EXPECT_TRUE(tree.Insert(index_key, RID(0, static_cast<uint32_t>(keys[i])), &transaction));
+        // a key inserted earlier must stay visible while other threads split around it
+        rids.clear();
+        index_key.SetFromInteger(keys[i / 2]);
+        EXPECT_TRUE(tree.GetValue(index_key, &rids));
+      }
+      // every thread removes its odd keys
+      for (auto key : keys) {
+        if (key % 2 == 1) {
+          index_key.SetFromInteger(key);
+          tree.Remove(index_key, &transaction);
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  int64_t expected = 0;
+  for (auto iterator = tree.begin(); iterator != tree.end(); ++iterator) {
+    EXPECT_EQ(expected, (*iterator).second.GetSlotNum());
+    expected += 2;
+  }
+  EXPECT_EQ(num_threads * keys_per_thread, expected);
+  CheckLevels(&tree, bpm, comparator);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete bpm;
+  delete disk_manager;
+  DiskManager::RemoveFiles("test.db");
+}
+
+}  // namespace bustub
@@ -0,0 +1,249 @@
+/**
+ * b_plus_tree_bulk_load_test.cpp
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <numeric>
+#include <random>
+#include <vector>
+#include "b_plus_tree_test_util.h"  // NOLINT
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree.h"
+#include "storage/index/b_plus_tree_index.h"
+#include "storage/table/table_heap.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+using BulkTree = BPlusTree<GenericKey<8>, RID, GenericComparator<8>>;
+using BulkLeafPage = BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>>;
+
+namespace {
+/** @return a BulkLoad input producing the given keys in order, the RID's slot number is the key */
+std::function<bool(GenericKey<8> *, RID *)> KeysInput(const std::vector<int64_t> &keys) {
+  auto cursor = std::make_shared<size_t>(0);
+  return [&keys, cursor](GenericKey<8> *key, RID *value) {
+    if (*cursor == keys.size()) {
+      return false;
+    }
+    int64_t next = keys[(*cursor)++];
+    key->SetFromInteger(next);
+    *value = RID(0, static_cast<uint32_t>(next));
+    return true;
+  };
+}
+}  // namespace
+
+// NOLINTNEXTLINE
+// Bulk loading packs the leaves to the fill factor and builds a tree that lookups, scans, inserts and deletes work on.
+TEST(BPlusTreeBulkLoadTest, SortedLoadTest) {
+  const int64_t num_keys = 1000;
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(1000, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  // leaves take up to 10 entries, 7 at fill factor 0.7
+  BulkTree tree("foo_pk", bpm, comparator, 11, 8);
+
+  std::vector<int64_t> keys(num_keys);
+  std::iota(keys.begin(), keys.end(), 1);
+  ASSERT_TRUE(tree.BulkLoad(KeysInput(keys), 0.7));
+  EXPECT_FALSE(tree.IsEmpty());
+  // a second load would mix into the tree
+  EXPECT_FALSE(tree.BulkLoad(KeysInput(keys)));
+
+  std::vector<RID> rids;
+  GenericKey<8> index_key;
+  for (auto key : keys) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(tree.GetValue(index_key, &rids));
+    ASSERT_EQ(1U, rids.size());
+    EXPECT_EQ(key, rids[0].GetSlotNum());
+  }
+
+  // every leaf but the last holds 7 entries
+  int64_t expected = 1;
+  for (auto iterator = tree.begin(); iterator != tree.end(); ++iterator) {
+    EXPECT_EQ(expected++, (*iterator).second.GetSlotNum());
+  }
+  EXPECT_EQ(num_keys + 1, expected);
+  index_key.SetFromInteger(1);
+  Page *first_leaf = tree.FindLeafPage(index_key);
+  first_leaf->RUnlatch();
+  auto *leaf = reinterpret_cast<BulkLeafPage *>(first_leaf->GetData());
+  int leaves = 0;
+  while (true) {
+    leaves++;
+    page_id_t next = leaf->GetNextPageId();
+    if (next != INVALID_PAGE_ID) {
+      EXPECT_EQ(7, leaf->GetSize());
+    }
+    bpm->UnpinPage(leaf->GetPageId(), false);
+    if (next == INVALID_PAGE_ID) {
+      break;
+    }
+    leaf = reinterpret_cast<BulkLeafPage *>(bpm->FetchPage(next)->GetData());
+  }
+  EXPECT_EQ((num_keys + 6) / 7, leaves);
+
+  // the loaded tree takes inserts and deletes as usual
+  Transaction transaction(0);
+  for (int64_t key = num_keys + 1; key <= 2 * num_keys; key++) {
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(tree.Insert(index_key, RID(0, static_cast<uint32_t>(key)), &transaction));
+  }
+  for (int64_t key = 1; key <= 2 * num_keys; key += 2) {
+    index_key.SetFromInteger(key);
+    tree.Remove(index_key, &transaction);
+  }
+  expected = 2;
+  for (auto iterator = tree.begin(); iterator != tree.end(); ++iterator) {
+    EXPECT_EQ(expected, (*iterator).second.GetSlotNum());
+    expected += 2;
+  }
+  EXPECT_EQ(2 * num_keys + 2, expected);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete bpm;
+  delete disk_manager;
+  DiskManager::RemoveFiles("test.db");
+}
+
+// NOLINTNEXTLINE
+// The nodes on the right edge end up with at least half of their capacity, so deletes work down to an empty tree.
+TEST(BPlusTreeBulkLoadTest, RightEdgeDeleteTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  // 81 and 161 keys leave one key in the last leaf and one child in the last internal nodes before the fix up
+  for (int64_t num_keys : {81, 161, 2, 11, 12, 100, 1000}) {
+    auto *disk_manager = new DiskManager("test.db");
+    BufferPoolManager *bpm = new BufferPoolManagerInstance(1000, disk_manager);
+    page_id_t page_id;
+    bpm->NewPage(&page_id);
+    BulkTree tree("foo_pk", bpm, comparator, 11, 8);
+
+    std::vector<int64_t> keys(num_keys);
+    std::iota(keys.begin(), keys.end(), 1);
+    ASSERT_TRUE(tree.BulkLoad(KeysInput(keys), 1.0));
+
+    GenericKey<8> index_key;
+    Transaction transaction(0);
+    for (int64_t key = num_keys; key > 1; key--) {
+      index_key.SetFromInteger(key);
+      tree.Remove(index_key, &transaction);
+      int64_t expected = 1;
+      for (auto iterator = tree.begin(); iterator != tree.end() && expected <= key; ++iterator) {
+        EXPECT_EQ(expected++, (*iterator).second.GetSlotNum());
+      }
+      ASSERT_EQ(key, expected) << num_keys << " keys, removed down to " << key;
+    }
+    index_key.SetFromInteger(1);
+    tree.Remove(index_key, &transaction);
+    EXPECT_TRUE(tree.IsEmpty());
+
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete bpm;
+    delete disk_manager;
+    DiskManager::RemoveFiles("test.db");
+  }
+  delete key_schema;
+}
+
+// NOLINTNEXTLINE
+// Unsorted or duplicate input is refused and leaves the tree empty.
+TEST(BPlusTreeBulkLoadTest, UnsortedLoadTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(100, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  BulkTree tree("foo_pk", bpm, comparator, 4, 4);
+
+  std::vector<int64_t> keys(100);
+  std::iota(keys.begin(), keys.end(), 1);
+  keys[50] = keys[49];
+  EXPECT_FALSE(tree.BulkLoad(KeysInput(keys)));
+  EXPECT_TRUE(tree.IsEmpty());
+  std::swap(keys[20], keys[70]);
+  EXPECT_FALSE(tree.BulkLoad(KeysInput(keys)));
+  EXPECT_TRUE(tree.IsEmpty());
+
+  // an empty input loads an empty tree
+  std::vector<int64_t> no_keys;
+  EXPECT_TRUE(tree.BulkLoad(KeysInput(no_keys)));
+  EXPECT_TRUE(tree.IsEmpty());
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete bpm;
+  delete disk_manager;
+  DiskManager::RemoveFiles("test.db");
+}
+
+// NOLINTNEXTLINE
+// BulkBuild sorts a table in several runs, merges them and keeps the first RID of a duplicate key.
+TEST(BPlusTreeBulkLoadTest, IndexBulkBuildTest) {
+  const int64_t num_keys = 3000;
+  Schema schema({Column("a", TypeId::BIGINT), Column("b", TypeId::INTEGER)});
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(1000, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  Transaction transaction(0);
+  TableHeap table(bpm, nullptr, nullptr, &transaction);
+
+  // every tenth key shows up twice
+  std::vector<int64_t> keys(num_keys);
+  std::iota(keys.begin(), keys.end(), 0);
+  for (int64_t key = 0; key < num_keys; key += 10) {
+    keys.push_back(key);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+  std::vector<RID> first_rids(num_keys);
+  std::vector<bool> seen(num_keys, false);
+  for (auto key : keys) {
+    Tuple tuple({ValueFactory::GetBigIntValue(key), ValueFactory::GetIntegerValue(0)}, &schema);
+    RID rid;
+    ASSERT_TRUE(table.InsertTuple(tuple, &rid, &transaction));
+    if (!seen[key]) {
+      seen[key] = true;
+      first_rids[key] = rid;
+    }
+  }
+
+  // the index owns its metadata
+  auto *metadata = new IndexMetadata("foo_pk", "foo", &schema, {0});
+  BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>> index(metadata, bpm);
+  // 7 runs, sorted by 2 threads
+  ASSERT_TRUE(index.BulkBuild(&table, schema, &transaction, 1.0, 500, 2));
+  EXPECT_FALSE(index.BulkBuild(&table, schema, &transaction));
+
+  int64_t expected = 0;
+  for (auto iterator = index.GetBeginIterator(); iterator != index.GetEndIterator(); ++iterator) {
+    EXPECT_EQ(expected, (*iterator).first.ToString());
+    EXPECT_EQ(first_rids[expected], (*iterator).second);
+    expected++;
+  }
+  EXPECT_EQ(num_keys, expected);
+
+  std::vector<RID> rids;
+  Tuple key_tuple({ValueFactory::GetBigIntValue(1234)}, metadata->GetKeySchema());
+  index.ScanKey(key_tuple, &rids, &transaction);
+  ASSERT_EQ(1U, rids.size());
+  EXPECT_EQ(first_rids[1234], rids[0]);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+  delete disk_manager;
+  DiskManager::RemoveFiles("test.db");
+}
+
+}  // namespace bustub
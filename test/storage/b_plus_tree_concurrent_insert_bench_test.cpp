@@ -0,0 +1,107 @@
+/**
+ * b_plus_tree_concurrent_insert_bench_test.cpp
+ *
+ * Benchmark of concurrent inserts into one B+ tree.
+ *
+ * An insert descends optimistically and write latches only the leaf, it takes root_latch_ and write latches the
+ * path down only when the leaf has to split. The threads insert disjoint keys in random order into a fresh tree,
+ * so they collide on the inner nodes all the time and on the leaves now and then.
+ *
+ * Configuration:
+ *    keys: 64000 GenericKey<8> keys per run, split evenly over the threads, each thread in random order
+ *    threads: 1, 2, 4, 8, 16, 32, 64
+ *    buffer pool: 5000 frames, the tree stays resident
+ *
+ * Result (default build flags, no -O, on a machine with a single CPU, so the threads only interleave):
+ * [BENCHMARK: ConcurrentInsertBenchTest.InsertBenchmark] 1 threads: 0.14 M inserts/s
+ * [BENCHMARK: ConcurrentInsertBenchTest.InsertBenchmark] 2 threads: 0.11 M inserts/s
+ * [BENCHMARK: ConcurrentInsertBenchTest.InsertBenchmark] 4 threads: 0.10 M inserts/s
+ * [BENCHMARK: ConcurrentInsertBenchTest.InsertBenchmark] 8 threads: 0.10 M inserts/s
+ * [BENCHMARK: ConcurrentInsertBenchTest.InsertBenchmark] 16 threads: 0.10 M inserts/s
+ * [BENCHMARK: ConcurrentInsertBenchTest.InsertBenchmark] 32 threads: 0.10 M inserts/s
+ * [BENCHMARK: ConcurrentInsertBenchTest.InsertBenchmark] 64 threads: 0.14 M inserts/s
+ * With the optimistic path turned off (OPTIMISTIC_WRITE_ATTEMPTS = 0) the same runs gave 0.11 to 0.13 M inserts/s.
+ * Both stay within the run to run noise here: one CPU has no parallelism to win back. What changes is that only
+ * the inserts that split a leaf, about 1 in 200, still take root_latch_ and write latch the path down.
+ */
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "b_plus_tree_test_util.h"  // NOLINT
+#include "buffer/buffer_pool_manager_instance.h"
+#include "concurrency/transaction.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(ConcurrentInsertBenchTest, InsertBenchmark) {
+  const int64_t num_keys = 64000;
+  std::stringstream ss;
+  for (int num_threads = 1; num_threads <= 64; num_threads *= 2) {
+    DiskManager::RemoveFiles("insert_bench.db");
+    Schema *key_schema = ParseCreateStatement("a bigint");
+    GenericComparator<8> comparator(key_schema);
+    auto *disk_manager = new DiskManager("insert_bench.db");
+    BufferPoolManager *bpm = new BufferPoolManagerInstance(5000, disk_manager);
+    page_id_t header_page_id;
+    bpm->NewPage(&header_page_id);
+    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("insert_bench_pk", bpm, comparator);
+
+    // thread tid inserts the keys k with k % num_threads == tid
+    std::vector<std::vector<int64_t>> keys(num_threads);
+    for (int64_t key = 0; key < num_keys; key++) {
+      keys[key % num_threads].push_back(key);
+    }
+    for (int tid = 0; tid < num_threads; tid++) {
+      std::shuffle(keys[tid].begin(), keys[tid].end(), std::mt19937(15445 + tid));
+    }
+
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for (int tid = 0; tid < num_threads; tid++) {
+      threads.emplace_back([&tree, &keys, tid]() {
+        Transaction transaction(tid);
+        GenericKey<8> index_key;
+        for (auto key : keys[tid]) {
+          index_key.SetFromInteger(key);
+          tree.Insert(index_key, RID(static_cast<int32_t>(key >> 16), static_cast<uint32_t>(key & 0xFFFF)),
+                      &transaction);
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    int64_t scanned = 0;
+    int64_t expected = 0;
+    for (auto iterator = tree.begin(); iterator != tree.end(); ++iterator) {
+      EXPECT_EQ(expected++, (*iterator).first.ToString());
+      scanned++;
+    }
+    EXPECT_EQ(scanned, num_keys);
+
+    ss << std::fixed << std::setprecision(2) << "[BENCHMARK: ConcurrentInsertBenchTest.InsertBenchmark] "
+       << num_threads << " threads: " << num_keys / seconds / 1e6 << " M inserts/s" << std::endl;
+
+    bpm->UnpinPage(header_page_id, true);
+    delete bpm;
+    delete disk_manager;
+    delete key_schema;
+  }
+  std::cout << ss.str();
+  DiskManager::RemoveFiles("insert_bench.db");
+}
+
+}  // namespace bustub
@@ -2,13 +2,14 @@
  * b_plus_tree_test.cpp
  */
 
+#include <atomic>
 #include <chrono>  // NOLINT
 #include <cstdio>
 #include <functional>
 #include <thread>                   // NOLINT
 #include "b_plus_tree_test_util.h"  // NOLINT
 
-#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
 #include "gtest/gtest.h"
 #include "storage/index/b_plus_tree.h"
 
@@ -98,7 +99,7 @@ TEST(BPlusTreeConcurrentTest, InsertTest1) {
   GenericComparator<8> comparator(key_schema);
 
   DiskManager *disk_manager = new DiskManager("test.db");
-  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
   // create b+ tree
   BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
   // create and fetch header_page
@@ -141,8 +142,7 @@ TEST(BPlusTreeConcurrentTest, InsertTest1) {
   delete key_schema;
   delete disk_manager;
   delete bpm;
-  remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveFiles("test.db");
 }
 
 // 两个线程并发插入keys
@@ -151,7 +151,7 @@ TEST(BPlusTreeConcurrentTest, InsertTest2) {
   Schema *key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema);
   DiskManager *disk_manager = new DiskManager("test.db");
-  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
   // create b+ tree
   BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
   // create and fetch header_page
@@ -197,8 +197,7 @@ TEST(BPlusTreeConcurrentTest, InsertTest2) {
   delete key_schema;
   delete disk_manager;
   delete bpm;
-  remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveFiles("test.db");
 }
 
 TEST(BPlusTreeConcurrentTest, DeleteTest1) {
@@ -207,7 +206,7 @@ TEST(BPlusTreeConcurrentTest, DeleteTest1) {
   GenericComparator<8> comparator(key_schema);
 
   DiskManager *disk_manager = new DiskManager("test.db");
-  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
   // create b+ tree
   BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
   GenericKey<8> index_key;
@@ -240,8 +239,7 @@ TEST(BPlusTreeConcurrentTest, DeleteTest1) {
   delete key_schema;
   delete disk_manager;
   delete bpm;
-  remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveFiles("test.db");
 }
 
 TEST(BPlusTreeConcurrentTest, DeleteTest2) {
@@ -250,7 +248,7 @@ TEST(BPlusTreeConcurrentTest, DeleteTest2) {
   GenericComparator<8> comparator(key_schema);
 
   DiskManager *disk_manager = new DiskManager("test.db");
-  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
   // create b+ tree
   BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
   GenericKey<8> index_key;
@@ -284,8 +282,7 @@ TEST(BPlusTreeConcurrentTest, DeleteTest2) {
   delete key_schema;
   delete disk_manager;
   delete bpm;
-  remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveFiles("test.db");
 }
 
 TEST(BPlusTreeConcurrentTest, MixTest) {
@@ -294,7 +291,7 @@ TEST(BPlusTreeConcurrentTest, MixTest) {
   GenericComparator<8> comparator(key_schema);
 
   DiskManager *disk_manager = new DiskManager("test.db");
-  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
   // create b+ tree
   BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
   GenericKey<8> index_key;
@@ -330,8 +327,68 @@ TEST(BPlusTreeConcurrentTest, MixTest) {
   delete key_schema;
   delete disk_manager;
   delete bpm;
-  remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveFiles("test.db");
+}
+
+// Searches run concurrently with splitting inserts and must always find the keys inserted before they started.
+TEST(BPlusTreeConcurrentTest, SearchDuringInsertTest) {
+  // create KeyComparator and index schema
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(2000, disk_manager);
+  // create b+ tree with small nodes, so that the inserts split a lot
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 4, 4);
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+  // first, populate index with the even keys
+  std::vector<int64_t> keys;
+  std::vector<int64_t> new_keys;
+  for (int64_t key = 1; key <= 1000; key++) {
+    (key % 2 == 0 ? keys : new_keys).push_back(key);
+  }
+  InsertHelper(&tree, keys);
+
+  std::atomic<bool> done{false};
+  std::vector<std::thread> readers;
+  for (int i = 0; i < 3; i++) {
+    readers.emplace_back([&tree, &keys, &done]() {
+      GenericKey<8> index_key;
+      std::vector<RID> rids;
+      while (!done) {
+        for (auto key : keys) {
+          rids.clear();
+          index_key.SetFromInteger(key);
+          ASSERT_TRUE(tree.GetValue(index_key, &rids));
+          ASSERT_EQ(rids[0].GetSlotNum(), key);
+        }
+      }
+    });
+  }
+  // concurrent insert of the odd keys
+  LaunchParallelTest(2, InsertHelperSplit, &tree, new_keys, 2);
+  done = true;
+  for (auto &reader : readers) {
+    reader.join();
+  }
+
+  std::vector<RID> rids;
+  GenericKey<8> index_key;
+  for (int64_t key = 1; key <= 1000; key++) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(tree.GetValue(index_key, &rids));
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete disk_manager;
+  delete bpm;
+  DiskManager::RemoveFiles("test.db");
 }
 
 }  // namespace bustub
@@ -2,11 +2,12 @@
  * b_plus_tree_insert_test.cpp
  */
 
+#include <unistd.h>
 #include <algorithm>
 #include <cstdio>
 
 #include "b_plus_tree_test_util.h"  // NOLINT
-#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
 #include "gtest/gtest.h"
 #include "storage/index/b_plus_tree.h"
 
@@ -18,7 +19,7 @@ TEST(BPlusTreeTests, InsertTest1) {
   GenericComparator<8> comparator(key_schema);
 
   DiskManager *disk_manager = new DiskManager("test.db");
-  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
   // create b+ tree
   BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 2, 3);
   GenericKey<8> index_key;
@@ -70,8 +71,7 @@ TEST(BPlusTreeTests, InsertTest1) {
   delete transaction;
   delete disk_manager;
   delete bpm;
-  remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveFiles("test.db");
 }
 
 TEST(BPlusTreeTests, InsertTest2) {
@@ -80,7 +80,7 @@ TEST(BPlusTreeTests, InsertTest2) {
   GenericComparator<8> comparator(key_schema);
 
   DiskManager *disk_manager = new DiskManager("test.db");
-  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
   // create b+ tree
   BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
   GenericKey<8> index_key;
@@ -139,7 +139,56 @@ TEST(BPlusTreeTests, InsertTest2) {
   delete transaction;
   delete disk_manager;
   delete bpm;
-  remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveFiles("test.db");
 }
+
+TEST(BPlusTreeTests, DropTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(500, disk_manager);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 4, 5);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> other("bar_pk", bpm, comparator, 4, 5);
+  GenericKey<8> index_key;
+  RID rid;
+  Transaction *transaction = new Transaction(0);
+
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  for (int64_t key = 1; key <= 200; key++) {
+    rid.Set(static_cast<int32_t>(key >> 32), key & 0xFFFFFFFF);
+    index_key.SetFromInteger(key);
+    tree.Insert(index_key, rid, transaction);
+    other.Insert(index_key, rid, transaction);
+  }
+  // every index lives in a segment file of its own
+  segment_id_t segment_id = DiskManager::SegmentOf(tree.GetRootPageId());
+  EXPECT_NE(0, segment_id);
+  EXPECT_NE(segment_id, DiskManager::SegmentOf(other.GetRootPageId()));
+  bpm->FlushAllPages();
+
+  tree.Drop();
+  EXPECT_TRUE(tree.IsEmpty());
+  std::string segment_file = "test." + std::to_string(segment_id) + ".db";
+  EXPECT_NE(0, access(segment_file.c_str(), F_OK));
+  std::vector<RID> rids;
+  index_key.SetFromInteger(100);
+  EXPECT_TRUE(other.GetValue(index_key, &rids));
+
+  // a dropped tree starts over in a new segment
+  index_key.SetFromInteger(1);
+  tree.Insert(index_key, rid, transaction);
+  EXPECT_NE(segment_id, DiskManager::SegmentOf(tree.GetRootPageId()));
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete transaction;
+  delete disk_manager;
+  delete bpm;
+  DiskManager::RemoveFiles("test.db");
+}
+
 }  // namespace bustub
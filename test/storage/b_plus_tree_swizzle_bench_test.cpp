@@ -0,0 +1,114 @@
+/**
+ * b_plus_tree_swizzle_bench_test.cpp
+ *
+ * Benchmark of swizzled child references in the B+ tree descent.
+ *
+ * A descent pins every node on its way down. Through FetchPage that is a page table lookup plus the pin, through a
+ * swizzled reference (FetchSwizzledPage) the parent already knows the child's frame and only the pin is left.
+ * The first number is that per-node cost on a hot page, the second the latency of a point lookup on a hot index,
+ * next to a std::map lookup of the same keys as the in-memory reference.
+ *
+ * Configuration:
+ *    per node: 1000000 pins and unpins of one resident page
+ *    lookups: 200000 GenericKey<8> keys, all resident, looked up in random order
+ *
+ * Result (default build flags, no -O):
+ * [BENCHMARK: SwizzleBenchTest.PointLookupBenchmark] per node: FetchPage 0.29 us, swizzled 0.23 us
+ * [BENCHMARK: SwizzleBenchTest.PointLookupBenchmark] lookup: B+ tree 7.50 us, std::map 1.23 us
+ * The lookup took 7.68 us with swizzling turned off: at 3 levels the saved page table lookups are lost in the
+ * key comparisons, which went through GenericComparator and Value for every probe of the binary searches.
+ * Since the keys are stored encoded by KeyNormalizer a probe is one integer compare, and the lookup takes 2.95 us.
+ */
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "b_plus_tree_test_util.h"  // NOLINT
+#include "buffer/buffer_pool_manager_instance.h"
+#include "concurrency/transaction.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(SwizzleBenchTest, PointLookupBenchmark) {
+  const size_t num_pins = 1000000;
+  const int64_t num_keys = 200000;
+  DiskManager::RemoveFiles("swizzle_bench.db");
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  auto *disk_manager = new DiskManager("swizzle_bench.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(5000, disk_manager);
+  page_id_t header_page_id;
+  Page *header_page = bpm->NewPage(&header_page_id);
+
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < num_pins; i++) {
+    bpm->FetchPage(header_page_id);
+    bpm->UnpinPage(header_page_id, false);
+  }
+  double fetch_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < num_pins; i++) {
+    bpm->FetchSwizzledPage(header_page, header_page_id);
+    bpm->UnpinPage(header_page_id, false);
+  }
+  double swizzled_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("swizzle_pk", bpm, comparator);
+  auto *transaction = new Transaction(0);
+  std::map<int64_t, RID> map;
+  std::vector<int64_t> keys(num_keys);
+  std::iota(keys.begin(), keys.end(), 0);
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+  GenericKey<8> index_key;
+  for (auto key : keys) {
+    RID rid(static_cast<int32_t>(key >> 16), static_cast<uint32_t>(key & 0xFFFF));
+    index_key.SetFromInteger(key);
+    tree.Insert(index_key, rid, transaction);
+    map.emplace(key, rid);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(15721));
+
+  std::vector<RID> rids;
+  start = std::chrono::steady_clock::now();
+  for (auto key : keys) {
+    index_key.SetFromInteger(key);
+    tree.GetValue(index_key, &rids);
+  }
+  double tree_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  EXPECT_EQ(rids.size(), num_keys);
+  size_t found = 0;
+  start = std::chrono::steady_clock::now();
+  for (auto key : keys) {
+    found += map.count(key);
+  }
+  double map_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  EXPECT_EQ(found, num_keys);
+
+  std::stringstream ss;
+  ss << std::fixed << std::setprecision(2) << "[BENCHMARK: SwizzleBenchTest.PointLookupBenchmark] per node: FetchPage "
+     << fetch_seconds * 1e6 / num_pins << " us, swizzled " << swizzled_seconds * 1e6 / num_pins << " us"
+     << std::endl
+     << "[BENCHMARK: SwizzleBenchTest.PointLookupBenchmark] lookup: B+ tree " << tree_seconds * 1e6 / num_keys
+     << " us, std::map " << map_seconds * 1e6 / num_keys << " us" << std::endl;
+  std::cout << ss.str();
+
+  bpm->UnpinPage(header_page_id, true);
+  delete transaction;
+  delete bpm;
+  delete disk_manager;
+  delete key_schema;
+  DiskManager::RemoveFiles("swizzle_bench.db");
+}
+
+}  // namespace bustub
@@ -10,7 +10,12 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <sys/stat.h>
+#include <cstdlib>
 #include <cstring>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
 
 #include "common/exception.h"
 #include "gtest/gtest.h"
@@ -21,16 +26,14 @@ namespace bustub {
 class DiskManagerTest : public ::testing::Test {
  protected:
   // This function is called before every test.
-  void SetUp() override {
-    remove("test.db");
-    remove("test.log");
-  }
+  void SetUp() override { DiskManager::RemoveFiles("test.db"); }
 
   // This function is called after every test.
-  void TearDown() override {
-    remove("test.db");
-    remove("test.log");
-  };
+  void TearDown() override { DiskManager::RemoveFiles("test.db"); };
+
+  static std::string SegmentFile(segment_id_t segment_id, const char *extension) {
+    return "test." + std::to_string(segment_id) + extension;
+  }
 };
 
 // NOLINTNEXTLINE
@@ -55,6 +58,85 @@ TEST_F(DiskManagerTest, ReadWritePageTest) {
   dm.ShutDown();
 }
 
+// NOLINTNEXTLINE
+// With O_DIRECT, buffers the device cannot take as they are go through an aligned copy.
+TEST_F(DiskManagerTest, DirectIoAlignmentTest) {
+  std::string db_file("test.db");
+  auto dm = DiskManager(db_file, true);
+  // opening the file asks the kernel what alignment it needs
+  dm.WritePage(0, std::vector<char>(PAGE_SIZE, 'x').data());
+  if (dm.IsDirectIo()) {
+    size_t alignment = dm.GetDirectIoAlignment();
+    EXPECT_EQ(0, alignment & (alignment - 1));
+    EXPECT_LE(alignment, PAGE_SIZE);
+  }
+
+  // one byte past a page boundary is misaligned for any device
+  auto *memory = static_cast<char *>(aligned_alloc(PAGE_SIZE, 3 * PAGE_SIZE));
+  char *data = memory + 1;
+  char *buf = memory + PAGE_SIZE + 1;
+  for (page_id_t page_id = 1; page_id < 4; page_id++) {
+    std::memset(data, 'a' + page_id, PAGE_SIZE);
+    dm.WritePage(page_id, data);
+  }
+  for (page_id_t page_id = 1; page_id < 4; page_id++) {
+    dm.ReadPage(page_id, buf);
+    EXPECT_EQ('a' + page_id, buf[0]);
+    EXPECT_EQ('a' + page_id, buf[PAGE_SIZE - 1]);
+  }
+
+  // Scenario: a segment created later decides its mode when its file is opened, and bounces on its own.
+  segment_id_t segment_id = dm.CreateSegment();
+  EXPECT_EQ(dm.IsDirectIo(), dm.IsDirectIo(segment_id));
+  page_id_t segment_page = DiskManager::MakePageId(segment_id, 0);
+  std::memset(data, 'z', PAGE_SIZE);
+  dm.WritePage(segment_page, data);
+  dm.ReadPage(segment_page, buf);
+  EXPECT_EQ('z', buf[0]);
+  EXPECT_EQ('z', buf[PAGE_SIZE - 1]);
+  free(memory);
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, ConcurrentReadWritePageTest) {
+  const int num_threads = 4;
+  const int pages_per_thread = 64;
+  std::string db_file("test.db");
+  auto dm = DiskManager(db_file);
+
+  // every thread owns the pages page_id % num_threads == tid and fills them with its own byte pattern
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([&dm, tid] {
+      char data[PAGE_SIZE];
+      char buf[PAGE_SIZE];
+      for (int i = 0; i < pages_per_thread; i++) {
+        page_id_t page_id = i * num_threads + tid;
+        std::memset(data, 'a' + (page_id % 26), sizeof(data));
+        dm.WritePage(page_id, data);
+        dm.ReadPage(page_id, buf);
+        EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  dm.SyncPages();
+  EXPECT_EQ(num_threads * pages_per_thread, dm.GetNumWrites());
+
+  char buf[PAGE_SIZE];
+  for (page_id_t page_id = 0; page_id < num_threads * pages_per_thread; page_id++) {
+    dm.ReadPage(page_id, buf);
+    EXPECT_EQ('a' + (page_id % 26), buf[0]);
+    EXPECT_EQ('a' + (page_id % 26), buf[PAGE_SIZE - 1]);
+  }
+
+  dm.ShutDown();
+}
+
 // NOLINTNEXTLINE
 TEST_F(DiskManagerTest, ReadWriteLogTest) {
   char buf[16] = {0};
@@ -72,6 +154,201 @@ TEST_F(DiskManagerTest, ReadWriteLogTest) {
   dm.ShutDown();
 }
 
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, AllocateReusePageTest) {
+  std::string db_file("test.db");
+  auto dm = DiskManager(db_file);
+  for (page_id_t i = 0; i < 10; i++) {
+    EXPECT_EQ(i, dm.AllocatePage());
+  }
+  dm.DeallocatePage(3);
+  dm.DeallocatePage(7);
+  EXPECT_FALSE(dm.IsAllocated(3));
+  EXPECT_EQ(3, dm.AllocatePage());
+  EXPECT_EQ(7, dm.AllocatePage());
+  EXPECT_EQ(10, dm.AllocatePage());
+  EXPECT_EQ(11, dm.AllocatePage());
+
+  // striped allocation only returns ids of its residue class
+  dm.DeallocatePage(4);
+  dm.DeallocatePage(5);
+  EXPECT_EQ(5, dm.AllocatePage(4, 1));
+  EXPECT_EQ(13, dm.AllocatePage(4, 1));
+  EXPECT_EQ(4, dm.AllocatePage(4, 0));
+  EXPECT_EQ(12, dm.AllocatePage(4, 0));
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, ExtentAllocationTest) {
+  std::string db_file("test.db");
+  const page_id_t extent_pages = 64;
+  auto dm = DiskManager(db_file, false, extent_pages * PAGE_SIZE);
+  EXPECT_EQ(0, dm.AllocatePage());
+  EXPECT_EQ(1, dm.AllocatePage());
+
+  // each object grows in an extent of its own, whoever allocates in between
+  EXPECT_EQ(extent_pages, dm.AllocatePage(0));
+  EXPECT_EQ(2 * extent_pages, dm.AllocatePage(1));
+  EXPECT_EQ(extent_pages + 1, dm.AllocatePage(extent_pages));
+  EXPECT_EQ(2, dm.AllocatePage());
+  EXPECT_EQ(2 * extent_pages + 1, dm.AllocatePage(2 * extent_pages));
+  EXPECT_EQ(extent_pages + 2, dm.AllocatePage(extent_pages + 1));
+  // the file is preallocated to the end of the last extent, or grows as pages are written without fallocate
+  struct stat stat_buf;
+  ASSERT_EQ(0, stat(db_file.c_str(), &stat_buf));
+  EXPECT_TRUE(stat_buf.st_size == 3 * extent_pages * PAGE_SIZE || stat_buf.st_size == 0);
+
+  // pages without a hint skip the owned extents
+  for (page_id_t i = 3; i < extent_pages; i++) {
+    EXPECT_EQ(i, dm.AllocatePage());
+  }
+  EXPECT_EQ(3 * extent_pages, dm.AllocatePage());
+
+  // an object that filled its extent moves on to a new one
+  for (page_id_t i = 2; i < extent_pages; i++) {
+    EXPECT_EQ(2 * extent_pages + i, dm.AllocatePage(2 * extent_pages + i - 1));
+  }
+  EXPECT_EQ(4 * extent_pages, dm.AllocatePage(3 * extent_pages - 1));
+
+  // dropping an object releases its extent to everyone
+  for (page_id_t i = 0; i < 3; i++) {
+    dm.DeallocatePage(extent_pages + i);
+  }
+  EXPECT_EQ(extent_pages, dm.AllocatePage());
+  // a hint in a shared extent starts the object's first extent
+  EXPECT_EQ(5 * extent_pages, dm.AllocatePage(3 * extent_pages));
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, FreeSpaceMapPersistTest) {
+  std::string db_file("test.db");
+  char data[PAGE_SIZE] = {0};
+  {
+    auto dm = DiskManager(db_file);
+    for (int i = 0; i < 5; i++) {
+      dm.WritePage(dm.AllocatePage(), data);
+    }
+    dm.DeallocatePage(1);
+    dm.ShutDown();
+  }
+  {
+    auto dm = DiskManager(db_file);
+    EXPECT_TRUE(dm.IsAllocated(0));
+    EXPECT_FALSE(dm.IsAllocated(1));
+    EXPECT_EQ(1, dm.AllocatePage());
+    EXPECT_EQ(5, dm.AllocatePage());
+    dm.ShutDown();
+  }
+  // an emptied database file starts over whatever the old map says
+  remove("test.db");
+  auto dm = DiskManager(db_file);
+  EXPECT_FALSE(dm.IsAllocated(0));
+  EXPECT_EQ(0, dm.AllocatePage());
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+// A map left behind without a sync never hands out a page that was written.
+TEST_F(DiskManagerTest, FreeSpaceMapCrashTest) {
+  std::string db_file("test.db");
+  char data[PAGE_SIZE] = {0};
+  {
+    // closing without ShutDown still saves the map
+    auto dm = DiskManager(db_file);
+    for (int i = 0; i < 5; i++) {
+      dm.WritePage(dm.AllocatePage(), data);
+    }
+    dm.DeallocatePage(1);
+  }
+  {
+    auto dm = DiskManager(db_file);
+    EXPECT_FALSE(dm.IsAllocated(1));
+    EXPECT_EQ(1, dm.AllocatePage());
+    dm.ShutDown();
+  }
+  // a process that dies after allocating and writing pages
+  EXPECT_EXIT(
+      {
+        DiskManager dm(db_file);
+        for (int i = 0; i < 3; i++) {
+          dm.WritePage(dm.AllocatePage(), data);
+        }
+        std::_Exit(0);
+      },
+      ::testing::ExitedWithCode(0), "");
+  {
+    auto dm = DiskManager(db_file);
+    for (page_id_t page_id = 0; page_id < 8; page_id++) {
+      EXPECT_TRUE(dm.IsAllocated(page_id));
+    }
+    EXPECT_EQ(8, dm.AllocatePage());
+    dm.ShutDown();
+  }
+  // without a map every page of the file may be in use
+  remove("test.fsm");
+  auto dm = DiskManager(db_file);
+  for (page_id_t page_id = 0; page_id < 9; page_id++) {
+    EXPECT_TRUE(dm.IsAllocated(page_id));
+  }
+  EXPECT_LE(9, dm.AllocatePage());
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, SegmentTest) {
+  std::string db_file("test.db");
+  char buf[PAGE_SIZE] = {0};
+  char data[PAGE_SIZE] = {0};
+  std::strncpy(data, "A test string.", sizeof(data));
+  segment_id_t segment_id;
+  page_id_t page_id;
+  {
+    auto dm = DiskManager(db_file);
+    EXPECT_EQ(0, dm.AllocatePage());
+    // ids of segment files other tests left behind are skipped
+    segment_id = dm.CreateSegment();
+    EXPECT_NE(INVALID_SEGMENT_ID, segment_id);
+    // the first page of a segment is page 0 of its file
+    page_id = dm.AllocatePage(DiskManager::MakePageId(segment_id, 0));
+    EXPECT_EQ(DiskManager::MakePageId(segment_id, 0), page_id);
+    EXPECT_EQ(segment_id, DiskManager::SegmentOf(page_id));
+    EXPECT_EQ(page_id + 1, dm.AllocatePage(page_id));
+    // allocations without a hint stay in the db file
+    EXPECT_EQ(1, dm.AllocatePage());
+    dm.WritePage(page_id + 1, data);
+    dm.ShutDown();
+  }
+  struct stat stat_buf;
+  ASSERT_EQ(0, stat(SegmentFile(segment_id, ".db").c_str(), &stat_buf));
+  {
+    // a segment of a reopened database is opened on first use, new segments get new ids
+    auto dm = DiskManager(db_file);
+    dm.ReadPage(page_id + 1, buf);
+    EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+    EXPECT_TRUE(dm.IsAllocated(page_id));
+    EXPECT_EQ(segment_id + 1, dm.CreateSegment());
+
+    // dropping a segment removes its file and all its pages
+    dm.DropSegment(segment_id);
+    EXPECT_NE(0, stat(SegmentFile(segment_id, ".db").c_str(), &stat_buf));
+    EXPECT_NE(0, stat(SegmentFile(segment_id, ".fsm").c_str(), &stat_buf));
+    EXPECT_FALSE(dm.IsAllocated(page_id));
+    EXPECT_TRUE(dm.IsAllocated(0));
+    // a page of a dropped segment reads as zeros, whatever the buffer held
+    dm.ReadPage(page_id + 1, buf);
+    EXPECT_EQ(0, buf[0]);
+    dm.ShutDown();
+  }
+  // the segments of a removed database are left alone, a new database does not reuse their ids
+  remove("test.db");
+  auto dm = DiskManager(db_file);
+  EXPECT_EQ(0, stat(SegmentFile(segment_id + 1, ".db").c_str(), &stat_buf));
+  EXPECT_EQ(segment_id + 2, dm.CreateSegment());
+  dm.ShutDown();
+}
+
 // NOLINTNEXTLINE
 TEST_F(DiskManagerTest, ThrowBadFileTest) { EXPECT_THROW(DiskManager("dev/null\\/foo/bar/baz/test.db"), Exception); }
 
@@ -0,0 +1,133 @@
+/**
+ * generic_key_test.cpp
+ */
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "storage/index/generic_key.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+namespace {
+/** @return the sign of comparing lhs with rhs as Values */
+int CompareValues(const Value &lhs, const Value &rhs) {
+  if (lhs.CompareLessThan(rhs) == CmpBool::CmpTrue) {
+    return -1;
+  }
+  return lhs.CompareGreaterThan(rhs) == CmpBool::CmpTrue ? 1 : 0;
+}
+
+int Sign(int order) { return (order > 0) - (order < 0); }
+
+/**
+ * Store each row as a key of key_schema, then check that the comparator orders the keys like their Values and that
+ * ToValue gives the Values back.
+ */
+template <size_t KeySize>
+void CheckOrder(Schema *key_schema, const std::vector<std::vector<Value>> &rows) {
+  GenericComparator<KeySize> comparator(key_schema);
+  std::vector<GenericKey<KeySize>> keys(rows.size());
+  for (size_t i = 0; i < rows.size(); i++) {
+    keys[i].SetFromKey(Tuple(rows[i], key_schema), *key_schema);
+    for (uint32_t column = 0; column < key_schema->GetColumnCount(); column++) {
+      EXPECT_EQ(CmpBool::CmpTrue, keys[i].ToValue(key_schema, column).CompareEquals(rows[i][column]));
+    }
+  }
+  for (size_t i = 0; i < rows.size(); i++) {
+    for (size_t j = 0; j < rows.size(); j++) {
+      int expected = 0;
+      for (uint32_t column = 0; column < key_schema->GetColumnCount() && expected == 0; column++) {
+        expected = CompareValues(rows[i][column], rows[j][column]);
+      }
+      EXPECT_EQ(expected, Sign(comparator(keys[i], keys[j])));
+    }
+  }
+}
+}  // namespace
+
+// NOLINTNEXTLINE
+// Encoded integer keys compare like their Values, across the sign and the whole range.
+TEST(GenericKeyTest, IntegerKeyTest) {
+  std::mt19937_64 random(15445);
+  std::vector<int64_t> numbers{0, 1, -1, 255, 256, -256, BUSTUB_INT64_MAX, BUSTUB_INT64_MIN + 1};
+  for (int i = 0; i < 40; i++) {
+    numbers.push_back(static_cast<int64_t>(random()) >> (i % 60));
+  }
+
+  Schema bigint_schema({Column("a", TypeId::BIGINT)});
+  std::vector<std::vector<Value>> rows;
+  for (auto number : numbers) {
+    rows.push_back({ValueFactory::GetBigIntValue(number)});
+  }
+  CheckOrder<8>(&bigint_schema, rows);
+  CheckOrder<16>(&bigint_schema, rows);
+
+  Schema integer_schema({Column("a", TypeId::INTEGER)});
+  Schema smallint_schema({Column("a", TypeId::SMALLINT)});
+  Schema tinyint_schema({Column("a", TypeId::TINYINT)});
+  std::vector<std::vector<Value>> integer_rows;
+  std::vector<std::vector<Value>> smallint_rows;
+  std::vector<std::vector<Value>> tinyint_rows;
+  for (auto number : numbers) {
+    integer_rows.push_back({ValueFactory::GetIntegerValue(static_cast<int32_t>(number % BUSTUB_INT32_MAX))});
+    smallint_rows.push_back({ValueFactory::GetSmallIntValue(static_cast<int16_t>(number % BUSTUB_INT16_MAX))});
+    tinyint_rows.push_back({ValueFactory::GetTinyIntValue(static_cast<int8_t>(number % BUSTUB_INT8_MAX))});
+  }
+  CheckOrder<4>(&integer_schema, integer_rows);
+  CheckOrder<8>(&smallint_schema, smallint_rows);
+  CheckOrder<8>(&tinyint_schema, tinyint_rows);
+
+  // the test helpers store a bigint key
+  GenericKey<8> key;
+  for (auto number : numbers) {
+    key.SetFromInteger(number);
+    EXPECT_EQ(number, key.ToString());
+    EXPECT_EQ(number, key.ToValue(&bigint_schema, 0).GetAs<int64_t>());
+  }
+}
+
+// NOLINTNEXTLINE
+// Decimals and keys of several columns.
+TEST(GenericKeyTest, MixedKeyTest) {
+  std::vector<double> decimals{0.0, -0.5, 0.5, 1e300, -1e300, 3.25, -3.25, 1e-300, -1e-300, 42.0};
+  Schema decimal_schema({Column("a", TypeId::DECIMAL)});
+  std::vector<std::vector<Value>> rows;
+  for (auto decimal : decimals) {
+    rows.push_back({ValueFactory::GetDecimalValue(decimal)});
+  }
+  CheckOrder<8>(&decimal_schema, rows);
+
+  // (integer, bigint, boolean) keys: the first column decides unless it ties
+  Schema schema({Column("a", TypeId::INTEGER), Column("b", TypeId::BIGINT), Column("c", TypeId::BOOLEAN)});
+  rows.clear();
+  for (int32_t a : {-7, 0, 7}) {
+    for (int64_t b : {-1000000000000L, -1L, 0L, 5L}) {
+      for (bool c : {false, true}) {
+        rows.push_back({ValueFactory::GetIntegerValue(a), ValueFactory::GetBigIntValue(b),
+                        ValueFactory::GetBooleanValue(c)});
+      }
+    }
+  }
+  std::shuffle(rows.begin(), rows.end(), std::mt19937(15445));
+  CheckOrder<16>(&schema, rows);
+}
+
+// NOLINTNEXTLINE
+// Keys with a VARCHAR column keep the tuple layout and are compared column by column.
+TEST(GenericKeyTest, VarcharKeyTest) {
+  Schema schema({Column("a", TypeId::INTEGER), Column("b", TypeId::VARCHAR, 16)});
+  std::vector<std::vector<Value>> rows;
+  for (int32_t a : {-3, 3}) {
+    for (auto b : {"", "a", "ab", "b"}) {
+      rows.push_back({ValueFactory::GetIntegerValue(a), ValueFactory::GetVarcharValue(b)});
+    }
+  }
+  CheckOrder<32>(&schema, rows);
+}
+
+}  // namespace bustub
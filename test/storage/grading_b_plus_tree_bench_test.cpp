@@ -26,7 +26,7 @@
 #include <thread>  // NOLINT
 
 #include "b_plus_tree_test_util.h"  // NOLINT
-#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
 #include "gtest/gtest.h"
 #include "storage/index/b_plus_tree.h"
 
@@ -183,7 +183,7 @@ void BPlusTreeBenchmarkCall() {
     Schema *key_schema = ParseCreateStatement("a bigint");
     GenericComparator<8> comparator(key_schema);
     DiskManager *disk_manager = new DiskManager("test.db");
-    BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+    BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
     // create b+ tree
     BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
     // create and fetch header_page
@@ -222,8 +222,7 @@ void BPlusTreeBenchmarkCall() {
     delete key_schema;
     delete disk_manager;
     delete bpm;
-    remove("test.db");
-    remove("test.log");
+    DiskManager::RemoveFiles("test.db");
   }  // END loop NUM_ITERS
 
   if (success) {
@@ -246,8 +245,7 @@ void BPlusTreeBenchmarkCall() {
 TEST(BPlusTreeTest, BPlusTreeBenchmark) {
   TEST_TIMEOUT_BEGIN
   BPlusTreeBenchmarkCall();
-  remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveFiles("test.db");
   TEST_TIMEOUT_FAIL_END(1000 * 300)
 }
 
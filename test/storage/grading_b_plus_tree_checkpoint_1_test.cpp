@@ -14,7 +14,7 @@
 #include <random>
 
 #include "b_plus_tree_test_util.h"  // NOLINT
-#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
 #include "gtest/gtest.h"
 #include "storage/index/b_plus_tree.h"
 
@@ -32,7 +32,7 @@ TEST(BPlusTreeTests, SplitTest) {
   GenericComparator<8> comparator(key_schema);
 
   DiskManager *disk_manager = new DiskManager("test.db");
-  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
   // create b+ tree
   BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 2, 3);
   GenericKey<8> index_key;
@@ -80,8 +80,7 @@ TEST(BPlusTreeTests, SplitTest) {
   delete disk_manager;
   delete bpm;
   delete key_schema;
-  remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveFiles("test.db");
 }
 
 /*
@@ -96,7 +95,7 @@ TEST(BPlusTreeTests, InsertTest1) {
   GenericComparator<8> comparator(key_schema);
 
   DiskManager *disk_manager = new DiskManager("test.db");
-  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
   // create b+ tree
   BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
   GenericKey<8> index_key;
@@ -133,8 +132,7 @@ TEST(BPlusTreeTests, InsertTest1) {
   delete transaction;
   delete disk_manager;
   delete bpm;
-  remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveFiles("test.db");
 }
 
 /*
@@ -149,7 +147,7 @@ TEST(BPlusTreeTests, InsertTest2) {
   GenericComparator<8> comparator(key_schema);
 
   DiskManager *disk_manager = new DiskManager("test.db");
-  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
   // create b+ tree
   BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
   GenericKey<8> index_key;
@@ -186,8 +184,7 @@ TEST(BPlusTreeTests, InsertTest2) {
   delete transaction;
   delete disk_manager;
   delete bpm;
-  remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveFiles("test.db");
 }
 
 /*
@@ -202,7 +199,7 @@ TEST(BPlusTreeTests, ScaleTest) {
   GenericComparator<8> comparator(key_schema);
 
   DiskManager *disk_manager = new DiskManager("test.db");
-  BufferPoolManager *bpm = new BufferPoolManager(30, disk_manager);
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(30, disk_manager);
   // create b+ tree
   BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
   GenericKey<8> index_key;
@@ -245,8 +242,7 @@ TEST(BPlusTreeTests, ScaleTest) {
   delete transaction;
   delete disk_manager;
   delete bpm;
-  remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveFiles("test.db");
 }
 
 }  // namespace bustub
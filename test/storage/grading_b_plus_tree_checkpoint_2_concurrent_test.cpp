@@ -19,7 +19,7 @@
 #include <thread>  // NOLINT
 
 #include "b_plus_tree_test_util.h"  // NOLINT
-#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
 #include "gtest/gtest.h"
 #include "storage/index/b_plus_tree.h"
 
@@ -141,7 +141,7 @@ void InsertTest1Call() {
     GenericComparator<8> comparator(key_schema);
 
     DiskManager *disk_manager = new DiskManager("test.db");
-    BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+    BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
     // create b+ tree
     BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
     // create and fetch header_page
@@ -184,8 +184,7 @@ void InsertTest1Call() {
     delete key_schema;
     delete disk_manager;
     delete bpm;
-    remove("test.db");
-    remove("test.log");
+    DiskManager::RemoveFiles("test.db");
   }
 }
 
@@ -196,7 +195,7 @@ void InsertTest2Call() {
     GenericComparator<8> comparator(key_schema);
 
     DiskManager *disk_manager = new DiskManager("test.db");
-    BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+    BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
     // create b+ tree
     BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
     // create and fetch header_page
@@ -241,8 +240,7 @@ void InsertTest2Call() {
     delete key_schema;
     delete disk_manager;
     delete bpm;
-    remove("test.db");
-    remove("test.log");
+    DiskManager::RemoveFiles("test.db");
   }
 }
 
@@ -253,7 +251,7 @@ void DeleteTest1Call() {
     GenericComparator<8> comparator(key_schema);
 
     DiskManager *disk_manager = new DiskManager("test.db");
-    BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+    BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
     // create b+ tree
     BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
     // create and fetch header_page
@@ -285,8 +283,7 @@ void DeleteTest1Call() {
     delete key_schema;
     delete disk_manager;
     delete bpm;
-    remove("test.db");
-    remove("test.log");
+    DiskManager::RemoveFiles("test.db");
   }
 }
 
@@ -297,7 +294,7 @@ void DeleteTest2Call() {
     GenericComparator<8> comparator(key_schema);
 
     DiskManager *disk_manager = new DiskManager("test.db");
-    BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+    BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
     // create b+ tree
     BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
     // create and fetch header_page
@@ -330,8 +327,7 @@ void DeleteTest2Call() {
     delete key_schema;
     delete disk_manager;
     delete bpm;
-    remove("test.db");
-    remove("test.log");
+    DiskManager::RemoveFiles("test.db");
   }
 }
 
@@ -342,7 +338,7 @@ void MixTest1Call() {
     GenericComparator<8> comparator(key_schema);
 
     DiskManager *disk_manager = new DiskManager("test.db");
-    BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+    BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
     // create b+ tree
     BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
 
@@ -392,8 +388,7 @@ void MixTest1Call() {
     delete key_schema;
     delete disk_manager;
     delete bpm;
-    remove("test.db");
-    remove("test.log");
+    DiskManager::RemoveFiles("test.db");
   }
 }
 
@@ -404,7 +399,7 @@ void MixTest2Call() {
     GenericComparator<8> comparator(key_schema);
 
     DiskManager *disk_manager = new DiskManager("test.db");
-    BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+    BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
     // create b+ tree
     BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
     // create and fetch header_page
@@ -461,8 +456,7 @@ void MixTest2Call() {
     delete key_schema;
     delete disk_manager;
     delete bpm;
-    remove("test.db");
-    remove("test.log");
+    DiskManager::RemoveFiles("test.db");
   }
 }
 
@@ -473,7 +467,7 @@ void MixTest3Call() {
     GenericComparator<8> comparator(key_schema);
 
     DiskManager *disk_manager = new DiskManager("test.db");
-    BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+    BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
     // create b+ tree
     BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
 
@@ -522,8 +516,7 @@ void MixTest3Call() {
     delete key_schema;
     delete disk_manager;
     delete bpm;
-    remove("test.db");
-    remove("test.log");
+    DiskManager::RemoveFiles("test.db");
   }
 }
 
@@ -534,8 +527,7 @@ void MixTest3Call() {
 TEST(BPlusTreeConcurrentTest, InsertTest1) {
   TEST_TIMEOUT_BEGIN
   InsertTest1Call();
-  remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveFiles("test.db");
   TEST_TIMEOUT_FAIL_END(1000 * 600)
 }
 
@@ -547,8 +539,7 @@ TEST(BPlusTreeConcurrentTest, InsertTest1) {
 TEST(BPlusTreeConcurrentTest, InsertTest2) {
   TEST_TIMEOUT_BEGIN
   InsertTest2Call();
-  remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveFiles("test.db");
   TEST_TIMEOUT_FAIL_END(1000 * 600)
 }
 
@@ -559,8 +550,7 @@ TEST(BPlusTreeConcurrentTest, InsertTest2) {
 TEST(BPlusTreeConcurrentTest, DeleteTest1) {
   TEST_TIMEOUT_BEGIN
   DeleteTest1Call();
-  remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveFiles("test.db");
   TEST_TIMEOUT_FAIL_END(1000 * 600)
 }
 
@@ -572,8 +562,7 @@ TEST(BPlusTreeConcurrentTest, DeleteTest1) {
 TEST(BPlusTreeConcurrentTest, DeleteTest2) {
   TEST_TIMEOUT_BEGIN
   DeleteTest2Call();
-  remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveFiles("test.db");
   TEST_TIMEOUT_FAIL_END(1000 * 600)
 }
 
@@ -587,8 +576,7 @@ TEST(BPlusTreeConcurrentTest, DeleteTest2) {
 TEST(BPlusTreeConcurrentTest, MixTest1) {
   TEST_TIMEOUT_BEGIN
   MixTest1Call();
-  remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveFiles("test.db");
   TEST_TIMEOUT_FAIL_END(1000 * 600)  // 600s的时限（10min）
 }
 
@@ -603,8 +591,7 @@ TEST(BPlusTreeConcurrentTest, MixTest1) {
 TEST(BPlusTreeConcurrentTest, MixTest2) {
   TEST_TIMEOUT_BEGIN
   MixTest2Call();
-  remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveFiles("test.db");
   TEST_TIMEOUT_FAIL_END(1000 * 600)
 }
 
@@ -618,8 +605,7 @@ TEST(BPlusTreeConcurrentTest, MixTest2) {
 TEST(BPlusTreeConcurrentTest, MixTest3) {
   TEST_TIMEOUT_BEGIN
   MixTest3Call();
-  remove("test.db");
-  remove("test.log");
+  DiskManager::RemoveFiles("test.db");
   TEST_TIMEOUT_FAIL_END(1000 * 600)
 }
 
@@ -0,0 +1,194 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// io_uring_disk_manager_test.cpp
+//
+// Identification: test/storage/io_uring_disk_manager_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/disk/io_uring_disk_manager.h"
+
+namespace bustub {
+
+class IoUringDiskManagerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    DiskManager::RemoveFiles("test.db");
+  }
+
+  void TearDown() override {
+    DiskManager::RemoveFiles("test.db");
+  };
+
+  /** @return the file descriptor of the (only) io_uring instance of the process, -1 if there is none */
+  static int FindRingFd() {
+    int ring_fd = -1;
+    DIR *dirp = opendir("/proc/self/fd");
+    if (dirp == nullptr) {
+      return ring_fd;
+    }
+    while (dirent *entry = readdir(dirp)) {
+      std::string path = std::string("/proc/self/fd/") + entry->d_name;
+      char target[64] = {0};
+      if (readlink(path.c_str(), target, sizeof(target) - 1) > 0 && std::strstr(target, "io_uring") != nullptr) {
+        ring_fd = std::stoi(entry->d_name);
+      }
+    }
+    closedir(dirp);
+    return ring_fd;
+  }
+};
+
+// NOLINTNEXTLINE
+TEST_F(IoUringDiskManagerTest, BatchReadWriteTest) {
+  const size_t num_pages = 100;
+  IoUringDiskManager dm("test.db", 16);
+
+  std::vector<std::vector<char>> pages(num_pages, std::vector<char>(PAGE_SIZE));
+  for (size_t i = 0; i < num_pages; i++) {
+    std::snprintf(pages[i].data(), PAGE_SIZE, "page %zu", i);
+  }
+
+  // more pages than the queue depth: keep it full, reap when it is
+  std::vector<IoCompletion> completions;
+  size_t next = 0;
+  while (next < num_pages || dm.InFlight() > 0) {
+    while (next < num_pages && dm.PrepareWrite(static_cast<page_id_t>(next), pages[next].data(), next)) {
+      next++;
+    }
+    dm.Submit();
+    dm.PollCompletions(&completions, 1);
+  }
+  ASSERT_EQ(num_pages, completions.size());
+  for (auto &completion : completions) {
+    EXPECT_EQ(PAGE_SIZE, completion.result_);
+  }
+  EXPECT_EQ(static_cast<int>(num_pages), dm.GetNumWrites());
+
+  // the synchronous interface sees the asynchronous writes
+  char buf[PAGE_SIZE];
+  dm.ReadPage(42, buf);
+  EXPECT_STREQ("page 42", buf);
+
+  // read back in batches of 16, one past the end of the file
+  std::vector<std::vector<char>> read_pages(num_pages + 1, std::vector<char>(PAGE_SIZE, 'x'));
+  completions.clear();
+  for (size_t begin = 0; begin <= num_pages; begin += 16) {
+    size_t end = std::min(begin + 16, num_pages + 1);
+    for (size_t i = begin; i < end; i++) {
+      ASSERT_TRUE(dm.PrepareRead(static_cast<page_id_t>(i), read_pages[i].data(), i));
+    }
+    EXPECT_EQ(end - begin, dm.Submit());
+    dm.PollCompletions(&completions, end - begin);
+  }
+  ASSERT_EQ(num_pages + 1, completions.size());
+  for (auto &completion : completions) {
+    EXPECT_EQ(PAGE_SIZE, completion.result_);
+    if (completion.tag_ < num_pages) {
+      EXPECT_EQ(0, std::memcmp(pages[completion.tag_].data(), read_pages[completion.tag_].data(), PAGE_SIZE));
+    } else {
+      // past the end of the file: zero filled
+      EXPECT_EQ(0, read_pages[completion.tag_][0]);
+      EXPECT_EQ(0, read_pages[completion.tag_][PAGE_SIZE - 1]);
+    }
+  }
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(IoUringDiskManagerTest, SubmitFailureTest) {
+  IoUringDiskManager dm("test.db", 8);
+  segment_id_t segment_id = dm.CreateSegment();
+  int ring_fd = FindRingFd();
+  ASSERT_NE(-1, ring_fd);
+  // io_uring_enter on anything but a ring fails without taking a request
+  int null_fd = open("/dev/null", O_RDWR);
+  ASSERT_EQ(ring_fd, dup2(null_fd, ring_fd));
+  close(null_fd);
+
+  std::vector<char> page(PAGE_SIZE, 'f');
+  for (uint64_t tag = 0; tag < 3; tag++) {
+    ASSERT_TRUE(dm.PrepareWrite(DiskManager::MakePageId(segment_id, static_cast<page_id_t>(tag)), page.data(), tag));
+  }
+  EXPECT_EQ(0, dm.Submit());
+  EXPECT_EQ(3, dm.InFlight());
+
+  // the refused requests complete with the error instead of being waited for
+  std::vector<IoCompletion> completions;
+  EXPECT_EQ(3, dm.PollCompletions(&completions, 3));
+  ASSERT_EQ(3, completions.size());
+  for (uint64_t tag = 0; tag < 3; tag++) {
+    EXPECT_EQ(tag, completions[tag].tag_);
+    EXPECT_GT(0, completions[tag].result_);
+  }
+  EXPECT_EQ(0, dm.InFlight());
+  // their slots and their hold on the segment are given back
+  for (uint64_t tag = 0; tag < 8; tag++) {
+    ASSERT_TRUE(dm.PrepareRead(DiskManager::MakePageId(segment_id, 0), page.data(), tag));
+  }
+  completions.clear();
+  EXPECT_EQ(8, dm.PollCompletions(&completions, 8));
+  dm.DropSegment(segment_id);
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(IoUringDiskManagerTest, RegisteredBufferPoolFramesTest) {
+  const size_t pool_size = 8;
+  IoUringDiskManager dm("test.db", 8);
+  auto *bpm = new BufferPoolManagerInstance(pool_size, &dm);
+
+  std::vector<char *> frames;
+  for (size_t i = 0; i < pool_size; i++) {
+    frames.push_back(bpm->GetPages()[i].GetData());
+  }
+  if (!dm.RegisterBuffers(frames)) {
+    // e.g. RLIMIT_MEMLOCK too low, fixed buffers are an optimization only
+    delete bpm;
+    GTEST_SKIP() << "io_uring buffer registration not permitted";
+  }
+
+  // write the pages through the buffer pool, then read them back from disk with fixed-buffer reads
+  std::vector<page_id_t> page_ids(pool_size);
+  for (size_t i = 0; i < pool_size; i++) {
+    Page *page = bpm->NewPage(&page_ids[i]);
+    ASSERT_NE(nullptr, page);
+    std::snprintf(page->GetData(), PAGE_SIZE, "frame page %d", page_ids[i]);
+    bpm->UnpinPage(page_ids[i], true);
+  }
+  bpm->FlushAllPages();
+  for (size_t i = 0; i < pool_size; i++) {
+    std::memset(frames[i], 0, PAGE_SIZE);
+    ASSERT_TRUE(dm.PrepareRead(page_ids[i], frames[i], i, static_cast<int>(i)));
+  }
+  std::vector<IoCompletion> completions;
+  dm.PollCompletions(&completions, pool_size);
+  ASSERT_EQ(pool_size, completions.size());
+  for (auto &completion : completions) {
+    EXPECT_EQ(PAGE_SIZE, completion.result_);
+    char expected[PAGE_SIZE];
+    std::snprintf(expected, PAGE_SIZE, "frame page %d", page_ids[completion.tag_]);
+    EXPECT_STREQ(expected, frames[completion.tag_]);
+  }
+
+  delete bpm;
+  dm.ShutDown();
+}
+
+}  // namespace bustub
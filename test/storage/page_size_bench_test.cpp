@@ -0,0 +1,192 @@
+/**
+ * page_size_bench_test.cpp
+ *
+ * Benchmark of index depth and scan throughput at the page size of the build (cmake -DBUSTUB_PAGE_SIZE=<bytes>).
+ *
+ * The buffer pool gets the same number of bytes whatever the page size, so a larger page means fewer frames.
+ * The index is built with random inserts, its depth is the number of pages a point lookup pins. The table is
+ * flushed and scanned through a fresh buffer pool, so every page of the scan is read from the file (page cache).
+ *
+ * Configuration:
+ *    buffer pool: 64 MiB
+ *    index: 200000 GenericKey<8> keys, inserted in random order, default leaf and internal max sizes
+ *    table: 20000 tuples of 108 bytes (bigint, varchar(96))
+ *
+ * Result (default build flags, no -O, so the scans are bound by per-tuple CPU rather than I/O):
+ * [BENCHMARK: PageSizeBenchTest.IndexDepthBenchmark] page size 4096: depth 3, 1104 leaf pages,
+ *    8.41 us per lookup, 0.35 M keys/s leaf scan
+ * [BENCHMARK: PageSizeBenchTest.IndexDepthBenchmark] page size 16384: depth 2, 256 leaf pages,
+ *    4.73 us per lookup, 0.67 M keys/s leaf scan
+ * [BENCHMARK: PageSizeBenchTest.IndexDepthBenchmark] page size 65536: depth 2, 64 leaf pages,
+ *    5.43 us per lookup, 0.50 M keys/s leaf scan
+ * [BENCHMARK: PageSizeBenchTest.TableScanBenchmark] page size 4096: 625 pages, 44.52 MB/s
+ * [BENCHMARK: PageSizeBenchTest.TableScanBenchmark] page size 16384: 154 pages, 62.17 MB/s
+ * [BENCHMARK: PageSizeBenchTest.TableScanBenchmark] page size 65536: 39 pages, 51.10 MB/s
+ */
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "b_plus_tree_test_util.h"  // NOLINT
+#include "buffer/buffer_pool_manager_instance.h"
+#include "concurrency/transaction.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree.h"
+#include "storage/table/table_heap.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+namespace {
+const size_t BENCH_POOL_BYTES = 64 << 20;
+const size_t BENCH_POOL_FRAMES = BENCH_POOL_BYTES / PAGE_SIZE;
+
+double SecondsSince(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void RemoveFiles(const std::string &base) { DiskManager::RemoveFiles(base + ".db"); }
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST(PageSizeBenchTest, IndexDepthBenchmark) {
+  const int64_t num_keys = 200000;
+  RemoveFiles("page_size_bench");
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  auto *disk_manager = new DiskManager("page_size_bench.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(BENCH_POOL_FRAMES, disk_manager);
+  page_id_t header_page_id;
+  bpm->NewPage(&header_page_id);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("bench_pk", bpm, comparator);
+  auto *transaction = new Transaction(0);
+
+  std::vector<int64_t> keys(num_keys);
+  std::iota(keys.begin(), keys.end(), 0);
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+  GenericKey<8> index_key;
+  for (auto key : keys) {
+    index_key.SetFromInteger(key);
+    tree.Insert(index_key, RID(static_cast<int32_t>(key >> 16), static_cast<uint32_t>(key & 0xFFFF)), transaction);
+  }
+
+  // walk down the leftmost path
+  int depth = 1;
+  page_id_t page_id = tree.GetRootPageId();
+  while (true) {
+    auto *node = reinterpret_cast<BPlusTreePage *>(bpm->FetchPage(page_id)->GetData());
+    bool is_leaf = node->IsLeafPage();
+    page_id_t child = is_leaf ? INVALID_PAGE_ID
+                              : reinterpret_cast<BPlusTreeInternalPage<GenericKey<8>, page_id_t, GenericComparator<8>> *>(
+                                    node)
+                                    ->ValueAt(0);
+    bpm->UnpinPage(page_id, false);
+    if (is_leaf) {
+      break;
+    }
+    page_id = child;
+    depth++;
+  }
+  // follow the leaf chain from the leftmost leaf
+  size_t leaf_pages = 0;
+  while (page_id != INVALID_PAGE_ID) {
+    auto *leaf = reinterpret_cast<BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>> *>(
+        bpm->FetchPage(page_id)->GetData());
+    page_id_t next = leaf->GetNextPageId();
+    bpm->UnpinPage(page_id, false);
+    page_id = next;
+    leaf_pages++;
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  std::vector<RID> rids;
+  for (auto key : keys) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    tree.GetValue(index_key, &rids);
+  }
+  double lookup_seconds = SecondsSince(start);
+  EXPECT_EQ(rids.size(), 1);
+
+  start = std::chrono::steady_clock::now();
+  int64_t scanned = 0;
+  for (auto iterator = tree.begin(); iterator != tree.end(); ++iterator) {
+    scanned++;
+  }
+  double scan_seconds = SecondsSince(start);
+  EXPECT_EQ(scanned, num_keys);
+
+  std::stringstream ss;
+  ss << std::fixed << std::setprecision(2) << "[BENCHMARK: PageSizeBenchTest.IndexDepthBenchmark] page size "
+     << PAGE_SIZE << ": depth " << depth << ", " << leaf_pages << " leaf pages, "
+     << lookup_seconds * 1e6 / num_keys << " us per lookup, " << num_keys / scan_seconds / 1e6
+     << " M keys/s leaf scan" << std::endl;
+  std::cout << ss.str();
+
+  bpm->UnpinPage(header_page_id, true);
+  delete transaction;
+  delete bpm;
+  delete disk_manager;
+  delete key_schema;
+  RemoveFiles("page_size_bench");
+}
+
+// NOLINTNEXTLINE
+TEST(PageSizeBenchTest, TableScanBenchmark) {
+  const int num_tuples = 20000;
+  RemoveFiles("page_size_bench");
+  Schema schema({Column("a", TypeId::BIGINT), Column("b", TypeId::VARCHAR, 96)});
+  auto *disk_manager = new DiskManager("page_size_bench.db");
+  auto *transaction = new Transaction(0);
+
+  page_id_t first_page_id;
+  {
+    BufferPoolManagerInstance bpm(BENCH_POOL_FRAMES, disk_manager);
+    TableHeap table(&bpm, nullptr, nullptr, transaction);
+    const std::string payload(92, 'x');
+    RID rid;
+    for (int i = 0; i < num_tuples; i++) {
+      Tuple tuple({ValueFactory::GetBigIntValue(i), ValueFactory::GetVarcharValue(payload)}, &schema);
+      ASSERT_TRUE(table.InsertTuple(tuple, &rid, transaction));
+    }
+    first_page_id = table.GetFirstPageId();
+    bpm.FlushAllPages();
+  }
+
+  // a fresh buffer pool, every page comes from the file
+  {
+    BufferPoolManagerInstance bpm(BENCH_POOL_FRAMES, disk_manager);
+    TableHeap table(&bpm, nullptr, nullptr, first_page_id);
+    auto start = std::chrono::steady_clock::now();
+    int scanned = 0;
+    size_t pages = 0;
+    page_id_t last_page = INVALID_PAGE_ID;
+    for (auto iterator = table.Begin(transaction); iterator != table.End(); ++iterator) {
+      if (iterator->GetRid().GetPageId() != last_page) {
+        last_page = iterator->GetRid().GetPageId();
+        pages++;
+      }
+      scanned++;
+    }
+    double seconds = SecondsSince(start);
+    EXPECT_EQ(scanned, num_tuples);
+
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(2) << "[BENCHMARK: PageSizeBenchTest.TableScanBenchmark] page size "
+       << PAGE_SIZE << ": " << pages << " pages, " << pages * PAGE_SIZE / seconds / 1e6 << " MB/s" << std::endl;
+    std::cout << ss.str();
+  }
+
+  delete transaction;
+  delete disk_manager;
+  RemoveFiles("page_size_bench");
+}
+
+}  // namespace bustub
@@ -0,0 +1,87 @@
+/**
+ * simd_key_search_test.cpp
+ */
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "b_plus_tree_test_util.h"  // NOLINT
+#include "gtest/gtest.h"
+#include "storage/index/simd_key_search.h"
+#include "storage/page/b_plus_tree_internal_page.h"
+#include "storage/page/b_plus_tree_leaf_page.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+// The kernel agrees with std::lower_bound and std::upper_bound for every count, stride and probe, duplicates included.
+TEST(SimdKeySearchTest, BoundsTest) {
+  std::mt19937_64 random(15445);
+  for (size_t stride : {8, 12, 16, 24}) {
+    for (int count = 0; count <= 100; count++) {
+      std::vector<int64_t> numbers(count);
+      for (auto &number : numbers) {
+        // few distinct values around zero, so that there are duplicates and negative keys
+        number = static_cast<int64_t>(random() % 64) - 32;
+      }
+      std::sort(numbers.begin(), numbers.end());
+      std::vector<char> keys(count * stride + 8);
+      for (int i = 0; i < count; i++) {
+        KeyNormalizer::EncodeBigInt(numbers[i], keys.data() + i * stride);
+      }
+      for (int64_t probe = -34; probe <= 34; probe++) {
+        char encoded[sizeof(uint64_t)];
+        KeyNormalizer::EncodeBigInt(probe, encoded);
+        uint64_t key = KeyNormalizer::LoadPrefix(encoded);
+        EXPECT_EQ(std::lower_bound(numbers.begin(), numbers.end(), probe) - numbers.begin(),
+                  SimdKeySearch::LowerBound(keys.data(), stride, count, key));
+        EXPECT_EQ(std::upper_bound(numbers.begin(), numbers.end(), probe) - numbers.begin(),
+                  SimdKeySearch::UpperBound(keys.data(), stride, count, key));
+      }
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+// Leaf and internal pages of 8-byte keys search with the kernel and find what the binary search would.
+TEST(SimdKeySearchTest, PageSearchTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  ASSERT_TRUE(comparator.IsUInt64Ordered());
+  auto *leaf_data = new char[PAGE_SIZE]();
+  auto *internal_data = new char[PAGE_SIZE]();
+  auto *leaf = reinterpret_cast<BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>> *>(leaf_data);
+  auto *internal = reinterpret_cast<BPlusTreeInternalPage<GenericKey<8>, page_id_t, GenericComparator<8>> *>(
+      internal_data);
+  leaf->Init(1);
+  internal->Init(2);
+
+  // keys -300, -297, ..., the internal page's first key is a placeholder
+  GenericKey<8> index_key;
+  for (int i = 0; i < leaf->GetMaxSize() - 1; i++) {
+    index_key.SetFromInteger(3 * i - 300);
+    leaf->Append(index_key, RID(0, i));
+  }
+  for (int i = 0; i <= internal->GetMaxSize() - 1; i++) {
+    index_key.SetFromInteger(3 * i - 300);
+    internal->Append(index_key, i);
+  }
+  for (int64_t probe = -305; probe < 3 * leaf->GetSize() - 295; probe++) {
+    index_key.SetFromInteger(probe);
+    int expected = std::clamp<int64_t>((probe + 302) / 3, 0, leaf->GetSize());
+    EXPECT_EQ(expected, leaf->KeyIndex(index_key, comparator));
+    RID rid;
+    EXPECT_EQ(probe >= -300 && (probe + 300) % 3 == 0 && expected < leaf->GetSize(),
+              leaf->Lookup(index_key, &rid, comparator));
+    // child i holds the keys from key i on
+    expected = std::clamp<int64_t>((probe + 300) / 3, 0, internal->GetSize() - 1);
+    EXPECT_EQ(expected, internal->Lookup(index_key, comparator));
+  }
+
+  delete[] leaf_data;
+  delete[] internal_data;
+  delete key_schema;
+}
+
+}  // namespace bustub
@@ -11,12 +11,15 @@
 //===----------------------------------------------------------------------===//
 
 #include <algorithm>
+#include <chrono>  // NOLINT
 #include <cstdio>
 #include <iostream>
 #include <string>
+#include <thread>  // NOLINT
+#include <utility>
 #include <vector>
 
-#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
 #include "gtest/gtest.h"
 #include "logging/common.h"
 #include "storage/table/table_heap.h"
@@ -39,7 +42,7 @@ TEST(TupleTest, DISABLED_TableHeapTest) {
   // create transaction
   auto *transaction = new Transaction(0);
   auto *disk_manager = new DiskManager("test.db");
-  auto *buffer_pool_manager = new BufferPoolManager(50, disk_manager);
+  auto *buffer_pool_manager = new BufferPoolManagerInstance(50, disk_manager);
   auto *lock_manager = new LockManager();
   auto *log_manager = new LogManager(disk_manager);
   auto *table = new TableHeap(buffer_pool_manager, lock_manager, log_manager, transaction);
@@ -64,11 +67,249 @@ TEST(TupleTest, DISABLED_TableHeapTest) {
     assert(table->MarkDelete(rid, transaction) == 1);
   }
   disk_manager->ShutDown();
-  remove("test.db");  // remove db file
-  remove("test.log");
+  DiskManager::RemoveFiles("test.db");
   delete table;
   delete buffer_pool_manager;
   delete disk_manager;
 }
 
+// NOLINTNEXTLINE
+TEST(TupleTest, TableHeapReadAheadTest) {
+  Column col1{"a", TypeId::VARCHAR, 20};
+  Column col2{"b", TypeId::BIGINT};
+  std::vector<Column> cols{col1, col2};
+  Schema schema{cols};
+  Tuple tuple = ConstructTuple(&schema);
+
+  auto *transaction = new Transaction(0);
+  auto *disk_manager = new DiskManager("test.db");
+  auto *buffer_pool_manager = new BufferPoolManagerInstance(10, disk_manager);
+  auto *lock_manager = new LockManager();
+  auto *log_manager = new LogManager(disk_manager);
+  auto *table = new TableHeap(buffer_pool_manager, lock_manager, log_manager, transaction);
+
+  const int num_tuples = 2000;
+  for (int i = 0; i < num_tuples; ++i) {
+    RID rid;
+    ASSERT_TRUE(table->InsertTuple(tuple, &rid, transaction));
+  }
+
+  // Scenario: a heap that knows its whole chain, a reopened heap that learns it while scanning, no read-ahead.
+  auto *reopened = new TableHeap(buffer_pool_manager, lock_manager, log_manager, table->GetFirstPageId());
+  for (int read_ahead : {TABLE_READ_AHEAD_PAGES, -1, 0}) {
+    TableHeap *heap = read_ahead == -1 ? reopened : table;
+    if (read_ahead >= 0) {
+      heap->SetReadAheadPages(read_ahead);
+    }
+    int count = 0;
+    for (auto itr = heap->Begin(transaction); itr != heap->End(); ++itr) {
+      EXPECT_EQ(tuple.GetLength(), itr->GetLength());
+      ++count;
+    }
+    EXPECT_EQ(num_tuples, count);
+  }
+
+  disk_manager->ShutDown();
+  DiskManager::RemoveFiles("test.db");
+  delete reopened;
+  delete table;
+  delete log_manager;
+  delete lock_manager;
+  delete buffer_pool_manager;
+  delete disk_manager;
+  delete transaction;
+}
+
+// NOLINTNEXTLINE
+// A heap opened by its first page id on a cold pool reads ahead before it has walked its chain.
+TEST(TupleTest, TableHeapColdReadAheadTest) {
+  Column col1{"a", TypeId::VARCHAR, 20};
+  Column col2{"b", TypeId::BIGINT};
+  std::vector<Column> cols{col1, col2};
+  Schema schema{cols};
+  Tuple tuple = ConstructTuple(&schema);
+
+  auto *transaction = new Transaction(0);
+  auto *disk_manager = new DiskManager("test.db");
+  std::vector<page_id_t> chain;
+  page_id_t first_page_id;
+  {
+    BufferPoolManagerInstance bpm(64, disk_manager);
+    TableHeap table(&bpm, nullptr, nullptr, transaction);
+    RID rid;
+    while (chain.size() < 2 + TABLE_READ_AHEAD_PAGES) {
+      ASSERT_TRUE(table.InsertTuple(tuple, &rid, transaction));
+      if (chain.empty() || chain.back() != rid.GetPageId()) {
+        chain.push_back(rid.GetPageId());
+      }
+    }
+    first_page_id = table.GetFirstPageId();
+    bpm.FlushAllPages();
+  }
+
+  auto *bpm = new BufferPoolManagerInstance(64, disk_manager);
+  auto *table = new TableHeap(bpm, nullptr, nullptr, first_page_id);
+  auto itr = table->Begin(transaction);
+  while (itr->GetRid().GetPageId() == chain[0]) {
+    ++itr;
+  }
+  // the scan only knows the first two pages, the ones after them were guessed
+  ASSERT_EQ(chain[1], itr->GetRid().GetPageId());
+  for (size_t i = 2; i < chain.size(); i++) {
+    Page *page = nullptr;
+    for (int j = 0; j < 200 && page == nullptr; ++j) {
+      page = bpm->FetchResidentPage(chain[i]);
+      if (page == nullptr) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+      }
+    }
+    ASSERT_NE(nullptr, page) << "page " << i << " of the chain was not read ahead";
+    bpm->UnpinPage(chain[i], false);
+  }
+  // a guess past the last page of the table is dropped instead of read as zeros
+  while (itr != table->End()) {
+    ++itr;
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_EQ(nullptr, bpm->FetchResidentPage(chain.back() + 1));
+
+  delete table;
+  delete bpm;
+  disk_manager->ShutDown();
+  DiskManager::RemoveFiles("test.db");
+  delete disk_manager;
+  delete transaction;
+}
+
+// NOLINTNEXTLINE
+// A scan or a load through a ring leaves the working set of the buffer pool alone.
+TEST(TupleTest, TableHeapRingStrategyTest) {
+  // room for the working set plus the rings of a scan and a load
+  const size_t buffer_pool_size = BULK_POOL_FRACTION * BULK_RING_SIZE;
+  const size_t num_hot_pages = 4;
+  const size_t num_bulk_pages = 2 * buffer_pool_size;
+  Column col1{"a", TypeId::VARCHAR, 20};
+  Column col2{"b", TypeId::BIGINT};
+  std::vector<Column> cols{col1, col2};
+  Schema schema{cols};
+  Tuple tuple = ConstructTuple(&schema);
+
+  auto *transaction = new Transaction(0);
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  auto *hot = new TableHeap(bpm, nullptr, nullptr, transaction);
+  auto *bulk = new TableHeap(bpm, nullptr, nullptr, transaction);
+
+  // inserts tuples until they take num_pages pages, returns how many it inserted and the pages in chain order
+  auto fill = [&](TableHeap *table, size_t num_pages, BufferAccessStrategy *strategy) {
+    std::vector<page_id_t> pages;
+    RID rid;
+    int num_tuples = 0;
+    for (; pages.size() < num_pages; num_tuples++) {
+      EXPECT_TRUE(table->InsertTuple(tuple, &rid, transaction, strategy));
+      if (pages.empty() || rid.GetPageId() != pages.back()) {
+        pages.push_back(rid.GetPageId());
+      }
+    }
+    return std::make_pair(num_tuples, pages);
+  };
+  auto all_resident = [&](const std::vector<page_id_t> &pages) {
+    for (auto page_id : pages) {
+      if (bpm->FetchResidentPage(page_id) == nullptr) {
+        return false;
+      }
+      bpm->UnpinPage(page_id, false);
+    }
+    return true;
+  };
+  std::vector<page_id_t> hot_pages = fill(hot, num_hot_pages, nullptr).second;
+  ASSERT_TRUE(all_resident(hot_pages));
+  // a table that takes a small part of the pool stays resident
+  EXPECT_EQ(nullptr, hot->MakeBulkAccessStrategy());
+
+  // Scenario: a load through a ring.
+  BufferAccessStrategy load_strategy;
+  int num_bulk_tuples = fill(bulk, num_bulk_pages, &load_strategy).first;
+  EXPECT_TRUE(all_resident(hot_pages));
+
+  // Scenario: a scan through the ring the table asks for.
+  auto scan_strategy = bulk->MakeBulkAccessStrategy();
+  ASSERT_NE(nullptr, scan_strategy);
+  EXPECT_EQ(BULK_RING_SIZE, scan_strategy->GetRingSize());
+  int scanned = 0;
+  for (auto itr = bulk->Begin(transaction, scan_strategy.get()); itr != bulk->End(); ++itr) {
+    scanned++;
+  }
+  EXPECT_EQ(num_bulk_tuples, scanned);
+  EXPECT_TRUE(all_resident(hot_pages));
+
+  // Scenario: the same scan without a ring flushes the working set.
+  scanned = 0;
+  for (auto itr = bulk->Begin(transaction); itr != bulk->End(); ++itr) {
+    scanned++;
+  }
+  EXPECT_EQ(num_bulk_tuples, scanned);
+  EXPECT_FALSE(all_resident(hot_pages));
+
+  delete bulk;
+  delete hot;
+  delete bpm;
+  disk_manager->ShutDown();
+  DiskManager::RemoveFiles("test.db");
+  delete disk_manager;
+  delete transaction;
+}
+
+// NOLINTNEXTLINE
+TEST(TupleTest, TableHeapDropTest) {
+  Column col1{"a", TypeId::VARCHAR, 20};
+  Column col2{"b", TypeId::BIGINT};
+  std::vector<Column> cols{col1, col2};
+  Schema schema{cols};
+  Tuple tuple = ConstructTuple(&schema);
+
+  auto *transaction = new Transaction(0);
+  auto *disk_manager = new DiskManager("test.db");
+  auto *buffer_pool_manager = new BufferPoolManagerInstance(10, disk_manager);
+  auto *lock_manager = new LockManager();
+  auto *log_manager = new LogManager(disk_manager);
+  auto *table = new TableHeap(buffer_pool_manager, lock_manager, log_manager, transaction);
+  auto *other = new TableHeap(buffer_pool_manager, lock_manager, log_manager, transaction);
+
+  // Scenario: every table lives in a segment file of its own.
+  segment_id_t segment_id = DiskManager::SegmentOf(table->GetFirstPageId());
+  EXPECT_NE(0, segment_id);
+  EXPECT_NE(segment_id, DiskManager::SegmentOf(other->GetFirstPageId()));
+  for (int i = 0; i < 500; ++i) {
+    RID rid;
+    ASSERT_TRUE(table->InsertTuple(tuple, &rid, transaction));
+    EXPECT_EQ(segment_id, DiskManager::SegmentOf(rid.GetPageId()));
+    ASSERT_TRUE(other->InsertTuple(tuple, &rid, transaction));
+  }
+  buffer_pool_manager->FlushAllPages();
+  std::string segment_file = "test." + std::to_string(segment_id) + ".db";
+  FILE *file = fopen(segment_file.c_str(), "r");
+  ASSERT_NE(nullptr, file);
+  fclose(file);
+
+  // Scenario: dropping a table unlinks its file and leaves the other table alone.
+  table->Drop();
+  EXPECT_EQ(nullptr, fopen(segment_file.c_str(), "r"));
+  int count = 0;
+  for (auto itr = other->Begin(transaction); itr != other->End(); ++itr) {
+    ++count;
+  }
+  EXPECT_EQ(500, count);
+
+  disk_manager->ShutDown();
+  DiskManager::RemoveFiles("test.db");
+  delete other;
+  delete table;
+  delete log_manager;
+  delete lock_manager;
+  delete buffer_pool_manager;
+  delete disk_manager;
+  delete transaction;
+}
+
 }  // namespace bustub